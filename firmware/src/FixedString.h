@@ -0,0 +1,103 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// Inline, fixed-capacity string for the render path: assigning, comparing
+// and formatting never touch the heap. Input longer than N bytes is cut at
+// the last whole UTF-8 character that fits.
+template <size_t N> class FixedString {
+public:
+  static const size_t CAPACITY = N;
+
+  FixedString() { clear(); }
+  FixedString(const char *s) { assign(s); }
+  FixedString(const String &s) { assign(s.c_str(), s.length()); }
+
+  FixedString &operator=(const char *s) {
+    assign(s);
+    return *this;
+  }
+  FixedString &operator=(const String &s) {
+    assign(s.c_str(), s.length());
+    return *this;
+  }
+
+  void clear() {
+    _len = 0;
+    _buf[0] = '\0';
+  }
+
+  void assign(const char *s) { assign(s, s ? strlen(s) : 0); }
+  void assign(const char *s, size_t len) {
+    _len = 0;
+    append(s, len);
+  }
+
+  FixedString &append(const char *s) { return append(s, s ? strlen(s) : 0); }
+  FixedString &append(const char *s, size_t len) {
+    if (len > N - _len)
+      len = utf8Fit(s, N - _len);
+    memcpy(_buf + _len, s, len);
+    _len += len;
+    _buf[_len] = '\0';
+    return *this;
+  }
+
+  // printf into the buffer (replaces the content)
+  FixedString &format(const char *fmt, ...)
+      __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(_buf, N + 1, fmt, args);
+    va_end(args);
+    if (n < 0)
+      _len = 0;
+    else
+      _len = (size_t)n > N ? utf8Fit(_buf, N) : n;
+    _buf[_len] = '\0';
+    return *this;
+  }
+
+  // Same text as String(value, decimals)
+  FixedString &format(float value, int decimals) {
+    return format("%.*f", decimals, value);
+  }
+
+  const char *c_str() const { return _buf; }
+  size_t length() const { return _len; }
+  bool isEmpty() const { return _len == 0; }
+
+  bool operator==(const char *s) const { return strcmp(_buf, s) == 0; }
+  bool operator!=(const char *s) const { return !(*this == s); }
+  bool operator==(const String &s) const { return *this == s.c_str(); }
+  bool operator!=(const String &s) const { return !(*this == s); }
+  template <size_t M> bool operator==(const FixedString<M> &o) const {
+    return *this == o.c_str();
+  }
+  template <size_t M> bool operator!=(const FixedString<M> &o) const {
+    return !(*this == o);
+  }
+
+private:
+  char _buf[N + 1];
+  size_t _len;
+
+  // Longest prefix of s[0..max) that does not end inside a character
+  static size_t utf8Fit(const char *s, size_t max) {
+    size_t lead = max;
+    while (lead > 0 && (s[lead - 1] & 0xC0) == 0x80)
+      lead--; // Skip continuation bytes back to the lead byte
+    if (lead == 0)
+      return 0;
+    lead--;
+    uint8_t c = s[lead];
+    size_t need = c < 0x80 ? 1 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+    return lead + need <= max ? max : lead;
+  }
+};
+
+#endif
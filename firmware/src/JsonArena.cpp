@@ -0,0 +1,88 @@
+#include "JsonArena.h"
+#include <string.h>
+
+JsonArena loopArena("loop", 8192);
+JsonArena fetchArena("fetch", 8192);
+JsonArena bleArena("ble", 12288);
+
+JsonArena::JsonArena(const char *name, size_t capacity)
+    : _name(name), _buf((uint8_t *)malloc(capacity)),
+      _capacity(_buf ? capacity : 0) {}
+
+void *JsonArena::bump(size_t size) {
+  size_t need = HEADER + align(size);
+  if (need > _capacity - _used)
+    return nullptr;
+  _last = _used;
+  void *ptr = _buf + _used + HEADER;
+  blockSize(ptr) = size;
+  _used += need;
+  _live++;
+  _highWater = max(_highWater, _used);
+  return ptr;
+}
+
+void JsonArena::release(void *ptr) {
+  size_t offset = (uint8_t *)ptr - HEADER - _buf;
+  if (offset == _last) {
+    _used = _last; // Newest block: give the space back right away
+    _last = SIZE_MAX;
+  }
+  if (--_live == 0) {
+    _used = 0;
+    _last = SIZE_MAX;
+  }
+}
+
+void *JsonArena::allocate(size_t size) {
+  std::lock_guard<std::mutex> guard(_lock);
+  void *ptr = bump(size);
+  if (ptr)
+    return ptr;
+  _overflows++;
+  return malloc(size);
+}
+
+void JsonArena::deallocate(void *ptr) {
+  if (!ptr)
+    return;
+  std::lock_guard<std::mutex> guard(_lock);
+  if (owns(ptr))
+    release(ptr);
+  else
+    free(ptr);
+}
+
+void *JsonArena::reallocate(void *ptr, size_t newSize) {
+  if (!ptr)
+    return allocate(newSize);
+
+  std::lock_guard<std::mutex> guard(_lock);
+  if (!owns(ptr))
+    return realloc(ptr, newSize);
+
+  size_t oldSize = blockSize(ptr);
+  size_t offset = (uint8_t *)ptr - HEADER - _buf;
+  if (offset == _last && HEADER + align(newSize) <= _capacity - _last) {
+    // Newest block (strings being built, pools being shrunk): in place
+    blockSize(ptr) = newSize;
+    _used = _last + HEADER + align(newSize);
+    _highWater = max(_highWater, _used);
+    return ptr;
+  }
+  if (newSize <= oldSize) {
+    blockSize(ptr) = newSize;
+    return ptr;
+  }
+
+  void *moved = bump(newSize);
+  if (!moved) {
+    _overflows++;
+    moved = malloc(newSize);
+    if (!moved)
+      return nullptr;
+  }
+  memcpy(moved, ptr, oldSize);
+  release(ptr);
+  return moved;
+}
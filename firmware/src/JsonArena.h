@@ -0,0 +1,60 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <mutex>
+
+// Bump allocator for short-lived JsonDocuments, plugged in through
+// ArduinoJson's Allocator interface: JsonDocument doc(&arena).
+// The buffer is reserved once at boot; allocations only move a pointer and
+// the whole arena rewinds when the last block is released (i.e. when the
+// last document using it is destroyed), so parsing a response no longer
+// leaves holes in the general heap. A request that does not fit falls back
+// to malloc and is counted as an overflow.
+class JsonArena : public ArduinoJson::Allocator {
+public:
+  JsonArena(const char *name, size_t capacity);
+  ~JsonArena() { free(_buf); }
+
+  void *allocate(size_t size) override;
+  void deallocate(void *ptr) override;
+  void *reallocate(void *ptr, size_t newSize) override;
+
+  const char *name() const { return _name; }
+  size_t capacity() const { return _capacity; }
+  size_t highWater() const { return _highWater; }
+  uint32_t overflows() const { return _overflows; }
+
+private:
+  // Every block starts with its size, rounded up to keep data aligned
+  static const size_t ALIGN = 8;
+  static const size_t HEADER = ALIGN;
+
+  const char *_name;
+  uint8_t *_buf;
+  size_t _capacity;
+  size_t _used = 0;
+  size_t _last = SIZE_MAX; // Offset of the newest block, can be grown in place
+  uint32_t _live = 0;      // Arena blocks not yet released
+  size_t _highWater = 0;
+  uint32_t _overflows = 0;
+  std::mutex _lock;
+
+  static size_t align(size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+  bool owns(const void *ptr) const {
+    return ptr >= _buf && ptr < _buf + _capacity;
+  }
+  size_t &blockSize(void *ptr) {
+    return *reinterpret_cast<size_t *>((uint8_t *)ptr - HEADER);
+  }
+  void *bump(size_t size);
+  void release(void *ptr);
+};
+
+// One arena per task, a document never crosses tasks
+extern JsonArena loopArena;  // Main loop: tempus fetches, module map, telemetry
+extern JsonArena fetchArena; // Fetch task: sensor responses
+extern JsonArena bleArena;   // BLE host task: commands and replies
+
+#endif
@@ -0,0 +1,86 @@
+#include "SensorHistory.h"
+#include <math.h>
+
+SensorHistory sensorHistory;
+
+static const long DELTA_LIMIT = 32767;
+
+int16_t SensorHistory::at(int slot, int i) const {
+  int pos = _head[slot] - _count[slot] + i;
+  if (pos < 0)
+    pos += DEPTH;
+  return _delta[slot][pos];
+}
+
+void SensorHistory::clear(int slot) {
+  if (slot < 0 || slot >= SENSOR_SLOTS)
+    return;
+  _head[slot] = 0;
+  _count[slot] = 0;
+}
+
+void SensorHistory::push(int slot, float value, int decimals) {
+  if (slot < 0 || slot >= SENSOR_SLOTS || !isfinite(value))
+    return;
+
+  if (_count[slot] == 0) {
+    _base[slot] = value;
+    _step[slot] = powf(10.0f, -constrain(decimals, 0, 3));
+  }
+
+  long d = lroundf((value - _base[slot]) / _step[slot]);
+  if (d < -DELTA_LIMIT || d > DELTA_LIMIT) {
+    rebase(slot, value);
+    d = lroundf((value - _base[slot]) / _step[slot]);
+  }
+
+  _delta[slot][_head[slot]] = (int16_t)d;
+  _head[slot] = (_head[slot] + 1) % DEPTH;
+  if (_count[slot] < DEPTH)
+    _count[slot]++;
+}
+
+// Centers the base on the window plus the new value and doubles the step
+// until the span fits; existing samples are re-encoded (and may lose
+// resolution, which a sparkline cannot show anyway)
+void SensorHistory::rebase(int slot, float value) {
+  float lo = value, hi = value;
+  for (int i = 0; i < _count[slot]; i++) {
+    float v = _base[slot] + at(slot, i) * _step[slot];
+    lo = min(lo, v);
+    hi = max(hi, v);
+  }
+
+  float base = (lo + hi) / 2;
+  float step = _step[slot];
+  while ((hi - lo) / 2 / step >= DELTA_LIMIT)
+    step *= 2;
+
+  for (int i = 0; i < _count[slot]; i++) {
+    int pos = (_head[slot] - _count[slot] + i + DEPTH) % DEPTH;
+    float v = _base[slot] + _delta[slot][pos] * _step[slot];
+    _delta[slot][pos] = (int16_t)lroundf((v - base) / step);
+  }
+  _base[slot] = base;
+  _step[slot] = step;
+}
+
+int SensorHistory::downsample(int slot, int width, int16_t *lo,
+                              int16_t *hi) const {
+  if (slot < 0 || slot >= SENSOR_SLOTS || width <= 0)
+    return 0;
+  int n = _count[slot];
+  int columns = min(n, width);
+
+  for (int c = 0; c < columns; c++) {
+    lo[c] = INT16_MAX;
+    hi[c] = INT16_MIN;
+  }
+  for (int i = 0; i < n; i++) {
+    int c = i * columns / n;
+    int16_t d = at(slot, i);
+    lo[c] = min(lo[c], d);
+    hi[c] = max(hi[c], d);
+  }
+  return columns;
+}
@@ -0,0 +1,49 @@
+#ifndef SENSOR_HISTORY_H
+#define SENSOR_HISTORY_H
+
+#include "config/SensorConfig.h"
+#include <Arduino.h>
+
+// Samples kept per slot, one per successful reading (override with
+// -D SENSOR_HISTORY_DEPTH=n). Memory per slot is 2 * DEPTH + 12 bytes:
+// 204 bytes by default, 3.2 KB for all 16 slots, at most 524 bytes/slot.
+#ifndef SENSOR_HISTORY_DEPTH
+#define SENSOR_HISTORY_DEPTH 96
+#endif
+
+// Fixed-memory value history for every sensor slot, laid out as structure
+// of arrays. Samples are int16 deltas against a per-slot base, in steps of
+// the slot's display precision; a reading outside the int16 range rebases
+// the slot and coarsens the step until the whole window fits again.
+class SensorHistory {
+public:
+  static const int DEPTH = SENSOR_HISTORY_DEPTH;
+  static_assert(DEPTH >= 2 && DEPTH <= 256, "SENSOR_HISTORY_DEPTH: 2..256");
+
+  static constexpr size_t BYTES_PER_SLOT =
+      DEPTH * sizeof(int16_t) + sizeof(float) * 2 + sizeof(uint16_t) * 2;
+
+  // decimals sets the step of an empty slot (0.1 for 1 decimal)
+  void push(int slot, float value, int decimals);
+  void clear(int slot);
+  int count(int slot) const { return _count[slot]; }
+
+  // Min/max delta of the samples falling into each of `width` columns,
+  // oldest on the left. Returns the columns used: fewer than width while
+  // there are fewer samples than columns, 0 for an empty slot.
+  int downsample(int slot, int width, int16_t *lo, int16_t *hi) const;
+
+private:
+  float _base[SENSOR_SLOTS] = {};
+  float _step[SENSOR_SLOTS] = {};
+  uint16_t _head[SENSOR_SLOTS] = {};  // Next write position
+  uint16_t _count[SENSOR_SLOTS] = {}; // Valid samples, <= DEPTH
+  int16_t _delta[SENSOR_SLOTS][DEPTH];
+
+  int16_t at(int slot, int i) const; // i = 0 is the oldest sample
+  void rebase(int slot, float value);
+};
+
+extern SensorHistory sensorHistory;
+
+#endif
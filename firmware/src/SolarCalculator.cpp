@@ -0,0 +1,153 @@
+#include "SolarCalculator.h"
+#include <math.h>
+
+static const double DEG = M_PI / 180.0;
+static const double JD_UNIX_EPOCH = 2440587.5;
+static const double JD_J2000 = 2451545.0;
+static const double SUN_ZENITH = 90.833; // Refraction + solar radius
+static const long TT_MINUS_UT = 69;      // Delta T in seconds, 2020s
+
+namespace {
+
+struct SolarPosition {
+  double declination; // Radians
+  double eqTime;      // Equation of time, minutes
+};
+
+// NOAA solar position at a Julian day
+SolarPosition solarPosition(double jd) {
+  double t = (jd - JD_J2000) / 36525.0;
+  double l0 = fmod(280.46646 + t * (36000.76983 + t * 0.0003032), 360.0);
+  double m = (357.52911 + t * (35999.05029 - 0.0001537 * t)) * DEG;
+  double e = 0.016708634 - t * (0.000042037 + 0.0000001267 * t);
+
+  double c = sin(m) * (1.914602 - t * (0.004817 + 0.000014 * t)) +
+             sin(2 * m) * (0.019993 - 0.000101 * t) + sin(3 * m) * 0.000289;
+  double omega = (125.04 - 1934.136 * t) * DEG;
+  double lambda = (l0 + c - 0.00569 - 0.00478 * sin(omega)) * DEG;
+
+  double seconds = 21.448 - t * (46.815 + t * (0.00059 - t * 0.001813));
+  double eps0 = 23.0 + (26.0 + seconds / 60.0) / 60.0;
+  double eps = (eps0 + 0.00256 * cos(omega)) * DEG;
+
+  double y = tan(eps / 2) * tan(eps / 2);
+  double l0r = l0 * DEG;
+  double eq = y * sin(2 * l0r) - 2 * e * sin(m) +
+              4 * e * y * sin(m) * cos(2 * l0r) -
+              0.5 * y * y * sin(4 * l0r) - 1.25 * e * e * sin(2 * m);
+
+  return {asin(sin(eps) * sin(lambda)), 4 * eq / DEG};
+}
+
+// Minutes after dayStart (00:00 UTC) of sunrise or sunset. Refined once
+// with the sun's position at the first estimate. Returns cos(hour angle)
+// out of [-1, 1] in cosH when the sun does not cross the horizon.
+double sunEvent(time_t dayStart, double lat, double lon, bool rising,
+                double &cosH) {
+  double minutes = 720 - 4 * lon; // Local solar noon, first guess
+  for (int pass = 0; pass < 2; pass++) {
+    double jd = JD_UNIX_EPOCH + (dayStart + minutes * 60) / 86400.0;
+    SolarPosition p = solarPosition(jd);
+    cosH = (cos(SUN_ZENITH * DEG) - sin(lat * DEG) * sin(p.declination)) /
+           (cos(lat * DEG) * cos(p.declination));
+    if (cosH > 1 || cosH < -1)
+      return 0;
+    double h = acos(cosH) / DEG;
+    minutes = 720 - 4 * (lon + (rising ? h : -h)) - p.eqTime;
+  }
+  return minutes;
+}
+
+// Meeus, Astronomical Algorithms, tables 27.B and 27.C (years 2000-3000)
+const double MEAN_TERMS[4][5] = {
+    {2451623.80984, 365242.37404, 0.05169, -0.00411, -0.00057},
+    {2451716.56767, 365241.62603, 0.00325, 0.00888, -0.00030},
+    {2451810.21715, 365242.01767, -0.11575, 0.00337, 0.00078},
+    {2451900.05952, 365242.74049, -0.06223, -0.00823, 0.00032},
+};
+
+const double PERIODIC_TERMS[24][3] = {
+    {485, 324.96, 1934.136},   {203, 337.23, 32964.467},
+    {199, 342.08, 20.186},     {182, 27.85, 445267.112},
+    {156, 73.14, 45036.886},   {136, 171.52, 22518.443},
+    {77, 222.54, 65928.934},   {74, 296.72, 3034.906},
+    {70, 243.58, 9037.513},    {58, 119.81, 33718.147},
+    {52, 297.17, 150.678},     {50, 21.02, 2281.226},
+    {45, 247.54, 29929.562},   {44, 325.15, 31555.956},
+    {29, 60.93, 4443.417},     {18, 155.12, 67555.328},
+    {17, 288.79, 4562.452},    {16, 198.04, 62894.029},
+    {14, 199.76, 31436.921},   {12, 95.39, 14577.848},
+    {12, 287.11, 31931.756},   {12, 320.81, 34777.259},
+    {9, 227.73, 1222.114},     {8, 15.45, 16859.074},
+};
+
+} // namespace
+
+long SolarCalculator::daysFromCivil(int year, int month, int mday) {
+  // Howard Hinnant's days_from_civil
+  year -= month <= 2;
+  long era = (year >= 0 ? year : year - 399) / 400;
+  long yoe = year - era * 400;
+  long doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + mday - 1;
+  long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+void SolarCalculator::civilFromDays(long days, int &year, int &month,
+                                    int &mday) {
+  // Howard Hinnant's civil_from_days
+  days += 719468;
+  long era = (days >= 0 ? days : days - 146096) / 146097;
+  long doe = days - era * 146097;
+  long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  long mp = (5 * doy + 2) / 153;
+  mday = doy - (153 * mp + 2) / 5 + 1;
+  month = mp < 10 ? mp + 3 : mp - 9;
+  year = yoe + era * 400 + (month <= 2);
+}
+
+SolarCalculator::Day SolarCalculator::day(int year, int month, int mday,
+                                          double lat, double lon) {
+  return day(daysFromCivil(year, month, mday), lat, lon);
+}
+
+SolarCalculator::Day SolarCalculator::day(long days, double lat, double lon) {
+  Day day;
+  time_t dayStart = (time_t)days * 86400;
+  double cosH;
+  double rise = sunEvent(dayStart, lat, lon, true, cosH);
+  if (cosH > 1 || cosH < -1) {
+    day.polarDay = cosH < -1;
+    day.lengthSec = day.polarDay ? 86400 : 0;
+    return day;
+  }
+  double set = sunEvent(dayStart, lat, lon, false, cosH);
+  if (cosH > 1 || cosH < -1) { // Crossing into polar day/night tomorrow
+    day.polarDay = cosH < -1;
+    day.lengthSec = day.polarDay ? 86400 : 0;
+    return day;
+  }
+
+  day.rises = true;
+  day.sunrise = dayStart + lround(rise * 60);
+  day.sunset = dayStart + lround(set * 60);
+  day.lengthSec = day.sunset - day.sunrise;
+  return day;
+}
+
+time_t SolarCalculator::boundary(int year, Boundary which) {
+  const double *k = MEAN_TERMS[which];
+  double y = (year - 2000) / 1000.0;
+  double jde0 = k[0] + y * (k[1] + y * (k[2] + y * (k[3] + y * k[4])));
+
+  double t = (jde0 - JD_J2000) / 36525.0;
+  double w = (35999.373 * t - 2.47) * DEG;
+  double dl = 1 + 0.0334 * cos(w) + 0.0007 * cos(2 * w);
+  double s = 0;
+  for (const double *term : PERIODIC_TERMS)
+    s += term[0] * cos((term[1] + term[2] * t) * DEG);
+  double jde = jde0 + 0.00001 * s / dl;
+
+  return (time_t)llround((jde - JD_UNIX_EPOCH) * 86400.0) - TT_MINUS_UT;
+}
@@ -0,0 +1,42 @@
+#ifndef SOLAR_CALCULATOR_H
+#define SOLAR_CALCULATOR_H
+
+#include <time.h>
+
+// Sun and season ephemeris computed on the device. Sunrise and sunset use
+// the NOAA solar position equations (about a minute of accuracy outside
+// the polar regions); equinoxes and solstices use Meeus' periodic series
+// (a few minutes, years 2000-3000). Pure arithmetic, no network.
+class SolarCalculator {
+public:
+  enum Boundary {
+    MARCH_EQUINOX,
+    JUNE_SOLSTICE,
+    SEPTEMBER_EQUINOX,
+    DECEMBER_SOLSTICE
+  };
+
+  struct Day {
+    bool rises = false;    // false: polar day or polar night
+    bool polarDay = false; // Sun up all day, when !rises
+    time_t sunrise = 0;    // UTC, valid when rises
+    time_t sunset = 0;     // UTC, valid when rises
+    long lengthSec = 0;    // 0 in polar night, 86400 in polar day
+  };
+
+  // Sun events of the civil date year-month-mday (month 1-12) at lat/lon
+  // in degrees, north and east positive
+  static Day day(int year, int month, int mday, double lat, double lon);
+  // Same, for a day number as returned by daysFromCivil()
+  static Day day(long days, double lat, double lon);
+
+  // Instant (UTC) of a season boundary in the given year
+  static time_t boundary(int year, Boundary which);
+
+  // Days from 1970-01-01 to a civil date (proleptic Gregorian)
+  static long daysFromCivil(int year, int month, int mday);
+  // Inverse of daysFromCivil
+  static void civilFromDays(long days, int &year, int &month, int &mday);
+};
+
+#endif
@@ -1,107 +1,181 @@
 #include "ble.h"
+#include "JsonArena.h"
+#include "SensorHistory.h"
+#include "config/ConfigSync.h"
 #include "modules/SensorModule.h"
+#include "network/FetchWorker.h"
+#include "network/NetworkWindow.h"
 #include <esp-iot-utils.h>
 
-Ble::Ble(ConfigHelper &config)
+Ble::Ble(ConfigStore &config)
     : _config(config),
-      _pipe("E-PAPER-C6", SERVICE_UUID, CHARACTERISTIC_JSON_GATE_UUID) {}
+      _pipe(DEVICE_NAME, SERVICE_UUID, CHARACTERISTIC_JSON_GATE_UUID) {}
 
 void Ble::begin() {
-  _pipe.setOnJson([this](const JsonDocument &doc) { handleCommand(doc); });
+  // The sync service has to exist before the pipe starts advertising
+  NimBLEDevice::init(DEVICE_NAME);
+  // Offer the largest ATT MTU, the client picks the final value
+  NimBLEDevice::setMTU(BLE_ATT_MTU_MAX);
+  _channel.setOnMessage([this](const JsonDocument &doc, PayloadEncoding enc) {
+    handleCommand(
+        doc, [this, enc](const JsonDocument &res) { _channel.send(res, enc); },
+        [this, enc](const JsonDocument &msg) {
+          return _channel.send(msg, enc, false);
+        });
+  });
+  _channel.begin();
+
+  _pipe.setOnJson([this](const JsonDocument &doc) {
+    handleCommand(
+        doc, [this](const JsonDocument &res) { _pipe.sendJson(res); },
+        [this](const JsonDocument &msg) {
+          _pipe.sendJson(msg);
+          return true;
+        });
+  });
   _pipe.begin();
 }
 
-void Ble::handleCommand(const JsonDocument &doc) {
+void Ble::handleCommand(const JsonDocument &doc, Reply reply,
+                        Telemetry::Sink push) {
   String cmd = doc["cmd"] | "";
 
   if (cmd == "get_config") {
-    JsonDocument res;
+    const ConfigSnapshot &snap = _config.current();
+    JsonDocument res(&bleArena);
     res["cmd"] = "config_data";
+    res["generation"] = snap.generation;
 
     // System Settings
-    res["ssid"] = _config.get("ssid", String(""));
-    res["ntpServer"] = _config.get("ntp_srv", String("pool.ntp.org"));
-    res["gmt"] = _config.get("ntp_gmt", 3600L);
-    res["dst"] = _config.get("ntp_dst", 3600);
-    res["dnsMode"] = _config.get("dns_mode", String("auto"));
-    res["dnsPrimary"] = _config.get("dns_pri", String("8.8.8.8"));
-    res["dnsSecondary"] = _config.get("dns_sec", String("1.1.1.1"));
-    res["tempusUrl"] = _config.get("tempus_url", String(""));
-    res["bleTimeout"] = _config.get("ble_timeout", 15);
-    res["sensorInterval"] = _config.get("sensorInterval", 60);
-    res["lang"] = _config.get("language", String("en"));
-    res["style"] = _config.get("sens_style", 0);
-    res["module_map"] = _config.get("module_map", String(""));
+    SystemConfigHelper::toJson(snap.system, res.as<JsonVariant>());
 
     // Sensors
     JsonArray sensors = res["sensors"].to<JsonArray>();
-    for (int i = 0; i < 16; i++) {
-      String key = "sensor_" + String(i);
-      JsonDocument sDoc;
-      if (!_config.get(key.c_str(), sDoc)) {
-        sDoc["enabled"] = false;
-        sDoc["label"] = "";
-      }
-      sensors.add(sDoc);
+    for (int i = 0; i < SENSOR_SLOTS; i++) {
+      SensorConfigHelper::toJson(snap.sensors[i], sensors.add<JsonObject>());
     }
 
-    _pipe.sendJson(res);
+    reply(res);
+
+  } else if (cmd == "get_manifest") {
+    JsonDocument res(&bleArena);
+    res["cmd"] = "manifest";
+    ConfigSync::writeManifest(_config.current(), res.as<JsonVariant>());
+    reply(res);
+
+  } else if (cmd == "get_sections") {
+    JsonDocument res(&bleArena);
+    res["cmd"] = "sections";
+    ConfigSync::writeSections(_config.current(), doc.as<JsonVariantConst>(),
+                              res.as<JsonVariant>());
+    reply(res);
 
   } else if (cmd == "save_config") {
     JsonObjectConst cfg = doc["config"];
+    ConfigSnapshot *next = _config.stage();
+    if (!next) {
+      // The main loop has not let go of the previous save yet
+      JsonDocument res(&bleArena);
+      res["cmd"] = "busy";
+      reply(res);
+      return;
+    }
 
     // Update individual values if present in the config object
-    if (cfg["ssid"])
-      _config.set("ssid", cfg["ssid"].as<String>());
-    if (cfg["password"])
-      _config.set("password", cfg["password"].as<String>());
-    if (cfg["ntpServer"])
-      _config.set("ntp_srv", cfg["ntpServer"].as<String>());
-    if (cfg["gmt"])
-      _config.set("ntp_gmt", cfg["gmt"].as<long>());
-    if (cfg["dst"])
-      _config.set("ntp_dst", cfg["dst"].as<int>());
-    if (cfg["dnsMode"])
-      _config.set("dns_mode", cfg["dnsMode"].as<String>());
-    if (cfg["dnsPrimary"])
-      _config.set("dns_pri", cfg["dnsPrimary"].as<String>());
-    if (cfg["dnsSecondary"])
-      _config.set("dns_sec", cfg["dnsSecondary"].as<String>());
-    if (cfg["tempusUrl"])
-      _config.set("tempus_url", cfg["tempusUrl"].as<String>());
-    if (cfg["bleTimeout"])
-      _config.set("ble_timeout", cfg["bleTimeout"].as<int>());
-    if (cfg["sensorInterval"])
-      _config.set("sensorInterval", cfg["sensorInterval"].as<int>());
-    if (cfg["lang"]) {
-      String lang = cfg["lang"].as<String>();
-      _config.set("language", lang);
-      TimeHelper::setLanguage(lang);
-    }
-    if (cfg["style"])
-      _config.set("sens_style", cfg["style"].as<int>());
-    if (cfg["module_map"])
-      _config.set("module_map", cfg["module_map"].as<String>());
-
-    // Update sensors if present
-    if (cfg["sensors"]) {
-      JsonArrayConst sensors = cfg["sensors"];
-      int i = 0;
-      for (JsonVariantConst s : sensors) {
-        if (i >= 16)
-          break;
-        String key = "sensor_" + String(i++);
-        _config.set(key.c_str(), s);
-      }
-    }
+    SystemConfigHelper::fromJson(cfg, next->system);
 
-    shouldUpdateSensors = true;
-    Serial.println("[BLE] Full Configuration Saved");
+    // Update sensors if present (full array, or { "<slot>": {...} })
+    if (!cfg["sensors"].isNull())
+      ConfigSync::applySensors(cfg["sensors"], *next);
+
+    // The main loop picks up what this invalidates (ConfigStore::takeChanges)
+    std::vector<String> changed;
+    if (!_config.commit(changed)) {
+      JsonDocument res(&bleArena);
+      res["cmd"] = "save_failed";
+      res["error"] = "storage";
+      reply(res);
+      return;
+    }
+    Serial.printf("[BLE] Configuration saved (%u keys changed)\n",
+                  (unsigned)changed.size());
 
     // Ack
-    JsonDocument ack;
+    JsonDocument ack(&bleArena);
     ack["cmd"] = "save_ok";
-    _pipe.sendJson(ack);
+    ack["generation"] = _config.generation();
+    JsonArray keys = ack["changed"].to<JsonArray>();
+    for (const String &key : changed)
+      keys.add(key);
+    reply(ack);
+
+  } else if (cmd == "telemetry") {
+    // { cmd: "telemetry", interval: <ms> }, interval 0 stops the stream
+    uint32_t interval = doc["interval"] | 1000;
+    if (interval == 0)
+      telemetry.unsubscribe();
+    else
+      interval = telemetry.subscribe(push, interval);
+
+    JsonDocument res(&bleArena);
+    res["cmd"] = "telemetry_ok";
+    res["interval"] = interval;
+    reply(res);
+
+  } else if (cmd == "get_stats") {
+    JsonDocument res(&bleArena);
+    res["cmd"] = "stats_data";
+
+    ResponseCache &cache = SensorFetcher::cache();
+    JsonObject http = res["http_cache"].to<JsonObject>();
+    http["hits"] = cache.hits();
+    http["misses"] = cache.misses();
+    http["entries"] = cache.size();
+
+    JsonObject display = res["display"].to<JsonObject>();
+    display["suppressed_refreshes"] = SensorModule::suppressedRefreshes();
+
+    JsonObject storage = res["config"].to<JsonObject>();
+    storage["load_us"] = _config.loadMicros();
+    storage["record_bytes"] = _config.recordSize();
+    storage["bytes_written"] = _config.bytesWritten();
+
+    const FetchWorker::Stats &fs = fetchWorker.stats();
+    JsonObject fetch = res["fetch"].to<JsonObject>();
+    fetch["depth"] = fetchWorker.depth();
+    fetch["max_depth"] = fs.maxDepth.load();
+    fetch["rejected"] = fs.rejected.load();
+    fetch["completed"] = fs.completed.load();
+    fetch["avg_latency_ms"] = fs.avgLatencyMs.load();
+    fetch["max_latency_ms"] = fs.maxLatencyMs.load();
+    fetch["max_fetch_ms"] = fs.maxFetchMs.load();
+
+    JsonArray arenas = res["json_arenas"].to<JsonArray>();
+    for (const JsonArena *arena : {&loopArena, &fetchArena, &bleArena}) {
+      JsonObject a = arenas.add<JsonObject>();
+      a["name"] = arena->name();
+      a["capacity"] = arena->capacity();
+      a["high_water"] = arena->highWater();
+      a["overflows"] = arena->overflows();
+    }
+
+    JsonObject net = res["network"].to<JsonObject>();
+    net["tolerance_s"] = networkWindow.tolerance() / 1000;
+    net["open"] = networkWindow.open();
+    net["bursts"] = networkWindow.bursts();
+    net["connect_failures"] = networkWindow.connectFailures();
+    net["radio_on_ms_last_hour"] = networkWindow.radioOnLastHourMs();
+    net["radio_on_ms_this_hour"] = networkWindow.radioOnThisHourMs();
+
+    JsonObject history = res["history"].to<JsonObject>();
+    history["depth"] = SensorHistory::DEPTH;
+    history["bytes"] = sizeof(sensorHistory);
+
+    JsonObject live = res["telemetry"].to<JsonObject>();
+    live["sent"] = telemetry.sent();
+    live["dropped"] = telemetry.dropped();
+
+    reply(res);
   }
 }
 
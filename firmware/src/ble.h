@@ -1,28 +1,36 @@
 #ifndef BLE_H
 #define BLE_H
 
+#include "ble_channel.h"
+#include "config/ConfigStore.h"
+#include "telemetry.h"
 #include <NimBLE-DataPipe.h>
 #include <esp-iot-utils.h>
 
+#define DEVICE_NAME "E-PAPER-C6"
+
 // UUIDs for Service and Characteristics
 #define SERVICE_UUID "4fafc201-1fb5-459e-8fcc-c5c9c331914b"
 #define CHARACTERISTIC_JSON_GATE_UUID "a1b2c3d4-1234-5678-9abc-def012345685"
 
 class Ble {
 public:
-  Ble(ConfigHelper &config);
+  Ble(ConfigStore &config);
   void begin();
   void stop();
   bool isConnected();
+  // Finishes notifications the BLE host had no buffers for
+  void loop() { _channel.loop(); }
 
 private:
-  ConfigHelper &_config;
+  using Reply = std::function<void(const JsonDocument &)>;
+
+  ConfigStore &_config;
   NimBLE_DataPipe _pipe;
+  BleChannel _channel;
 
-  void handleCommand(const JsonDocument &doc);
+  void handleCommand(const JsonDocument &doc, Reply reply,
+                     Telemetry::Sink push);
 };
 
-// Flag to trigger immediate sensor update from main loop
-extern volatile bool shouldUpdateSensors;
-
 #endif
@@ -0,0 +1,229 @@
+#include "ble_channel.h"
+#include "JsonArena.h"
+#include "config/ConfigRecord.h"
+
+void BleChannel::begin() {
+  NimBLEServer *server = NimBLEDevice::createServer();
+  NimBLEService *service = server->createService(SYNC_SERVICE_UUID);
+  _char = service->createCharacteristic(
+      CHARACTERISTIC_SYNC_UUID,
+      NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE |
+          NIMBLE_PROPERTY::WRITE_NR | NIMBLE_PROPERTY::NOTIFY);
+  _char->setCallbacks(this);
+  service->start();
+}
+
+void BleChannel::onSubscribe(NimBLECharacteristic *characteristic,
+                             NimBLEConnInfo &connInfo, uint16_t subValue) {
+  // New session: drop any half-received frame from a previous client
+  _connHandle = connInfo.getConnHandle();
+  resetTransfer();
+  std::lock_guard<std::mutex> guard(_txLock);
+  _tx.clear(); // Rest of a frame meant for the previous client
+  _txSent = 0;
+}
+
+void BleChannel::onRead(NimBLECharacteristic *characteristic,
+                        NimBLEConnInfo &connInfo) {
+  // Web Bluetooth does not expose the negotiated MTU, so publish it here
+  uint16_t mtu = connInfo.getMTU();
+  uint8_t info[4] = {PROTOCOL_VERSION, WINDOW, (uint8_t)(mtu & 0xFF),
+                     (uint8_t)(mtu >> 8)};
+  characteristic->setValue(info, sizeof(info));
+}
+
+void BleChannel::onWrite(NimBLECharacteristic *characteristic,
+                         NimBLEConnInfo &connInfo) {
+  _connHandle = connInfo.getConnHandle();
+  NimBLEAttValue value = characteristic->getValue();
+  const uint8_t *data = value.data();
+  size_t len = value.size();
+  if (len < 3)
+    return;
+
+  uint16_t seq = data[1] | (data[2] << 8);
+  if (data[0] == OP_DATA) {
+    onData(seq, data + 3, len - 3);
+  } else if (data[0] == OP_END && len >= 7) {
+    uint32_t crc = data[3] | (data[4] << 8) | (data[5] << 16) |
+                   ((uint32_t)data[6] << 24);
+    onEnd(seq, crc);
+  }
+}
+
+void BleChannel::resetTransfer() {
+  _rx.clear();
+  _nextSeq = 0;
+  _windowStart = 0;
+  _gapReported = false;
+}
+
+void BleChannel::onData(uint16_t seq, const uint8_t *data, size_t len) {
+  if (seq == 0 && _nextSeq != 0)
+    resetTransfer(); // Client restarted the frame
+
+  if (seq != _nextSeq) {
+    // Out of order: ask once for a resend, ignore the rest of the window.
+    // The client's next window starts where the resend does.
+    if (!_gapReported) {
+      _gapReported = true;
+      _windowStart = _nextSeq;
+      sendAck(AckStatus::RETRY);
+    }
+    return;
+  }
+  _gapReported = false;
+
+  if (_rx.size() + len > 3 + MAX_FRAME) {
+    Serial.println("[BleChannel] Frame too large");
+    resetTransfer();
+    sendAck(AckStatus::BAD);
+    return;
+  }
+  _rx.insert(_rx.end(), data, data + len);
+  _nextSeq++;
+
+  // Windows count from wherever the client last resumed, which after a
+  // RETRY is not a multiple of WINDOW
+  if (_nextSeq - _windowStart == WINDOW) {
+    _windowStart = _nextSeq;
+    sendAck(AckStatus::OK);
+  }
+}
+
+void BleChannel::onEnd(uint16_t count, uint32_t crc) {
+  if (count != _nextSeq) {
+    _windowStart = _nextSeq;
+    sendAck(AckStatus::RETRY);
+    return;
+  }
+  if (ConfigRecord::crc32(_rx.data(), _rx.size()) != crc) {
+    Serial.println("[BleChannel] Checksum mismatch");
+    resetTransfer();
+    sendAck(AckStatus::BAD);
+    return;
+  }
+
+  // Ack before handling so the client's write completes ahead of the reply
+  sendAck(AckStatus::DONE);
+  processRx();
+  resetTransfer();
+}
+
+void BleChannel::sendAck(AckStatus status) {
+  uint8_t ack[6] = {FRAME_ACK,
+                    3,
+                    0,
+                    (uint8_t)status,
+                    (uint8_t)(_nextSeq & 0xFF),
+                    (uint8_t)(_nextSeq >> 8)};
+  notifyChunked(ack, sizeof(ack));
+}
+
+void BleChannel::processRx() {
+  while (_rx.size() >= 3) {
+    uint8_t type = _rx[0];
+    size_t len = _rx[1] | (_rx[2] << 8);
+
+    if (type > (uint8_t)PayloadEncoding::MSGPACK || len == 0 ||
+        len > MAX_FRAME) {
+      Serial.println("[BleChannel] Invalid header, dropping buffer");
+      _rx.clear();
+      return;
+    }
+    if (_rx.size() < 3 + len) {
+      Serial.println("[BleChannel] Truncated frame");
+      _rx.clear();
+      return;
+    }
+
+    JsonDocument doc(&bleArena);
+    DeserializationError err =
+        (type == (uint8_t)PayloadEncoding::MSGPACK)
+            ? deserializeMsgPack(doc, _rx.data() + 3, len)
+            : deserializeJson(doc, _rx.data() + 3, len);
+    _rx.erase(_rx.begin(), _rx.begin() + 3 + len);
+
+    if (err) {
+      Serial.println("[BleChannel] Decode error: " + String(err.c_str()));
+      continue;
+    }
+    if (_onMessage)
+      _onMessage(doc, (PayloadEncoding)type);
+  }
+}
+
+bool BleChannel::send(const JsonDocument &doc, PayloadEncoding encoding,
+                      bool blocking) {
+  bool msgpack = encoding == PayloadEncoding::MSGPACK;
+  size_t len = msgpack ? measureMsgPack(doc) : measureJson(doc);
+  if (len > 0xFFFF) {
+    Serial.println("[BleChannel] Payload too large");
+    return false;
+  }
+
+  std::vector<uint8_t> frame(3 + len + 1); // Room for the JSON terminator
+  frame[0] = (uint8_t)encoding;
+  frame[1] = len & 0xFF;
+  frame[2] = (len >> 8) & 0xFF;
+  if (msgpack)
+    serializeMsgPack(doc, frame.data() + 3, len);
+  else
+    serializeJson(doc, (char *)frame.data() + 3, len + 1);
+  frame.resize(3 + len);
+
+  return notifyChunked(frame.data(), frame.size(), blocking);
+}
+
+bool BleChannel::notifyChunked(const uint8_t *data, size_t len,
+                               bool blocking) {
+  if (!_char || _connHandle == BLE_HS_CONN_HANDLE_NONE)
+    return false;
+
+  std::unique_lock<std::mutex> guard(_txLock, std::defer_lock);
+  if (blocking)
+    guard.lock();
+  else if (!guard.try_lock())
+    return false;
+
+  // Runs in the NimBLE host task for acks and replies, so never wait for
+  // buffers here: queue the frame and let loop() finish it
+  size_t pending = _tx.size() - _txSent;
+  if ((!blocking && pending > 0) || pending + len > MAX_PENDING) {
+    if (blocking)
+      Serial.println("[BleChannel] Send queue full");
+    return false;
+  }
+  _tx.erase(_tx.begin(), _tx.begin() + _txSent);
+  _txSent = 0;
+  _tx.insert(_tx.end(), data, data + len);
+  pump();
+  return true;
+}
+
+void BleChannel::loop() {
+  std::unique_lock<std::mutex> guard(_txLock, std::try_to_lock);
+  if (guard.owns_lock())
+    pump();
+}
+
+// Caller holds _txLock. Stops at the first chunk the host refuses.
+void BleChannel::pump() {
+  if (_connHandle == BLE_HS_CONN_HANDLE_NONE) {
+    _tx.clear();
+    _txSent = 0;
+    return;
+  }
+
+  uint16_t mtu = NimBLEDevice::getServer()->getPeerMTU(_connHandle);
+  size_t chunk = (mtu > 3) ? mtu - 3 : 20;
+
+  while (_txSent < _tx.size()) {
+    size_t n = min(chunk, _tx.size() - _txSent);
+    if (!_char->notify(_tx.data() + _txSent, n, _connHandle))
+      return;
+    _txSent += n;
+  }
+  _tx.clear();
+  _txSent = 0;
+}
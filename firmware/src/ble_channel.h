@@ -0,0 +1,88 @@
+#ifndef BLE_CHANNEL_H
+#define BLE_CHANNEL_H
+
+#include <ArduinoJson.h>
+#include <NimBLEDevice.h>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Companion service to the JSON gate, carrying the same commands either as
+// JSON or as MessagePack. Messages use the JSON gate frame layout:
+//   [type][len lo][len hi][payload...]   type 0x00 = JSON, 0x01 = MessagePack
+// Replies go back as notifications, in the request's encoding.
+//
+// Writes are windowed so a large frame does not cost one GATT round trip per
+// chunk. The client reads the characteristic to learn the link parameters
+//   [version][window][mtu lo][mtu hi]
+// then streams the frame with write-without-response packets
+//   DATA [0x10][seq lo][seq hi][bytes...]
+//   END  [0x11][count lo][count hi][crc32 LE x4]   (CRC32 of the whole frame)
+// and the device answers once per window (and once after END) with an ack
+// frame: [0x02][3][0][status][next seq lo][next seq hi]. A window is WINDOW
+// packets counted from the seq the client last resumed at. A client that
+// gets no ack resends its window; the device answers RETRY with its seq.
+#define SYNC_SERVICE_UUID "4fafc201-1fb5-459e-8fcc-c5c9c331914c"
+#define CHARACTERISTIC_SYNC_UUID "a1b2c3d4-1234-5678-9abc-def012345686"
+
+enum class PayloadEncoding : uint8_t { JSON = 0x00, MSGPACK = 0x01 };
+
+enum class AckStatus : uint8_t {
+  OK = 0,    // Window received, continue from seq
+  RETRY = 1, // Gap detected, resend from seq
+  BAD = 2,   // Checksum or size error, restart the frame
+  DONE = 3   // Frame complete and accepted
+};
+
+class BleChannel : public NimBLECharacteristicCallbacks {
+public:
+  using Handler = std::function<void(const JsonDocument &, PayloadEncoding)>;
+
+  // Must run after NimBLEDevice::init() and before advertising starts
+  void begin();
+  void setOnMessage(Handler handler) { _onMessage = handler; }
+  // Frames are queued whole and sent as far as the host has buffers; the
+  // rest goes out from loop(). Non-blocking sends give up when earlier
+  // frames are still queued, nothing of the frame is sent in that case.
+  bool send(const JsonDocument &doc, PayloadEncoding encoding,
+            bool blocking = true);
+  // Main loop: resume a frame the host had no buffers for
+  void loop();
+
+  void onRead(NimBLECharacteristic *characteristic,
+              NimBLEConnInfo &connInfo) override;
+  void onWrite(NimBLECharacteristic *characteristic,
+               NimBLEConnInfo &connInfo) override;
+  void onSubscribe(NimBLECharacteristic *characteristic,
+                   NimBLEConnInfo &connInfo, uint16_t subValue) override;
+
+private:
+  static const uint8_t PROTOCOL_VERSION = 1;
+  static const uint8_t WINDOW = 8;
+  static const size_t MAX_FRAME = 8192;
+  static const size_t MAX_PENDING = 16384; // Queued notification bytes
+  static const uint8_t OP_DATA = 0x10;
+  static const uint8_t OP_END = 0x11;
+  static const uint8_t FRAME_ACK = 0x02;
+
+  NimBLECharacteristic *_char = nullptr;
+  uint16_t _connHandle = BLE_HS_CONN_HANDLE_NONE;
+  std::vector<uint8_t> _rx;
+  uint16_t _nextSeq = 0;
+  uint16_t _windowStart = 0; // First seq of the window being received
+  bool _gapReported = false;
+  std::vector<uint8_t> _tx; // Queued notification bytes, whole frames
+  size_t _txSent = 0;       // Bytes of _tx already notified
+  Handler _onMessage;
+  std::mutex _txLock; // Frames from the BLE task and the main loop interleave
+
+  void resetTransfer();
+  void onData(uint16_t seq, const uint8_t *data, size_t len);
+  void onEnd(uint16_t count, uint32_t crc);
+  void sendAck(AckStatus status);
+  void processRx();
+  bool notifyChunked(const uint8_t *data, size_t len, bool blocking = true);
+  void pump();
+};
+
+#endif
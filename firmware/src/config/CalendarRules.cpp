@@ -0,0 +1,218 @@
+#include "CalendarRules.h"
+#include "../SolarCalculator.h"
+#include <algorithm>
+
+static const size_t MAX_NAME = 23; // EventsDisplay::Birthday::name
+
+static const char *WEEKDAYS[7] = {"sun", "mon", "tue", "wed",
+                                  "thu", "fri", "sat"};
+
+static long floorMod(long a, long b) {
+  long r = a % b;
+  return r < 0 ? r + b : r;
+}
+
+static bool isLeap(int year) {
+  return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static int daysInMonth(int year, int month) {
+  static const uint8_t DAYS[12] = {31, 28, 31, 30, 31, 30,
+                                   31, 31, 30, 31, 30, 31};
+  return month == 2 && isLeap(year) ? 29 : DAYS[month - 1];
+}
+
+// "YYYY-MM-DD" (year set) or "MM-DD" (year 0, a leap year: 02-29 is
+// accepted for yearly entries)
+static bool parseDate(const char *s, int &year, int &month, int &mday) {
+  int n = 0;
+  year = 0;
+  if (sscanf(s, "%d-%d-%d%n", &year, &month, &mday, &n) == 3 && !s[n]) {
+    if (year < 1970)
+      return false;
+  } else if (sscanf(s, "%d-%d%n", &month, &mday, &n) == 2 && !s[n]) {
+    year = 0;
+  } else {
+    return false;
+  }
+  return month >= 1 && month <= 12 && mday >= 1 &&
+         mday <= daysInMonth(year, month);
+}
+
+bool CalendarRules::compile(const String &text, int &errorLine) {
+  _ruleCount = _annualCount = _datedCount = _birthdayCount = 0;
+  _namesLen = 0;
+  errorLine = 0;
+
+  char line[64];
+  const char *p = text.c_str();
+  for (int number = 1; *p; number++) {
+    size_t n = strcspn(p, "\n;");
+    size_t len = min(n, sizeof(line) - 1);
+    memcpy(line, p, len);
+    line[len] = '\0';
+    p += n;
+    if (*p)
+      p++;
+
+    if (!parseLine(line) && errorLine == 0)
+      errorLine = number;
+  }
+
+  std::sort(_annual, _annual + _annualCount);
+  std::sort(_dated, _dated + _datedCount);
+  std::stable_sort(
+      _birthdays, _birthdays + _birthdayCount,
+      [](const Birthday &a, const Birthday &b) { return a.key < b.key; });
+  return errorLine == 0;
+}
+
+// True for a valid entry, a blank line or a comment
+bool CalendarRules::parseLine(char *line) {
+  char *hash = strchr(line, '#');
+  if (hash)
+    *hash = '\0';
+
+  char *rest = line;
+  char *kind = strtok_r(rest, " \t\r", &rest);
+  if (!kind)
+    return true;
+  for (char *c = kind; *c; c++)
+    *c = tolower(*c);
+
+  int year, month, mday;
+  if (!strcmp(kind, "black") || !strcmp(kind, "yellow")) {
+    char *period = strtok_r(rest, " \t\r", &rest);
+    char *when = strtok_r(rest, " \t\r", &rest);
+    if (!period || !when || _ruleCount == MAX_RULES)
+      return false;
+
+    Rule rule;
+    rule.stream = kind[0] == 'b' ? BLACK : YELLOW;
+    if (!strcasecmp(period, "weekly"))
+      rule.period = 1;
+    else if (!strcasecmp(period, "biweekly"))
+      rule.period = 2;
+    else
+      return false;
+
+    if (parseDate(when, year, month, mday) && year) {
+      rule.anchor = SolarCalculator::daysFromCivil(year, month, mday);
+    } else {
+      int wd = 0;
+      while (wd < 7 && strncasecmp(when, WEEKDAYS[wd], 3))
+        wd++;
+      if (wd == 7 || rule.period != 1)
+        return false; // Every other week needs a date to start from
+      rule.anchor = floorMod(wd - 4, 7); // Day 0 was a Thursday
+    }
+    _rules[_ruleCount++] = rule;
+    return true;
+  }
+
+  if (!strcmp(kind, "holiday")) {
+    char *when = strtok_r(rest, " \t\r", &rest);
+    if (!when || !parseDate(when, year, month, mday))
+      return false;
+    if (year == 0 && _annualCount < MAX_HOLIDAYS)
+      _annual[_annualCount++] = month * 32 + mday;
+    else if (year != 0 && _datedCount < MAX_HOLIDAYS)
+      _dated[_datedCount++] =
+          SolarCalculator::daysFromCivil(year, month, mday);
+    else
+      return false;
+    return true;
+  }
+
+  if (!strcmp(kind, "birthday")) {
+    char *when = strtok_r(rest, " \t\r", &rest);
+    if (!when || !parseDate(when, year, month, mday) || year != 0)
+      return false;
+    while (*rest == ' ' || *rest == '\t')
+      rest++;
+    size_t len = strcspn(rest, "\r");
+    while (len > 0 && rest[len - 1] == ' ')
+      len--;
+    len = min(len, MAX_NAME);
+    if (len == 0 || _birthdayCount == MAX_BIRTHDAYS ||
+        _namesLen + len + 1 > sizeof(_names))
+      return false;
+
+    Birthday &entry = _birthdays[_birthdayCount++];
+    entry.key = month * 32 + mday;
+    entry.name = _namesLen;
+    memcpy(_names + _namesLen, rest, len);
+    _names[_namesLen + len] = '\0';
+    _namesLen += len + 1;
+    return true;
+  }
+
+  return false;
+}
+
+bool CalendarRules::isHoliday(long day) const {
+  if (std::binary_search(_dated, _dated + _datedCount, day))
+    return true;
+  int year, month, mday;
+  SolarCalculator::civilFromDays(day, year, month, mday);
+  return std::binary_search(_annual, _annual + _annualCount,
+                            (uint16_t)(month * 32 + mday));
+}
+
+long CalendarRules::shifted(long day) const {
+  for (int i = 0; i < MAX_SHIFT && isHoliday(day); i++)
+    day++;
+  return day;
+}
+
+int CalendarRules::nextCollection(Stream stream, long today) const {
+  long best = -1;
+  for (uint8_t i = 0; i < _ruleCount; i++) {
+    const Rule &rule = _rules[i];
+    if (rule.stream != stream)
+      continue;
+
+    // Start far enough back to catch a collection shifted onto today
+    long step = 7 * rule.period;
+    long from = today - MAX_SHIFT;
+    long day = from + floorMod(rule.anchor - from, step);
+    while (shifted(day) < today)
+      day += step;
+    long next = shifted(day);
+    if (best < 0 || next < best)
+      best = next;
+  }
+  return best < 0 ? -1 : best - today;
+}
+
+int CalendarRules::upcoming(long today, int window, Upcoming *out,
+                            int max) const {
+  int year, month, mday;
+  SolarCalculator::civilFromDays(today, year, month, mday);
+  uint16_t key = month * 32 + mday;
+
+  const Birthday *first = std::lower_bound(
+      _birthdays, _birthdays + _birthdayCount, key,
+      [](const Birthday &b, uint16_t k) { return b.key < k; });
+  int start = first - _birthdays;
+
+  int count = 0;
+  for (int i = 0; i < _birthdayCount && count < max; i++) {
+    int index = start + i;
+    bool nextYear = index >= _birthdayCount; // Wrapped past December
+    const Birthday &entry = _birthdays[index % _birthdayCount];
+
+    int y = year + nextYear;
+    int m = entry.key / 32;
+    int d = entry.key % 32;
+    uint8_t shown = d;
+    if (m == 2 && d == 29 && !isLeap(y))
+      d = 28;
+    long until = SolarCalculator::daysFromCivil(y, m, d) - today;
+    if (until > window)
+      break;
+
+    out[count++] = {_names + entry.name, (uint8_t)m, shown, (int)until};
+  }
+  return count;
+}
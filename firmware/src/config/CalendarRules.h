@@ -0,0 +1,78 @@
+#ifndef CALENDAR_RULES_H
+#define CALENDAR_RULES_H
+
+#include <Arduino.h>
+
+// SystemConfig::calendar compiled once when the configuration loads. One
+// entry per line (or separated by ';'), '#' starts a comment:
+//
+//   black weekly mon               collection every Monday
+//   yellow biweekly 2026-01-08     every other week, from a collection date
+//   holiday 12-25                  every year
+//   holiday 2026-04-06             once
+//   birthday 03-14 Alice
+//
+// A collection falling on a holiday moves to the next day that is not a
+// holiday, weekend or not, at most MAX_SHIFT days later.
+// Holidays and birthdays are kept sorted in fixed arrays, so the daily
+// lookups are binary searches without any allocation.
+//
+// Days are day numbers as returned by SolarCalculator::daysFromCivil().
+class CalendarRules {
+public:
+  enum Stream : uint8_t { BLACK, YELLOW };
+
+  static const int MAX_RULES = 8;
+  static const int MAX_HOLIDAYS = 32;
+  static const int MAX_BIRTHDAYS = 64;
+  static const int MAX_SHIFT = 7; // Holiday shift, days
+
+  struct Upcoming {
+    const char *name;
+    uint8_t month; // 1-12
+    uint8_t day;
+    int daysUntil; // 0 = today
+  };
+
+  // False when a line is not understood; errorLine receives the first one
+  // (1-based). The other lines still apply.
+  bool compile(const String &text, int &errorLine);
+  bool empty() const { return _ruleCount == 0 && _birthdayCount == 0; }
+
+  // Days from today to the next collection of stream, -1 without a rule
+  int nextCollection(Stream stream, long today) const;
+  bool isHoliday(long day) const;
+
+  // Birthdays within window days from today, soonest first. Writes at most
+  // max entries to out and returns their count; names point into this
+  // object and stay valid until the next compile().
+  int upcoming(long today, int window, Upcoming *out, int max) const;
+
+private:
+  struct Rule {
+    Stream stream;
+    uint8_t period; // Weeks
+    long anchor;    // Any collection day
+  };
+
+  struct Birthday {
+    uint16_t key;  // month * 32 + day, sort key
+    uint16_t name; // Offset of the name in _names
+  };
+
+  Rule _rules[MAX_RULES];
+  uint8_t _ruleCount = 0;
+  uint16_t _annual[MAX_HOLIDAYS]; // month * 32 + day, sorted
+  uint8_t _annualCount = 0;
+  long _dated[MAX_HOLIDAYS]; // Day numbers, sorted
+  uint8_t _datedCount = 0;
+  Birthday _birthdays[MAX_BIRTHDAYS]; // Sorted by key
+  uint8_t _birthdayCount = 0;
+  char _names[768]; // NUL-separated birthday names
+  uint16_t _namesLen = 0;
+
+  bool parseLine(char *line);
+  long shifted(long day) const;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef CONFIG_CHANGE_H
+#define CONFIG_CHANGE_H
+
+#include <Arduino.h>
+
+// What a committed configuration change invalidates at runtime. Produced by
+// ConfigStore::commit() on the BLE task, merged until the main loop takes
+// it, then dispatched to modules so they redo only the affected work.
+struct ConfigChange {
+  uint16_t refetch = 0; // Slots whose source changed (url, type, path...)
+  uint16_t relabel = 0; // Slots whose presentation only changed
+  bool layout = false;  // Sensor panel style, redraw only
+  bool language = false;
+  bool tempus = false;   // Tempus URL, refetch calendar-based panels
+  bool location = false; // Latitude/longitude, recompute sun and seasons
+  bool calendar = false; // Calendar rules or ICS feed, recompute Events
+  bool moduleMap = false;
+
+  bool empty() const {
+    return !refetch && !relabel && !layout && !language && !tempus &&
+           !location && !calendar && !moduleMap;
+  }
+
+  void merge(const ConfigChange &other) {
+    refetch |= other.refetch;
+    relabel |= other.relabel;
+    layout |= other.layout;
+    language |= other.language;
+    tempus |= other.tempus;
+    location |= other.location;
+    calendar |= other.calendar;
+    moduleMap |= other.moduleMap;
+  }
+};
+
+#endif
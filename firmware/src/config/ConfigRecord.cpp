@@ -0,0 +1,255 @@
+#include "ConfigRecord.h"
+#include <Preferences.h>
+#include <stddef.h>
+
+static const char *NVS_NAMESPACE = "cfgrec";
+static const char *NVS_KEY = "record";
+static const char *NVS_WRITTEN_KEY = "written"; // Set by the first save()
+
+// True if a record whose struct is storedSize bytes long contains field
+#define RECORD_HAS(storedSize, Type, field)                                    \
+  (offsetof(Type, field) + sizeof(((Type *)nullptr)->field) <= (storedSize))
+
+namespace {
+
+// Builds the string area, storing each distinct string once
+class StringArea {
+public:
+  StringArea() { _data.push_back(0); } // Offset 0 is the empty string
+
+  uint16_t intern(const String &s) {
+    if (s.isEmpty())
+      return 0;
+
+    size_t pos = 1;
+    while (pos < _data.size()) {
+      const char *cur = (const char *)&_data[pos];
+      size_t len = strlen(cur);
+      if (len == s.length() && memcmp(cur, s.c_str(), len) == 0)
+        return pos;
+      pos += len + 1;
+    }
+
+    size_t off = _data.size();
+    if (off + s.length() + 1 > 0xFFFF) {
+      Serial.println("[ConfigRecord] String area full, dropping string");
+      return 0;
+    }
+    _data.insert(_data.end(), s.c_str(), s.c_str() + s.length() + 1);
+    return off;
+  }
+
+  const std::vector<uint8_t> &data() const { return _data; }
+
+private:
+  std::vector<uint8_t> _data;
+};
+
+} // namespace
+
+uint32_t ConfigRecord::crc32(const uint8_t *data, size_t len) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++)
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+void ConfigRecord::encode(const ConfigSnapshot &snap,
+                          std::vector<uint8_t> &out) {
+  StringArea strings;
+  const SystemConfig &sys = snap.system;
+
+  PackedSystem ps = {};
+  ps.ssid = strings.intern(sys.ssid);
+  ps.password = strings.intern(sys.password);
+  ps.ntpServer = strings.intern(sys.ntpServer);
+  ps.dnsMode = strings.intern(sys.dnsMode);
+  ps.dnsPrimary = strings.intern(sys.dnsPrimary);
+  ps.dnsSecondary = strings.intern(sys.dnsSecondary);
+  ps.tempusUrl = strings.intern(sys.tempusUrl);
+  ps.language = strings.intern(sys.language);
+  ps.moduleMap = strings.intern(sys.moduleMap);
+  ps.gmtOffset = sys.gmtOffset;
+  ps.dstOffset = sys.dstOffset;
+  ps.bleTimeout = sys.bleTimeout;
+  ps.sensorInterval = sys.sensorInterval;
+  ps.sensorStyle = sys.sensorStyle;
+  ps.netTolerance = sys.netTolerance;
+  ps.latitude = sys.latitude;
+  ps.longitude = sys.longitude;
+  ps.calendar = strings.intern(sys.calendar);
+  ps.icsUrl = strings.intern(sys.icsUrl);
+
+  PackedSensor sensors[SENSOR_SLOTS] = {};
+  for (int i = 0; i < SENSOR_SLOTS; i++) {
+    const SensorConfig &src = snap.sensors[i];
+    PackedSensor &dst = sensors[i];
+    dst.label = strings.intern(src.label);
+    dst.url = strings.intern(src.url);
+    dst.unit = strings.intern(src.unit);
+    dst.jsonPath = strings.intern(src.jsonPath);
+    dst.divisor = src.divisor;
+    dst.deadband = src.deadband;
+    dst.interval = src.interval;
+    dst.decimals = src.decimals;
+    dst.flags = (src.enabled ? FLAG_ENABLED : 0) |
+                (src.onChange ? FLAG_ON_CHANGE : 0) |
+                (src.deadbandMode == "rel" ? FLAG_DEADBAND_REL : 0) |
+                (src.type == "json" ? FLAG_TYPE_JSON : 0) |
+                (src.sparkline ? FLAG_SPARKLINE : 0);
+  }
+
+  const std::vector<uint8_t> &area = strings.data();
+
+  Header h = {};
+  h.magic = MAGIC;
+  h.version = VERSION;
+  h.headerSize = sizeof(Header);
+  h.systemSize = sizeof(PackedSystem);
+  h.sensorSize = sizeof(PackedSensor);
+  h.sensorCount = SENSOR_SLOTS;
+  h.stringAreaSize = area.size();
+
+  out.clear();
+  out.reserve(sizeof(Header) + sizeof(PackedSystem) + sizeof(sensors) +
+              area.size());
+  out.resize(sizeof(Header));
+  const uint8_t *p = (const uint8_t *)&ps;
+  out.insert(out.end(), p, p + sizeof(ps));
+  p = (const uint8_t *)sensors;
+  out.insert(out.end(), p, p + sizeof(sensors));
+  out.insert(out.end(), area.begin(), area.end());
+
+  h.crc = crc32(out.data() + sizeof(Header), out.size() - sizeof(Header));
+  memcpy(out.data(), &h, sizeof(Header));
+}
+
+bool ConfigRecord::decode(const uint8_t *data, size_t len,
+                          ConfigSnapshot &snap) {
+  if (len < sizeof(Header))
+    return false;
+
+  Header h;
+  memcpy(&h, data, sizeof(Header));
+  if (h.magic != MAGIC || h.version > VERSION || h.headerSize > len)
+    return false;
+
+  size_t expected = h.headerSize + h.systemSize +
+                    (size_t)h.sensorSize * h.sensorCount + h.stringAreaSize;
+  if (expected != len) {
+    Serial.println("[ConfigRecord] Size mismatch");
+    return false;
+  }
+  if (crc32(data + h.headerSize, len - h.headerSize) != h.crc) {
+    Serial.println("[ConfigRecord] CRC mismatch");
+    return false;
+  }
+
+  const uint8_t *sys = data + h.headerSize;
+  const uint8_t *sensors = sys + h.systemSize;
+  const char *area = (const char *)(sensors + h.sensorSize * h.sensorCount);
+  if (h.stringAreaSize == 0 || area[h.stringAreaSize - 1] != '\0')
+    return false;
+
+  auto str = [&](uint16_t off) -> const char * {
+    return off < h.stringAreaSize ? area + off : "";
+  };
+
+  // System settings (fields beyond systemSize keep their defaults)
+  PackedSystem ps = {};
+  memcpy(&ps, sys, min<size_t>(h.systemSize, sizeof(ps)));
+  SystemConfig &s = snap.system;
+  s = SystemConfig();
+  s.ssid = str(ps.ssid);
+  s.password = str(ps.password);
+  s.ntpServer = str(ps.ntpServer);
+  s.dnsMode = str(ps.dnsMode);
+  s.dnsPrimary = str(ps.dnsPrimary);
+  s.dnsSecondary = str(ps.dnsSecondary);
+  s.tempusUrl = str(ps.tempusUrl);
+  s.language = str(ps.language);
+  s.moduleMap = str(ps.moduleMap);
+  s.gmtOffset = ps.gmtOffset;
+  s.dstOffset = ps.dstOffset;
+  s.bleTimeout = ps.bleTimeout;
+  s.sensorInterval = ps.sensorInterval;
+  if (RECORD_HAS(h.systemSize, PackedSystem, sensorStyle))
+    s.sensorStyle = ps.sensorStyle;
+  if (RECORD_HAS(h.systemSize, PackedSystem, netTolerance))
+    s.netTolerance = ps.netTolerance;
+  if (RECORD_HAS(h.systemSize, PackedSystem, longitude)) {
+    s.latitude = ps.latitude;
+    s.longitude = ps.longitude;
+  }
+  if (RECORD_HAS(h.systemSize, PackedSystem, calendar))
+    s.calendar = str(ps.calendar);
+  if (RECORD_HAS(h.systemSize, PackedSystem, icsUrl))
+    s.icsUrl = str(ps.icsUrl);
+
+  for (int i = 0; i < SENSOR_SLOTS; i++) {
+    SensorConfig &dst = snap.sensors[i];
+    dst = SensorConfig();
+    if (i >= h.sensorCount)
+      continue;
+
+    PackedSensor src = {};
+    memcpy(&src, sensors + i * h.sensorSize,
+           min<size_t>(h.sensorSize, sizeof(src)));
+    dst.label = str(src.label);
+    dst.url = str(src.url);
+    dst.unit = str(src.unit);
+    dst.jsonPath = str(src.jsonPath);
+    dst.divisor = src.divisor;
+    dst.deadband = src.deadband;
+    dst.interval = src.interval;
+    dst.decimals = src.decimals;
+    dst.enabled = src.flags & FLAG_ENABLED;
+    dst.onChange = src.flags & FLAG_ON_CHANGE;
+    dst.deadbandMode = (src.flags & FLAG_DEADBAND_REL) ? "rel" : "abs";
+    dst.type = (src.flags & FLAG_TYPE_JSON) ? "json" : "prometheus";
+    dst.sparkline = src.flags & FLAG_SPARKLINE;
+  }
+
+  return true;
+}
+
+ConfigRecord::Status ConfigRecord::load(ConfigSnapshot &snap, size_t &size) {
+  size = 0;
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, true))
+    return Status::MISSING; // Namespace never created
+
+  Status status;
+  if (!prefs.isKey(NVS_KEY)) {
+    status = prefs.isKey(NVS_WRITTEN_KEY) ? Status::CORRUPT : Status::MISSING;
+  } else {
+    size_t len = prefs.getBytesLength(NVS_KEY);
+    std::vector<uint8_t> buf(len);
+    bool ok = len > 0 && prefs.getBytes(NVS_KEY, buf.data(), len) == len &&
+              decode(buf.data(), len, snap);
+    status = ok ? Status::OK : Status::CORRUPT;
+    if (ok)
+      size = len;
+  }
+  prefs.end();
+  return status;
+}
+
+size_t ConfigRecord::save(const ConfigSnapshot &snap) {
+  std::vector<uint8_t> buf;
+  encode(snap, buf);
+
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false)) {
+    Serial.println("[ConfigRecord] Failed to open NVS namespace");
+    return 0;
+  }
+  size_t written = prefs.putBytes(NVS_KEY, buf.data(), buf.size());
+  if (written > 0 && !prefs.isKey(NVS_WRITTEN_KEY))
+    prefs.putUChar(NVS_WRITTEN_KEY, 1);
+  prefs.end();
+  return written;
+}
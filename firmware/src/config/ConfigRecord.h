@@ -0,0 +1,92 @@
+#ifndef CONFIG_RECORD_H
+#define CONFIG_RECORD_H
+
+#include "ConfigStore.h"
+#include <Arduino.h>
+#include <vector>
+
+// Packed binary form of a ConfigSnapshot, stored as one NVS blob.
+//
+// Layout: [Header][PackedSystem][PackedSensor x count][string area]
+// Strings are NUL-terminated in the string area and referenced by 16-bit
+// offsets; identical strings are stored once (offset 0 is always "").
+// The CRC covers everything after the header. Struct sizes are recorded
+// so records written by an older firmware (shorter structs) still load,
+// missing trailing fields keep their defaults.
+class ConfigRecord {
+public:
+  static const uint32_t MAGIC = 0x46435045; // "EPCF"
+  static const uint16_t VERSION = 1;
+
+  struct __attribute__((packed)) Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint16_t systemSize;
+    uint16_t sensorSize;
+    uint16_t sensorCount;
+    uint16_t stringAreaSize;
+    uint32_t crc;
+  };
+
+  struct __attribute__((packed)) PackedSystem {
+    uint16_t ssid;
+    uint16_t password;
+    uint16_t ntpServer;
+    uint16_t dnsMode;
+    uint16_t dnsPrimary;
+    uint16_t dnsSecondary;
+    uint16_t tempusUrl;
+    uint16_t language;
+    uint16_t moduleMap;
+    int32_t gmtOffset;
+    int32_t dstOffset;
+    uint16_t bleTimeout;
+    uint16_t sensorInterval;
+    uint8_t sensorStyle;
+    uint16_t netTolerance;
+    float latitude;
+    float longitude;
+    uint16_t calendar;
+    uint16_t icsUrl;
+  };
+
+  enum SensorFlags : uint8_t {
+    FLAG_ENABLED = 1 << 0,
+    FLAG_ON_CHANGE = 1 << 1,
+    FLAG_DEADBAND_REL = 1 << 2,
+    FLAG_TYPE_JSON = 1 << 3, // Otherwise "prometheus"
+    FLAG_SPARKLINE = 1 << 4,
+  };
+
+  struct __attribute__((packed)) PackedSensor {
+    uint16_t label;
+    uint16_t url;
+    uint16_t unit;
+    uint16_t jsonPath;
+    float divisor;
+    float deadband;
+    uint32_t interval;
+    int8_t decimals;
+    uint8_t flags;
+  };
+
+  // Serialize / parse without touching NVS
+  static void encode(const ConfigSnapshot &snap, std::vector<uint8_t> &out);
+  static bool decode(const uint8_t *data, size_t len, ConfigSnapshot &snap);
+
+  enum class Status {
+    OK,
+    MISSING, // No record was ever written: first boot on this firmware
+    CORRUPT  // Damaged, or gone although one was written before
+  };
+
+  // NVS blob access. load() sets size to the record size in bytes; save()
+  // returns it (0 on failure) and remembers that a record now exists.
+  static Status load(ConfigSnapshot &snap, size_t &size);
+  static size_t save(const ConfigSnapshot &snap);
+
+  static uint32_t crc32(const uint8_t *data, size_t len);
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "ConfigStore.h"
+#include "ConfigRecord.h"
+
+ConfigStore::ConfigStore(ConfigHelper &config) : _config(config) {}
+
+void ConfigStore::load() {
+  unsigned long start = micros();
+  ConfigSnapshot &snap = _buffers[_active.load()];
+
+  size_t len;
+  switch (ConfigRecord::load(snap, len)) {
+  case ConfigRecord::Status::OK:
+    _loadMicros = micros() - start;
+    _recordSize = len;
+    break;
+  case ConfigRecord::Status::MISSING:
+    // First boot on this firmware: import the legacy keys, once
+    Serial.println("[ConfigStore] No record yet, migrating legacy keys");
+    readLegacy(snap);
+    _loadMicros = micros() - start;
+    persist(snap);
+    break;
+  case ConfigRecord::Status::CORRUPT:
+    // Legacy keys stopped being updated at the migration; importing them
+    // again would silently roll the device back to that configuration
+    Serial.println("[ConfigStore] Config record damaged, using defaults");
+    snap = ConfigSnapshot();
+    _loadMicros = micros() - start;
+    break;
+  }
+
+  compile(snap);
+  snap.generation = 1;
+  Serial.printf("[ConfigStore] Loaded in %lu us (record %u bytes)\n",
+                _loadMicros, (unsigned)_recordSize);
+}
+
+ConfigSnapshot *ConfigStore::stage() {
+  uint8_t active = _active.load();
+  // A pass that started before the last commit may still read the other
+  // buffer; it is free once the main loop has quiesced since. Waiting here
+  // would stall the BLE host, so the caller retries instead.
+  if (_readerBuffer.load() != active)
+    return nullptr;
+  ConfigSnapshot &next = _buffers[active ^ 1];
+  next = _buffers[active];
+  return &next;
+}
+
+bool ConfigStore::commit(std::vector<String> &changed) {
+  uint8_t active = _active.load();
+  ConfigSnapshot &next = _buffers[active ^ 1];
+
+  changed = diff(_buffers[active], next);
+  if (changed.empty()) {
+    Serial.println("[ConfigStore] No changes, nothing to commit");
+    return true;
+  }
+
+  next.generation = _buffers[active].generation + 1;
+  compile(next);
+  // Not in NVS: publishing it would lose the change on the next reboot
+  if (!persist(next))
+    return false;
+  ConfigChange change = classify(_buffers[active], next);
+  _active.store(active ^ 1);
+  {
+    std::lock_guard<std::mutex> guard(_pendingLock);
+    _pending.merge(change);
+  }
+  Serial.printf("[ConfigStore] Committed generation %lu (%u keys changed)\n",
+                (unsigned long)next.generation, (unsigned)changed.size());
+  return true;
+}
+
+// JSON paths are compiled here, once per configuration, never per fetch
+void ConfigStore::compile(ConfigSnapshot &snap) {
+  for (int i = 0; i < SENSOR_SLOTS; i++) {
+    const SensorConfig &sensor = snap.sensors[i];
+    if (!snap.jsonPaths[i].compile(sensor.jsonPath) && sensor.type == "json")
+      Serial.printf("[ConfigStore] Sensor %d: unsupported JSON path '%s'\n", i,
+                    sensor.jsonPath.c_str());
+  }
+
+  int line;
+  if (!snap.calendar.compile(snap.system.calendar, line))
+    Serial.printf("[ConfigStore] Calendar: line %d not understood\n", line);
+}
+
+// Key names match the BLE protocol (get_config / save_config)
+std::vector<String> ConfigStore::diff(const ConfigSnapshot &from,
+                                      const ConfigSnapshot &to) {
+  std::vector<String> out;
+  const SystemConfig &a = from.system;
+  const SystemConfig &b = to.system;
+
+#define DIFF_FIELD(field, key)                                                 \
+  if (a.field != b.field)                                                      \
+    out.push_back(key);
+
+  DIFF_FIELD(ssid, "ssid")
+  DIFF_FIELD(password, "password")
+  DIFF_FIELD(ntpServer, "ntpServer")
+  DIFF_FIELD(gmtOffset, "gmt")
+  DIFF_FIELD(dstOffset, "dst")
+  DIFF_FIELD(dnsMode, "dnsMode")
+  DIFF_FIELD(dnsPrimary, "dnsPrimary")
+  DIFF_FIELD(dnsSecondary, "dnsSecondary")
+  DIFF_FIELD(tempusUrl, "tempusUrl")
+  DIFF_FIELD(bleTimeout, "bleTimeout")
+  DIFF_FIELD(sensorInterval, "sensorInterval")
+  DIFF_FIELD(language, "lang")
+  DIFF_FIELD(sensorStyle, "style")
+  DIFF_FIELD(moduleMap, "module_map")
+  DIFF_FIELD(netTolerance, "netTolerance")
+  DIFF_FIELD(latitude, "lat")
+  DIFF_FIELD(longitude, "lon")
+  DIFF_FIELD(calendar, "calendar")
+  DIFF_FIELD(icsUrl, "icsUrl")
+#undef DIFF_FIELD
+
+  for (int i = 0; i < SENSOR_SLOTS; i++) {
+    if (from.sensors[i] != to.sensors[i])
+      out.push_back("sensor_" + String(i));
+  }
+  return out;
+}
+
+// Map field-level differences to the runtime work they invalidate. Fields
+// missing here (WiFi, NTP, DNS, BLE timeout, deadbands, network tolerance)
+// are picked up at the next boot or the next fetch without any extra work.
+ConfigChange ConfigStore::classify(const ConfigSnapshot &from,
+                                   const ConfigSnapshot &to) {
+  ConfigChange change;
+  const SystemConfig &a = from.system;
+  const SystemConfig &b = to.system;
+
+  change.layout = a.sensorStyle != b.sensorStyle;
+  change.language = a.language != b.language;
+  change.tempus = a.tempusUrl != b.tempusUrl;
+  change.location = a.latitude != b.latitude || a.longitude != b.longitude;
+  change.calendar = a.calendar != b.calendar || a.icsUrl != b.icsUrl;
+  change.moduleMap = a.moduleMap != b.moduleMap;
+
+  for (int i = 0; i < SENSOR_SLOTS; i++) {
+    const SensorConfig &s = from.sensors[i];
+    const SensorConfig &t = to.sensors[i];
+    bool usesDefault = t.interval <= 0;
+    if (s.url != t.url || s.type != t.type || s.jsonPath != t.jsonPath ||
+        s.divisor != t.divisor || s.enabled != t.enabled ||
+        s.interval != t.interval ||
+        (usesDefault && a.sensorInterval != b.sensorInterval))
+      change.refetch |= 1u << i;
+    else if (s.label != t.label || s.unit != t.unit ||
+             s.decimals != t.decimals || s.sparkline != t.sparkline)
+      change.relabel |= 1u << i;
+  }
+  return change;
+}
+
+ConfigChange ConfigStore::takeChanges() {
+  std::lock_guard<std::mutex> guard(_pendingLock);
+  ConfigChange change = _pending;
+  _pending = ConfigChange();
+  return change;
+}
+
+void ConfigStore::readLegacy(ConfigSnapshot &snap) {
+  SystemConfig &sys = snap.system;
+  sys.ssid = _config.get("ssid", String(""));
+  sys.password = _config.get("password", String(""));
+  sys.ntpServer = _config.get("ntp_srv", String("pool.ntp.org"));
+  sys.gmtOffset = _config.get("ntp_gmt", 3600L);
+  sys.dstOffset = _config.get("ntp_dst", 3600);
+  sys.dnsMode = _config.get("dns_mode", String("auto"));
+  sys.dnsPrimary = _config.get("dns_pri", String("8.8.8.8"));
+  sys.dnsSecondary = _config.get("dns_sec", String("1.1.1.1"));
+  sys.tempusUrl = _config.get("tempus_url", String(""));
+  sys.bleTimeout = _config.get("ble_timeout", 15);
+  sys.sensorInterval = _config.get("sensorInterval", 60);
+  sys.language = _config.get("language", String("en"));
+  sys.sensorStyle = _config.get("sens_style", 0);
+  sys.moduleMap = _config.get("module_map", String(""));
+
+  for (int i = 0; i < SENSOR_SLOTS; i++) {
+    String key = "sensor_" + String(i);
+    JsonDocument sDoc;
+    snap.sensors[i] = SensorConfig();
+    if (_config.get(key.c_str(), sDoc)) {
+      SensorConfigHelper::fromJson(sDoc.as<JsonVariantConst>(),
+                                   snap.sensors[i]);
+    }
+  }
+}
+
+bool ConfigStore::persist(const ConfigSnapshot &snap) {
+  size_t written = ConfigRecord::save(snap);
+  if (written == 0) {
+    Serial.println("[ConfigStore] Failed to write config record");
+    return false;
+  }
+  _recordSize = written;
+  _bytesWritten += written;
+  return true;
+}
@@ -0,0 +1,179 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include "CalendarRules.h"
+#include "ConfigChange.h"
+#include "JsonPath.h"
+#include "SensorConfig.h"
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <esp-iot-utils.h>
+
+struct SystemConfig {
+  String ssid;
+  String password;
+  String ntpServer = "pool.ntp.org";
+  long gmtOffset = 3600;
+  int dstOffset = 3600;
+  String dnsMode = "auto";
+  String dnsPrimary = "8.8.8.8";
+  String dnsSecondary = "1.1.1.1";
+  String tempusUrl;
+  int bleTimeout = 15;     // Minutes, 0 = never stop BLE
+  int sensorInterval = 60; // Seconds
+  String language = "en";
+  int sensorStyle = 0;
+  String moduleMap;
+  int netTolerance = 0; // Burst tolerance in seconds, 0 = radio always on
+  float latitude = 0;   // Degrees north; 0/0 = unset, sun data from Tempus
+  float longitude = 0;  // Degrees east
+  String calendar;      // Trash/birthday rules, see CalendarRules
+  String icsUrl;        // iCalendar feed for the Events agenda
+};
+
+// JSON mapping used by the BLE protocol. The WiFi password is write-only:
+// toJson() never includes it, fromJson() applies only the fields present.
+class SystemConfigHelper {
+public:
+  static void toJson(const SystemConfig &src, JsonVariant dest) {
+    dest["ssid"] = src.ssid;
+    dest["ntpServer"] = src.ntpServer;
+    dest["gmt"] = src.gmtOffset;
+    dest["dst"] = src.dstOffset;
+    dest["dnsMode"] = src.dnsMode;
+    dest["dnsPrimary"] = src.dnsPrimary;
+    dest["dnsSecondary"] = src.dnsSecondary;
+    dest["tempusUrl"] = src.tempusUrl;
+    dest["bleTimeout"] = src.bleTimeout;
+    dest["sensorInterval"] = src.sensorInterval;
+    dest["lang"] = src.language;
+    dest["style"] = src.sensorStyle;
+    dest["module_map"] = src.moduleMap;
+    dest["netTolerance"] = src.netTolerance;
+    dest["lat"] = src.latitude;
+    dest["lon"] = src.longitude;
+    dest["calendar"] = src.calendar;
+    dest["icsUrl"] = src.icsUrl;
+  }
+
+  static void fromJson(JsonObjectConst src, SystemConfig &dest) {
+    if (!src["ssid"].isNull())
+      dest.ssid = src["ssid"].as<String>();
+    if (!src["password"].isNull())
+      dest.password = src["password"].as<String>();
+    if (!src["ntpServer"].isNull())
+      dest.ntpServer = src["ntpServer"].as<String>();
+    if (!src["gmt"].isNull())
+      dest.gmtOffset = src["gmt"].as<long>();
+    if (!src["dst"].isNull())
+      dest.dstOffset = src["dst"].as<int>();
+    if (!src["dnsMode"].isNull())
+      dest.dnsMode = src["dnsMode"].as<String>();
+    if (!src["dnsPrimary"].isNull())
+      dest.dnsPrimary = src["dnsPrimary"].as<String>();
+    if (!src["dnsSecondary"].isNull())
+      dest.dnsSecondary = src["dnsSecondary"].as<String>();
+    if (!src["tempusUrl"].isNull())
+      dest.tempusUrl = src["tempusUrl"].as<String>();
+    if (!src["bleTimeout"].isNull())
+      dest.bleTimeout = src["bleTimeout"].as<int>();
+    if (!src["sensorInterval"].isNull())
+      dest.sensorInterval = src["sensorInterval"].as<int>();
+    if (!src["lang"].isNull())
+      dest.language = src["lang"].as<String>();
+    if (!src["style"].isNull())
+      dest.sensorStyle = src["style"].as<int>();
+    if (!src["module_map"].isNull())
+      dest.moduleMap = src["module_map"].as<String>();
+    if (!src["netTolerance"].isNull())
+      dest.netTolerance = src["netTolerance"].as<int>();
+    if (!src["lat"].isNull())
+      dest.latitude = src["lat"].as<float>();
+    if (!src["lon"].isNull())
+      dest.longitude = src["lon"].as<float>();
+    if (!src["calendar"].isNull())
+      dest.calendar = src["calendar"].as<String>();
+    if (!src["icsUrl"].isNull())
+      dest.icsUrl = src["icsUrl"].as<String>();
+  }
+};
+
+// Everything the firmware reads at runtime, typed and already parsed.
+struct ConfigSnapshot {
+  uint32_t generation = 0;
+  SystemConfig system;
+  SensorConfig sensors[SENSOR_SLOTS];
+  JsonPath jsonPaths[SENSOR_SLOTS]; // sensors[i].jsonPath, compiled
+  CalendarRules calendar;           // system.calendar, compiled
+};
+
+// Owns the in-RAM configuration. NVS is read once in load(), hot paths only
+// read current(). Persistence is a single packed ConfigRecord blob; the
+// legacy per-key JSON layout (sensor_0..15, ssid, ...) is only read to
+// migrate on first boot, before any record was written; a damaged record
+// falls back to defaults. Writers (BLE task) edit a staged copy, and commit()
+// diffs it against the current snapshot. Nothing is written when nothing
+// changed; otherwise the whole record goes out as one NVS blob write (atomic:
+// a power loss leaves either the old or the new record) and, once written,
+// is published with a single atomic swap.
+//
+// The main loop may hold references from current() for a whole pass, even
+// across blocking calls, but never from one pass to the next: it calls
+// quiesce() at the top of each pass. stage() overwrites the buffer that was
+// current before the last commit, so it returns nullptr until the main loop
+// went through quiesce() after that commit. The BLE task reads current()
+// only from the command handler that also stages, so it never races
+// itself; the fetch task only ever gets copies.
+//
+// Each commit also records a ConfigChange; the main loop collects them with
+// takeChanges() and invalidates only what they touch.
+class ConfigStore {
+public:
+  ConfigStore(ConfigHelper &config);
+
+  void load();
+
+  const ConfigSnapshot &current() const { return _buffers[_active.load()]; }
+  uint32_t generation() const { return current().generation; }
+
+  // Main loop, once per pass while no current() reference is held
+  void quiesce() { _readerBuffer.store(_active.load()); }
+
+  ConfigSnapshot *stage(); // nullptr until the next quiesce(), retry later
+  // Fills changed with the changed keys. False when the record could not
+  // be written: the staged copy is then not published.
+  bool commit(std::vector<String> &changed);
+
+  static std::vector<String> diff(const ConfigSnapshot &from,
+                                  const ConfigSnapshot &to);
+  static ConfigChange classify(const ConfigSnapshot &from,
+                               const ConfigSnapshot &to);
+
+  // Changes committed since the last call (main loop)
+  ConfigChange takeChanges();
+
+  // Storage metrics
+  unsigned long loadMicros() const { return _loadMicros; }
+  size_t recordSize() const { return _recordSize; }
+  uint32_t bytesWritten() const { return _bytesWritten; }
+
+private:
+  ConfigHelper &_config;
+  ConfigSnapshot _buffers[2];
+  std::atomic<uint8_t> _active{0};
+  std::atomic<uint8_t> _readerBuffer{0}; // Active at the last quiesce()
+  std::mutex _pendingLock;
+  ConfigChange _pending;
+
+  unsigned long _loadMicros = 0;
+  size_t _recordSize = 0;
+  uint32_t _bytesWritten = 0;
+
+  void readLegacy(ConfigSnapshot &snap);
+  static void compile(ConfigSnapshot &snap);
+  bool persist(const ConfigSnapshot &snap);
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "ConfigSync.h"
+#include "../JsonArena.h"
+#include "ConfigRecord.h"
+#include <vector>
+
+// Hash of the MessagePack encoding, stable for a given firmware version
+uint32_t ConfigSync::hashJson(const JsonDocument &doc) {
+  size_t len = measureMsgPack(doc);
+  std::vector<uint8_t> buf(len);
+  serializeMsgPack(doc, buf.data(), len);
+  return ConfigRecord::crc32(buf.data(), len);
+}
+
+uint32_t ConfigSync::hashSystem(const SystemConfig &sys) {
+  JsonDocument doc(&bleArena);
+  SystemConfigHelper::toJson(sys, doc.to<JsonVariant>());
+  return hashJson(doc);
+}
+
+uint32_t ConfigSync::hashSensor(const SensorConfig &sensor) {
+  JsonDocument doc(&bleArena);
+  SensorConfigHelper::toJson(sensor, doc.to<JsonVariant>());
+  return hashJson(doc);
+}
+
+void ConfigSync::writeManifest(const ConfigSnapshot &snap, JsonVariant dest) {
+  dest["v"] = PROTOCOL_VERSION;
+  dest["generation"] = snap.generation;
+  dest["system"] = hashSystem(snap.system);
+
+  JsonArray sensors = dest["sensors"].to<JsonArray>();
+  for (int i = 0; i < SENSOR_SLOTS; i++)
+    sensors.add(hashSensor(snap.sensors[i]));
+}
+
+void ConfigSync::writeSections(const ConfigSnapshot &snap,
+                               JsonVariantConst request, JsonVariant dest) {
+  dest["generation"] = snap.generation;
+
+  if (request["system"] | false)
+    SystemConfigHelper::toJson(snap.system, dest["system"].to<JsonObject>());
+
+  JsonObject sensors = dest["sensors"].to<JsonObject>();
+  for (JsonVariantConst idx : request["sensors"].as<JsonArrayConst>()) {
+    int i = idx | -1;
+    if (i < 0 || i >= SENSOR_SLOTS)
+      continue;
+    SensorConfigHelper::toJson(snap.sensors[i],
+                               sensors[String(i)].to<JsonObject>());
+  }
+}
+
+void ConfigSync::applySensors(JsonVariantConst sensors, ConfigSnapshot &dest) {
+  if (sensors.is<JsonArrayConst>()) {
+    int i = 0;
+    for (JsonVariantConst s : sensors.as<JsonArrayConst>()) {
+      if (i >= SENSOR_SLOTS)
+        break;
+      dest.sensors[i] = SensorConfig();
+      SensorConfigHelper::fromJson(s, dest.sensors[i++]);
+    }
+  } else if (sensors.is<JsonObjectConst>()) {
+    for (JsonPairConst kv : sensors.as<JsonObjectConst>()) {
+      const char *key = kv.key().c_str();
+      int i = isdigit((uint8_t)key[0]) ? atoi(key) : -1;
+      if (i < 0 || i >= SENSOR_SLOTS)
+        continue;
+      dest.sensors[i] = SensorConfig();
+      SensorConfigHelper::fromJson(kv.value(), dest.sensors[i]);
+    }
+  }
+}
@@ -0,0 +1,32 @@
+#ifndef CONFIG_SYNC_H
+#define CONFIG_SYNC_H
+
+#include "ConfigStore.h"
+#include <ArduinoJson.h>
+
+// Incremental config sync: the app caches sections (system + one per sensor
+// slot) together with their hash, asks for the manifest on connect and only
+// pulls sections whose hash changed. Pushes only carry edited sections.
+class ConfigSync {
+public:
+  static const int PROTOCOL_VERSION = 1;
+
+  static uint32_t hashSystem(const SystemConfig &sys);
+  static uint32_t hashSensor(const SensorConfig &sensor);
+
+  // { v, generation, system: <hash>, sensors: [<hash> x 16] }
+  static void writeManifest(const ConfigSnapshot &snap, JsonVariant dest);
+
+  // request: { system: true, sensors: [3, 5] }
+  // dest:    { generation, system: {...}, sensors: { "3": {...}, ... } }
+  static void writeSections(const ConfigSnapshot &snap,
+                            JsonVariantConst request, JsonVariant dest);
+
+  // Applies "sensors" given either as the full array or as an index map
+  static void applySensors(JsonVariantConst sensors, ConfigSnapshot &dest);
+
+private:
+  static uint32_t hashJson(const JsonDocument &doc);
+};
+
+#endif
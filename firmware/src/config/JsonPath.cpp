@@ -0,0 +1,65 @@
+#include "JsonPath.h"
+
+bool JsonPath::compile(const String &path) {
+  _count = 0;
+  _valid = false;
+  size_t keysLen = 0;
+  const char *p = path.c_str();
+
+  while (*p) {
+    if (*p == '.') {
+      p++;
+      continue;
+    }
+    if (_count == MAX_TOKENS)
+      return false;
+
+    Token &token = _tokens[_count++];
+    if (*p == '[') {
+      if (!isdigit((unsigned char)p[1]))
+        return false; // [], [-1], [ 1] or [x]
+      char *end;
+      long index = strtol(p + 1, &end, 10);
+      if (*end != ']' || index > UINT16_MAX)
+        return false;
+      token.isIndex = true;
+      token.index = index;
+      p = end + 1;
+    } else {
+      size_t n = strcspn(p, ".[");
+      if (keysLen + n + 1 > sizeof(_keys))
+        return false;
+      token.isIndex = false;
+      token.key = keysLen;
+      memcpy(_keys + keysLen, p, n);
+      _keys[keysLen + n] = '\0';
+      keysLen += n + 1;
+      p += n;
+    }
+  }
+
+  // An empty path would resolve to the whole document and read as 0
+  _valid = _count > 0;
+  return _valid;
+}
+
+void JsonPath::buildFilter(JsonDocument &filter) const {
+  JsonVariant node = filter.to<JsonVariant>();
+  for (uint8_t i = 0; i < _count; i++) {
+    const Token &token = _tokens[i];
+    if (token.isIndex)
+      node = node.add<JsonVariant>(); // Applies to every element
+    else
+      node = node[_keys + token.key].to<JsonVariant>();
+  }
+  node.set(true);
+}
+
+JsonVariantConst JsonPath::resolve(JsonVariantConst root) const {
+  JsonVariantConst cur = root;
+  for (uint8_t i = 0; i < _count && !cur.isNull(); i++) {
+    const Token &token = _tokens[i];
+    cur = token.isIndex ? cur[token.index] : cur[_keys + token.key];
+  }
+  return cur;
+}
@@ -0,0 +1,40 @@
+#ifndef JSON_PATH_H
+#define JSON_PATH_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// SensorConfig::jsonPath compiled once when the configuration loads: dot
+// notation for objects and [n] for arrays, e.g. data.values[0].temp.
+// The token program both builds the deserialization filter (only the
+// addressed branch of a response is kept) and walks the parsed document,
+// so a fetch never re-reads the path text.
+class JsonPath {
+public:
+  static const int MAX_TOKENS = 10;
+
+  // False when the path is empty, malformed or too long for the program
+  bool compile(const String &path);
+  bool valid() const { return _valid; }
+
+  // Filter keeping only the addressed branch; an index keeps the matching
+  // field of every element (ArduinoJson filters cannot select one index)
+  void buildFilter(JsonDocument &filter) const;
+
+  // Null when the path does not exist in root
+  JsonVariantConst resolve(JsonVariantConst root) const;
+
+private:
+  struct Token {
+    bool isIndex;
+    uint8_t key; // Offset of the key in _keys
+    uint16_t index;
+  };
+
+  Token _tokens[MAX_TOKENS];
+  uint8_t _count = 0;
+  bool _valid = false;
+  char _keys[64]; // NUL-separated object keys
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef SENSOR_CONFIG_H
+#define SENSOR_CONFIG_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Total number of sensor slots (2 panels x 8 cells)
+static const int SENSOR_SLOTS = 16;
+
+struct SensorConfig {
+  String label;  // Label displayed on screen (e.g., "Conso. EDF")
+  String url;    // Full URL (Prometheus query or JSON API)
+  String unit;   // Unit of measurement (e.g., "kWh", "°C", "W")
+  float divisor; // Conversion divisor (e.g., 1000 for Wh → kWh)
+  int decimals;  // Number of decimals to display (0-2)
+  bool enabled;  // Whether this sensor is active
+  String type;   // "prometheus" or "json"
+  String
+      jsonPath; // Path based on simple dot/check notation (e.g. data.values[0])
+  int interval; // Refresh interval in seconds (0 = global sensorInterval)
+  float deadband;      // Minimum change before redraw (0 = off)
+  String deadbandMode; // "abs" (same unit as value) or "rel" (% of value)
+  bool onChange;       // Redraw only if the formatted string changed
+  bool sparkline;      // Draw the recent history next to the value
+
+  SensorConfig()
+      : label(""), url(""), unit(""), divisor(1.0), decimals(1), enabled(false),
+        type("prometheus"), jsonPath(""), interval(0), deadband(0),
+        deadbandMode("abs"), onChange(true), sparkline(false) {}
+
+  bool operator==(const SensorConfig &o) const {
+    return label == o.label && url == o.url && unit == o.unit &&
+           divisor == o.divisor && decimals == o.decimals &&
+           enabled == o.enabled && type == o.type && jsonPath == o.jsonPath &&
+           interval == o.interval && deadband == o.deadband &&
+           deadbandMode == o.deadbandMode && onChange == o.onChange &&
+           sparkline == o.sparkline;
+  }
+  bool operator!=(const SensorConfig &o) const { return !(*this == o); }
+};
+
+class SensorConfigHelper {
+public:
+  static void fromJson(JsonVariantConst src, SensorConfig &dest) {
+    dest.label = src["label"] | "";
+    dest.url = src["url"] | "";
+    dest.unit = src["unit"] | "";
+    dest.divisor = src["divisor"] | 1.0f;
+    dest.decimals = src["decimals"] | 1;
+    dest.enabled = src["enabled"] | false;
+    dest.type = src["type"] | "prometheus";
+    dest.jsonPath = src["jsonPath"] | "";
+    dest.interval = src["interval"] | 0;
+    dest.deadband = src["deadband"] | 0.0f;
+    dest.deadbandMode = src["deadbandMode"] | "abs";
+    dest.onChange = src["onChange"] | true;
+    dest.sparkline = src["sparkline"] | false;
+  }
+
+  static void toJson(const SensorConfig &src, JsonVariant dest) {
+    dest["label"] = src.label;
+    dest["url"] = src.url;
+    dest["unit"] = src.unit;
+    dest["divisor"] = src.divisor;
+    dest["decimals"] = src.decimals;
+    dest["enabled"] = src.enabled;
+    dest["type"] = src.type;
+    dest["jsonPath"] = src.jsonPath;
+    dest["interval"] = src.interval;
+    dest["deadband"] = src.deadband;
+    dest["deadbandMode"] = src.deadbandMode;
+    dest["onChange"] = src.onChange;
+    dest["sparkline"] = src.sparkline;
+  }
+};
+
+#endif
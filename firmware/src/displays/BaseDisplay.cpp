@@ -0,0 +1,78 @@
+#include "BaseDisplay.h"
+#include <esp-iot-utils.h>
+
+// Corner reserved for the stale badge, inside the panel frames
+static const int BADGE_INSET = 14;
+static const int BADGE_W = 48; // Whole bytes for the partial window
+static const int BADGE_H = 16;
+
+BaseDisplay::Age BaseDisplay::formatAge(unsigned long ageMs) {
+  unsigned long minutes = ageMs / 60000;
+  Age age;
+  if (minutes < 15)
+    age = "<15m";
+  else if (minutes < 60)
+    age.format("%lum", minutes / 15 * 15);
+  else if (minutes < 24 * 60)
+    age.format("%luh", minutes / 60);
+  else
+    age.format("%lud", minutes / (24 * 60));
+  return age;
+}
+
+void BaseDisplay::drawBadge(int right, int top, const char *text, uint16_t fg,
+                            uint16_t bg) {
+  _u8g2.setFont(u8g2_font_helvB08_tf);
+  int w = min(_u8g2.getUTF8Width(text) + 8, BADGE_W);
+  _gfx->fillRect(right - w, top, w, BADGE_H - 2, fg);
+  _u8g2.setForegroundColor(bg);
+  _u8g2.setBackgroundColor(fg);
+  _u8g2.setCursor(right - w + 4, top + BADGE_H - 5);
+  _u8g2.print(text);
+}
+
+void BaseDisplay::drawStaleBadge() {
+  if (_staleAge.isEmpty())
+    return;
+  drawBadge(_gfx->width() - BADGE_INSET, BADGE_INSET, _staleAge.c_str(),
+            GxEPD_BLACK, GxEPD_WHITE);
+}
+
+bool BaseDisplay::drawError(const char *message) {
+  if (_error == message || !beginFrame())
+    return false;
+
+  _gfx->fillScreen(GxEPD_WHITE);
+  _u8g2.setForegroundColor(GxEPD_BLACK);
+  _u8g2.setBackgroundColor(GxEPD_WHITE);
+  _u8g2.setFont(u8g2_font_helvB14_tf);
+
+  int w = _u8g2.getUTF8Width(message);
+  int x = (_gfx->width() - w) / 2;
+  int y = _gfx->height() / 2;
+
+  _u8g2.setCursor(x, y);
+  _u8g2.print(message);
+
+  _u8g2.setFont(u8g2_font_helvR10_tf);
+  const char *sub = (TimeHelper::getLanguage() == "fr")
+                        ? "Verifier WiFi / URL"
+                        : "Check WiFi / URL";
+  int w2 = _u8g2.getUTF8Width(sub);
+  _u8g2.setCursor((_gfx->width() - w2) / 2, y + 25);
+  _u8g2.print(sub);
+
+  _panel->present(true); // Always full refresh
+  _error = message;
+  return true;
+}
+
+void BaseDisplay::present(bool fullRefresh) {
+  _error.clear();
+  if (!_badgeOnly) {
+    _panel->present(fullRefresh);
+    return;
+  }
+  _panel->present(false, _gfx->width() - BADGE_INSET - BADGE_W, BADGE_INSET,
+                  BADGE_W, BADGE_H);
+}
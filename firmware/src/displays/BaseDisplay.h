@@ -1,15 +1,84 @@
 #ifndef BASE_DISPLAY_H
 #define BASE_DISPLAY_H
 
+#include "../FixedString.h"
+#include "Panel.h"
 #include <Arduino.h>
+#include <U8g2_for_Adafruit_GFX.h>
 
-// Interface de base pour tous les displays
+// Interface de base pour tous les displays (vues)
+// A view owns its content and draws it on whichever panel it is attached
+// to, through the panel's canvas; it never touches the hardware.
 class BaseDisplay {
 public:
   virtual ~BaseDisplay() {}
-  virtual void init() = 0;
   virtual void update(bool fullRefresh = false) = 0;
-  virtual void clear() = 0;
+
+  void setPanel(Panel *panel) {
+    _panel = panel;
+    _error.clear(); // The new panel shows something else
+  }
+  bool attached() const { return _panel != nullptr; }
+  bool fastPartialRefresh() const {
+    return _panel && _panel->fastPartialRefresh();
+  }
+
+  // Coarse data age ("<15m", "45m", "3h", "2d"): it changes rarely, so
+  // showing it costs few refreshes
+  using Age = FixedString<7>;
+  static Age formatAge(unsigned long ageMs);
+
+  // Age of content that could not be revalidated ("" = fresh); views that
+  // support it draw it as a badge in the top-right corner
+  void setStaleAge(const char *age) { _staleAge = age; }
+  const Age &staleAge() const { return _staleAge; }
+
+  // The drawing entry points below are run by the RefreshScheduler;
+  // modules queue them there instead of calling them directly.
+
+  // Full-screen error with a "check WiFi / URL" hint. Repeating the error
+  // already on the panel is a no-op (returns false), so retries cost no
+  // refresh.
+  bool drawError(const char *message);
+
+  // Partial refresh of some cells (bit i = cell i); views without a cell
+  // grid redraw the whole frame
+  virtual void updateCells(uint8_t) { update(false); }
+
+  // Redraws the frame but only sends the badge corner to the panel
+  void updateBadge() {
+    _badgeOnly = true;
+    update(false);
+    _badgeOnly = false;
+  }
+
+protected:
+  Panel *_panel = nullptr;
+  Adafruit_GFX *_gfx = nullptr;
+  U8G2_FOR_ADAFRUIT_GFX _u8g2;
+
+  // Binds the canvas and the font engine for a new frame
+  bool beginFrame() {
+    if (!_panel)
+      return false;
+    _gfx = &_panel->canvas();
+    _u8g2.begin(*_gfx);
+    return true;
+  }
+
+  // Draws text in a filled box whose top-right corner is (right, top)
+  void drawBadge(int right, int top, const char *text, uint16_t fg,
+                 uint16_t bg);
+  // Stale age badge in the panel corner, drawn last over the content
+  void drawStaleBadge();
+  // Sends the frame, or only the badge corner inside updateBadge(); the
+  // error screen is gone afterwards
+  void present(bool fullRefresh);
+
+private:
+  Age _staleAge;
+  FixedString<31> _error; // Error currently on the panel ("" = none)
+  bool _badgeOnly = false;
 };
 
 #endif
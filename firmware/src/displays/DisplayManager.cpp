@@ -1,44 +1,47 @@
 #include "DisplayManager.h"
+#include "GxPanel.h"
+#include <GxEPD2_3C.h>
+#include <GxEPD2_BW.h>
 
-DisplayManager::DisplayManager(
-    GxEPD2_3C<GxEPD2_420c_GDEY042Z98, GxEPD2_420c_GDEY042Z98::HEIGHT>
-        &displayColor,
-    GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT> &displayBW1,
-    GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT> &displayBW2,
-    GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT> &displayBW3,
-    U8G2_FOR_ADAFRUIT_GFX &u8g2)
-    : _u8g2(u8g2), _ephemerisDisplay(displayColor, u8g2), // Index 0 (Color)
-      _sensorDisplay(displayBW1, u8g2),                   // Index 1 (BW)
-      _eventsDisplay(displayBW2, u8g2),                   // Index 2 (BW)
-      _sensorDisplay2(displayBW3, u8g2) {}                // Index 3 (BW)
+// The panels only use the GxEPD2 driver (frames live in the shared
+// FrameBuffer), so the GxEPD2 page buffers are kept to a few rows
+using ColorEpd = GxEPD2_3C<GxEPD2_420c_GDEY042Z98, 8>;
+using MonoEpd = GxEPD2_BW<GxEPD2_420_GDEY042T81, 8>;
 
-BaseDisplay *DisplayManager::getDisplay(int index) {
-  switch (index) {
-  case 0:
-    return &_ephemerisDisplay; // Screen 0: Ephemeris (TL)
-  case 1:
-    return &_sensorDisplay; // Screen 1: Sensors 1 (TR)
-  case 2:
-    return &_eventsDisplay; // Screen 2: Events (BL)
-  case 3:
-    return &_sensorDisplay2; // Screen 3: Sensors 2 (BR)
-  default:
-    return nullptr;
+static Panel *makePanel(const PanelSpec &spec) {
+  switch (spec.model) {
+  case PanelModel::GDEY042T81:
+    return new GxPanel<MonoEpd, PanelFormat::MONO>(spec);
+  case PanelModel::GDEY042Z98:
+    return new GxPanel<ColorEpd, PanelFormat::TRI_COLOR>(spec);
   }
+  return nullptr;
+}
+
+// Panels live as long as the firmware, they are never freed
+DisplayManager::DisplayManager() {
+  for (size_t i = 0; i < PANEL_COUNT; i++)
+    _panels[i] = makePanel(PANELS[i]);
+}
+
+Panel *DisplayManager::getPanel(int index) {
+  if (index < 0 || index >= (int)PANEL_COUNT)
+    return nullptr;
+  return _panels[index];
 }
 
 void DisplayManager::init() {
-  Serial.println("[DisplayManager] Initializing all displays...");
+  Serial.printf("[DisplayManager] Initializing %u panels...\n",
+                (unsigned)PANEL_COUNT);
 
-  _u8g2.begin(_sensorDisplay.getDisplay()); // Init common font engine
-  _ephemerisDisplay.init();
-  Serial.println("  - EphemerisDisplay initialized");
-  _sensorDisplay.init();
-  Serial.println("  - SensorDisplay 1 initialized");
-  _eventsDisplay.init();
-  Serial.println("  - EventsDisplay initialized");
-  _sensorDisplay2.init();
-  Serial.println("  - SensorDisplay 2 initialized");
+  for (size_t i = 0; i < PANEL_COUNT; i++) {
+    if (!_panels[i]) {
+      Serial.printf("  - Panel %u: unknown model\n", (unsigned)i);
+      continue;
+    }
+    _panels[i]->init();
+    Serial.printf("  - Panel %u initialized\n", (unsigned)i);
+  }
 
-  Serial.println("[DisplayManager] All displays initialized");
+  Serial.println("[DisplayManager] All panels initialized");
 }
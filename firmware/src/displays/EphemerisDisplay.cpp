@@ -1,11 +1,6 @@
 #include "EphemerisDisplay.h"
 #include <esp-iot-utils.h>
 
-EphemerisDisplay::EphemerisDisplay(
-    GxEPD2_3C<GxEPD2_420c_GDEY042Z98, GxEPD2_420c_GDEY042Z98::HEIGHT> &display,
-    U8G2_FOR_ADAFRUIT_GFX &u8g2)
-    : _display(display), _u8g2(u8g2) {}
-
 // Center text helper
 int getCenteredX(U8G2_FOR_ADAFRUIT_GFX &u8g2Fonts, const char *text, int x,
                  int w) {
@@ -13,14 +8,6 @@ int getCenteredX(U8G2_FOR_ADAFRUIT_GFX &u8g2Fonts, const char *text, int x,
   return x + (w - textWidth) / 2;
 }
 
-void EphemerisDisplay::init() {
-  _display.init();
-  _display.setRotation(1);
-  _display.setFullWindow();
-}
-
-void EphemerisDisplay::clear() { _display.clearScreen(); }
-
 void EphemerisDisplay::setData(const DateData &date, const SunData &sun,
                                const SeasonData &season) {
   _date = date;
@@ -29,68 +16,34 @@ void EphemerisDisplay::setData(const DateData &date, const SunData &sun,
 }
 
 void EphemerisDisplay::update(bool fullRefresh) {
-  _u8g2.begin(_display);
-  _display.setRotation(1);
-  if (fullRefresh) {
-    _display.setFullWindow();
-  } else {
-    _display.setPartialWindow(0, 0, _display.width(), _display.height());
-  }
+  if (!beginFrame())
+    return;
 
-  _display.firstPage();
-  do {
-    _display.fillScreen(GxEPD_WHITE);
-    drawLayout();
-    drawDate(_date);
-    drawSunInfo(_sun);
-    drawSeason(_season);
-  } while (_display.nextPage());
+  _gfx->fillScreen(GxEPD_WHITE);
+  drawLayout();
+  drawDate(_date);
+  drawSunInfo(_sun);
+  drawSeason(_season);
+  drawStaleBadge();
+
+  present(fullRefresh);
 }
 
 void EphemerisDisplay::drawLayout() {
-  int w = _display.width();
-  int h = _display.height();
+  int w = _gfx->width();
+  int h = _gfx->height();
   int margin = 10;
 
-  _display.drawRect(margin, margin, w - 2 * margin, h - 2 * margin,
-                    GxEPD_BLACK);
-  _display.drawRect(margin + 2, margin + 2, w - 2 * margin - 4,
-                    h - 2 * margin - 4, GxEPD_RED);
-}
-
-void EphemerisDisplay::drawError(const char *message) {
-  _u8g2.begin(_display);
-  _display.setRotation(1);
-  _display.setFullWindow();
-
-  _display.firstPage();
-  do {
-    _display.fillScreen(GxEPD_WHITE);
-    _u8g2.setForegroundColor(GxEPD_BLACK);
-    _u8g2.setBackgroundColor(GxEPD_WHITE);
-    _u8g2.setFont(u8g2_font_helvB14_tf);
-
-    int w = _u8g2.getUTF8Width(message);
-    int x = (_display.width() - w) / 2;
-    int y = _display.height() / 2;
-
-    _u8g2.setCursor(x, y);
-    _u8g2.print(message);
-
-    _u8g2.setFont(u8g2_font_helvR10_tf);
-    const char *sub = "Check WiFi / URL";
-    int w2 = _u8g2.getUTF8Width(sub);
-    _u8g2.setCursor((_display.width() - w2) / 2, y + 25);
-    _u8g2.print(sub);
-
-  } while (_display.nextPage());
+  _gfx->drawRect(margin, margin, w - 2 * margin, h - 2 * margin, GxEPD_BLACK);
+  _gfx->drawRect(margin + 2, margin + 2, w - 2 * margin - 4,
+                 h - 2 * margin - 4, GxEPD_RED);
 }
 
 void EphemerisDisplay::drawDate(const DateData &date) {
   int margin = 10;
-  int16_t centerX = _display.width() / 2;
+  int16_t centerX = _gfx->width() / 2;
   int marginBottom = 25;
-  int dateBottomY = _display.height() - margin - marginBottom;
+  int dateBottomY = _gfx->height() - margin - marginBottom;
 
   _u8g2.setFont(u8g2_font_helvB18_tf);
   int h_font18 = _u8g2.getFontAscent() - _u8g2.getFontDescent();
@@ -143,7 +96,7 @@ void EphemerisDisplay::drawDate(const DateData &date) {
 
 void EphemerisDisplay::drawSunInfo(const SunData &sun) {
   int margin = 10;
-  int16_t centerX = _display.width() / 2;
+  int16_t centerX = _gfx->width() / 2;
   int sunBaseY = margin + 70;
   int arcRadius = 55;
   // int sunBottomLimit = sunBaseY + 30; // Unused variable warning fix
@@ -153,22 +106,22 @@ void EphemerisDisplay::drawSunInfo(const SunData &sun) {
     float rad = angle * PI / 180.0;
     int x = centerX + arcRadius * cos(rad);
     int y = sunBaseY + arcRadius * sin(rad);
-    _display.drawPixel(x, y, GxEPD_BLACK);
-    _display.drawPixel(x, y - 1, GxEPD_BLACK);
+    _gfx->drawPixel(x, y, GxEPD_BLACK);
+    _gfx->drawPixel(x, y - 1, GxEPD_BLACK);
   }
 
   // Soleil rouge
   int sunY = sunBaseY - 25;
   int sunR = 8;
-  _display.fillCircle(centerX, sunY, sunR, GxEPD_RED);
+  _gfx->fillCircle(centerX, sunY, sunR, GxEPD_RED);
 
   // Rayons
   for (int a = 0; a < 360; a += 45) {
     float r1 = sunR + 3;
     float r2 = sunR + 7;
     float rad = a * PI / 180.0;
-    _display.drawLine(centerX + r1 * cos(rad), sunY + r1 * sin(rad),
-                      centerX + r2 * cos(rad), sunY + r2 * sin(rad), GxEPD_RED);
+    _gfx->drawLine(centerX + r1 * cos(rad), sunY + r1 * sin(rad),
+                   centerX + r2 * cos(rad), sunY + r2 * sin(rad), GxEPD_RED);
   }
 
   // Textes lever/coucher
@@ -183,8 +136,8 @@ void EphemerisDisplay::drawSunInfo(const SunData &sun) {
 
   int wSunset = _u8g2.getUTF8Width(sun.sunset.c_str());
   int xSunset = centerX + arcRadius - wSunset / 2;
-  if (xSunset + wSunset > _display.width() - margin - 5)
-    xSunset = _display.width() - margin - 5 - wSunset;
+  if (xSunset + wSunset > _gfx->width() - margin - 5)
+    xSunset = _gfx->width() - margin - 5 - wSunset;
   _u8g2.setCursor(xSunset, sunBaseY + textOffsetY);
   _u8g2.print(sun.sunset);
 
@@ -198,7 +151,7 @@ void EphemerisDisplay::drawSunInfo(const SunData &sun) {
   int barH = 24;
   int barX = centerX - barW / 2;
   int barY = sunBaseY + 5;
-  _display.fillRect(barX, barY, barW, barH, GxEPD_RED);
+  _gfx->fillRect(barX, barY, barW, barH, GxEPD_RED);
 
   _u8g2.setForegroundColor(GxEPD_WHITE);
   _u8g2.setBackgroundColor(GxEPD_RED);
@@ -211,13 +164,13 @@ void EphemerisDisplay::drawSunInfo(const SunData &sun) {
 
 void EphemerisDisplay::drawSeason(const SeasonData &season) {
   int margin = 10;
-  int16_t centerX = _display.width() / 2;
+  int16_t centerX = _gfx->width() / 2;
   int sunBaseY = margin + 70;
   int sunBottomLimit = sunBaseY + 30;
 
   // Recalculate layout metrics for season widget
   int marginBottom = 25;
-  int dateBot = _display.height() - margin - marginBottom;
+  int dateBot = _gfx->height() - margin - marginBottom;
 
   // Font heights duplicated from drawDate for calculation
   _u8g2.setFont(u8g2_font_helvB18_tf);
@@ -280,10 +233,10 @@ void EphemerisDisplay::drawSeasonCircle(int x, int y, int r, const char *label,
 
   // circle
   if (isCurrent) {
-    _display.drawCircle(x, y, r, GxEPD_RED);
-    _display.drawCircle(x, y, r - 1, GxEPD_RED); // more visible
+    _gfx->drawCircle(x, y, r, GxEPD_RED);
+    _gfx->drawCircle(x, y, r - 1, GxEPD_RED); // more visible
   } else {
-    _display.drawCircle(x, y, r, GxEPD_BLACK);
+    _gfx->drawCircle(x, y, r, GxEPD_BLACK);
   }
 
   // Value inside
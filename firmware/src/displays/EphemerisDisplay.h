@@ -3,21 +3,12 @@
 
 #include "BaseDisplay.h"
 #include <Arduino.h>
-#include <GxEPD2_3C.h>
-#include <U8g2_for_Adafruit_GFX.h>
 
 // Screen 2: Calendar + Ephemeris
 // Affiche la date, les saisons et les horaires de lever/coucher du soleil
 class EphemerisDisplay : public BaseDisplay {
 public:
-  EphemerisDisplay(GxEPD2_3C<GxEPD2_420c_GDEY042Z98,
-                             GxEPD2_420c_GDEY042Z98::HEIGHT> &display,
-                   U8G2_FOR_ADAFRUIT_GFX &u8g2);
-
-  void init() override;
   void update(bool fullRefresh = false) override;
-  void clear() override;
-  void drawError(const char *message);
 
   // Data for display
   struct DateData {
@@ -49,9 +40,6 @@ public:
                const SeasonData &season);
 
 private:
-  GxEPD2_3C<GxEPD2_420c_GDEY042Z98, GxEPD2_420c_GDEY042Z98::HEIGHT> &_display;
-  U8G2_FOR_ADAFRUIT_GFX &_u8g2;
-
   DateData _date;
   SunData _sun;
   SeasonData _season;
@@ -1,144 +1,145 @@
 #include "EventsDisplay.h"
+#include <algorithm>
 #include <esp-iot-utils.h>
 
-EventsDisplay::EventsDisplay(
-    GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT> &display,
-    U8G2_FOR_ADAFRUIT_GFX &u8g2)
-    : _display(display), _u8g2(u8g2) {}
-
-void EventsDisplay::init() {
-  _display.init(115200);
-  _display.clearScreen();
-}
-
-void EventsDisplay::clear() { _display.clearScreen(); }
-
-void EventsDisplay::drawError(const char *message) {
-  _u8g2.begin(_display);
-  _display.setRotation(1);
-  _display.setFullWindow();
-
-  _display.firstPage();
-  do {
-    _display.fillScreen(GxEPD_WHITE);
-    _u8g2.setForegroundColor(GxEPD_BLACK);
-    _u8g2.setBackgroundColor(GxEPD_WHITE);
-    _u8g2.setFont(u8g2_font_helvB14_tf);
-
-    int w = _u8g2.getUTF8Width(message);
-    int x = (_display.width() - w) / 2;
-    int y = _display.height() / 2;
-
-    _u8g2.setCursor(x, y);
-    _u8g2.print(message);
-
-    _u8g2.setFont(u8g2_font_helvR10_tf);
-    const char *sub = (TimeHelper::getLanguage() == "fr")
-                          ? "Verifier WiFi / URL"
-                          : "Check WiFi / URL";
-    int w2 = _u8g2.getUTF8Width(sub);
-    _u8g2.setCursor((_display.width() - w2) / 2, y + 25);
-    _u8g2.print(sub);
-
-  } while (_display.nextPage());
-}
-
 void EventsDisplay::setData(const TrashData &trash,
                             const std::vector<Birthday> &birthdays,
-                            int currentDay) {
+                            int currentDay, bool upcoming) {
   _trash = trash;
   _birthdays = birthdays;
   _currentDay = currentDay;
+  _upcoming = upcoming;
+}
+
+void EventsDisplay::setAgenda(const std::vector<Event> &events, bool enabled) {
+  _events = events;
+  _agenda = enabled;
 }
 
 void EventsDisplay::update(bool fullRefresh) {
-  _u8g2.begin(_display);
-  _display.setRotation(1);
-  _display.setFullWindow();
+  if (!beginFrame())
+    return;
 
   _u8g2.setFontMode(1);
   _u8g2.setForegroundColor(GxEPD_BLACK);
   _u8g2.setBackgroundColor(GxEPD_WHITE);
 
-  int fullW = _display.width();
-  int fullH = _display.height();
+  int fullW = _gfx->width();
+  int fullH = _gfx->height();
   int centerX = fullW / 2;
   int topMargin = 20;
 
-  _display.firstPage();
-  do {
-    _display.fillScreen(GxEPD_WHITE);
+  _gfx->fillScreen(GxEPD_WHITE);
 
-    // --- GLOBAL FRAME ---
-    uint16_t margin = 10;
-    for (int i = 0; i < 4; i++) {
-      _display.drawRect(margin + i, margin + i,
-                        _display.width() - 2 * (margin + i),
-                        _display.height() - 2 * (margin + i), GxEPD_BLACK);
-    }
+  // --- GLOBAL FRAME ---
+  uint16_t margin = 10;
+  for (int i = 0; i < 4; i++) {
+    _gfx->drawRect(margin + i, margin + i,
+                   _gfx->width() - 2 * (margin + i),
+                   _gfx->height() - 2 * (margin + i), GxEPD_BLACK);
+  }
 
-    // --- TRASH ---
-    int binW = 50;
-    int binH = 70;
-    int colLeftX = fullW / 3;
-    int colRightX = (fullW * 2) / 3;
-    int binY = topMargin + 45;
+  // --- TRASH ---
+  int binW = 50;
+  int binH = 70;
+  int colLeftX = fullW / 3;
+  int colRightX = (fullW * 2) / 3;
+  int binY = topMargin + 45;
 
-    // Draw bins
-    drawBin(colLeftX, binY, true, _trash.blackToday, _trash.blackDays);
-    drawBin(colRightX, binY, false, _trash.yellowToday, _trash.yellowDays);
+  // Draw bins
+  drawBin(colLeftX, binY, true, _trash.blackToday, _trash.blackDays);
+  drawBin(colRightX, binY, false, _trash.yellowToday, _trash.yellowDays);
 
-    // Title
-    _u8g2.setForegroundColor(GxEPD_BLACK);
-    _u8g2.setBackgroundColor(GxEPD_WHITE);
-    _u8g2.setFont(u8g2_font_helvB14_tf);
-    const char *title =
-        (TimeHelper::getLanguage() == "fr") ? "SORTIR LES POUBELLES" : "TRASH";
-    int wTitle = _u8g2.getUTF8Width(title);
-    _u8g2.setCursor(centerX - wTitle / 2, topMargin + 30);
-    _u8g2.print(title);
-
-    // --- BIRTHDAYS ---
-    int bdY = binY + binH + 65;
-
-    // Separator
-    _display.drawLine(margin + 20, bdY - 10, fullW - margin - 20, bdY - 10,
-                      GxEPD_BLACK);
-
-    _u8g2.setFont(u8g2_font_helvB14_tf);
-    const char *bdTitle =
-        (TimeHelper::getLanguage() == "fr") ? "ANNIVERSAIRES" : "BIRTHDAYS";
-    int wBdTitle = _u8g2.getUTF8Width(bdTitle);
-    _u8g2.setCursor(centerX - wBdTitle / 2, bdY + 10);
-    _u8g2.print(bdTitle);
-
-    _u8g2.setFont(u8g2_font_helvB14_tf);
-    const char *bdSubTitle =
-        (TimeHelper::getLanguage() == "fr") ? "DU MOIS" : "THIS MONTH";
-    int wBdSubTitle = _u8g2.getUTF8Width(bdSubTitle);
-    _u8g2.setCursor(centerX - wBdSubTitle / 2, bdY + 30);
-    _u8g2.print(bdSubTitle);
-
-    int currentY = bdY + 60;
-    _u8g2.setFont(u8g2_font_helvB12_tf);
-    int hLine = 26;
-
-    for (const auto &bd : _birthdays) {
-      if (bd.day < _currentDay)
-        continue; // Skip past birthdays
-
-      String line = String(bd.day) + " : " + bd.name;
-      int wLine = _u8g2.getUTF8Width(line.c_str());
-
-      _u8g2.setCursor(centerX - wLine / 2, currentY);
-      _u8g2.print(line);
-      currentY += hLine;
-
-      if (currentY > fullH - margin)
-        break; // Safety
+  // Title
+  _u8g2.setForegroundColor(GxEPD_BLACK);
+  _u8g2.setBackgroundColor(GxEPD_WHITE);
+  _u8g2.setFont(u8g2_font_helvB14_tf);
+  const char *title =
+      (TimeHelper::getLanguage() == "fr") ? "SORTIR LES POUBELLES" : "TRASH";
+  int wTitle = _u8g2.getUTF8Width(title);
+  _u8g2.setCursor(centerX - wTitle / 2, topMargin + 30);
+  _u8g2.print(title);
+
+  // --- BIRTHDAYS ---
+  int bdY = binY + binH + 65;
+
+  // Separator
+  _gfx->drawLine(margin + 20, bdY - 10, fullW - margin - 20, bdY - 10,
+                 GxEPD_BLACK);
+
+  _u8g2.setFont(u8g2_font_helvB14_tf);
+  bool fr = TimeHelper::getLanguage() == "fr";
+  const char *bdTitle = _agenda ? "AGENDA" : fr ? "ANNIVERSAIRES" : "BIRTHDAYS";
+  int wBdTitle = _u8g2.getUTF8Width(bdTitle);
+  _u8g2.setCursor(centerX - wBdTitle / 2, bdY + 10);
+  _u8g2.print(bdTitle);
+
+  _u8g2.setFont(u8g2_font_helvB14_tf);
+  const char *bdSubTitle = (_upcoming || _agenda)
+                               ? (fr ? "A VENIR" : "UPCOMING")
+                               : (fr ? "DU MOIS" : "THIS MONTH");
+  int wBdSubTitle = _u8g2.getUTF8Width(bdSubTitle);
+  _u8g2.setCursor(centerX - wBdSubTitle / 2, bdY + 30);
+  _u8g2.print(bdSubTitle);
+
+  int currentY = bdY + 60;
+  _u8g2.setFont(u8g2_font_helvB12_tf);
+  int hLine = 26;
+
+  // Birthdays, or in agenda mode the events and birthdays by date
+  struct Line {
+    int daysUntil;
+    int minutes;
+    FixedString<47> text;
+  };
+  std::vector<Line> lines;
+  for (const auto &bd : _birthdays) {
+    if (bd.month == 0 && bd.day < _currentDay)
+      continue; // Skip past birthdays
+
+    Line line = {bd.days_until, -1};
+    if (bd.month == 0)
+      line.text.format("%d : %s", bd.day, bd.name.c_str());
+    else if (fr)
+      line.text.format("%d/%d : %s", bd.day, bd.month, bd.name.c_str());
+    else
+      line.text.format("%d/%d : %s", bd.month, bd.day, bd.name.c_str());
+    lines.push_back(line);
+  }
+  if (_agenda) {
+    for (const auto &ev : _events) {
+      Line line = {ev.days_until, ev.minutes};
+      line.text.format("%d/%d ", fr ? ev.day : ev.month,
+                       fr ? ev.month : ev.day);
+      if (ev.minutes >= 0) {
+        FixedString<7> time;
+        time.format("%02d:%02d ", ev.minutes / 60, ev.minutes % 60);
+        line.text.append(time.c_str());
+      }
+      line.text.append(ev.title.c_str());
+      lines.push_back(line);
     }
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const Line &a, const Line &b) {
+                       return a.daysUntil != b.daysUntil
+                                  ? a.daysUntil < b.daysUntil
+                                  : a.minutes < b.minutes;
+                     });
+  }
+
+  for (const auto &line : lines) {
+    int wLine = _u8g2.getUTF8Width(line.text.c_str());
+
+    _u8g2.setCursor(centerX - wLine / 2, currentY);
+    _u8g2.print(line.text.c_str());
+    currentY += hLine;
+
+    if (currentY > fullH - margin)
+      break; // Safety
+  }
 
-  } while (_display.nextPage());
+  drawStaleBadge();
+  present(true); // Always full refresh, except the badge alone
 }
 
 void EventsDisplay::drawBin(int x, int y, bool isBlack, bool isToday,
@@ -150,14 +151,13 @@ void EventsDisplay::drawBin(int x, int y, bool isBlack, bool isToday,
 
   // 1. Shape
   if (isBlack) {
-    _display.fillRoundRect(left, top, binW, binH, 4, GxEPD_BLACK);
-    _display.fillRect(left - 3, top, binW + 6, 8, GxEPD_BLACK);
+    _gfx->fillRoundRect(left, top, binW, binH, 4, GxEPD_BLACK);
+    _gfx->fillRect(left - 3, top, binW + 6, 8, GxEPD_BLACK);
   } else {
-    _display.drawRoundRect(left, top, binW, binH, 4, GxEPD_BLACK);
-    _display.drawRoundRect(left + 1, top + 1, binW - 2, binH - 2, 2,
-                           GxEPD_BLACK);
-    _display.drawRect(left - 3, top, binW + 6, 8, GxEPD_BLACK);
-    _display.drawRect(left - 2, top + 1, binW + 4, 6, GxEPD_BLACK);
+    _gfx->drawRoundRect(left, top, binW, binH, 4, GxEPD_BLACK);
+    _gfx->drawRoundRect(left + 1, top + 1, binW - 2, binH - 2, 2, GxEPD_BLACK);
+    _gfx->drawRect(left - 3, top, binW + 6, 8, GxEPD_BLACK);
+    _gfx->drawRect(left - 2, top + 1, binW + 4, 6, GxEPD_BLACK);
   }
 
   // 2. Text
@@ -177,22 +177,26 @@ void EventsDisplay::drawBin(int x, int y, bool isBlack, bool isToday,
 
   // Number of days
   _u8g2.setFont(u8g2_font_logisoso24_tn);
-  String daysStr = (days < 0) ? "--" : String(days);
+  FixedString<11> daysStr;
+  if (days < 0)
+    daysStr = "--";
+  else
+    daysStr.format("%d", days);
   int wNum = _u8g2.getUTF8Width(daysStr.c_str());
   int hNum = _u8g2.getFontAscent();
   int numY = top + 24 + hNum;
   _u8g2.setCursor(x - wNum / 2, numY);
-  _u8g2.print(daysStr);
+  _u8g2.print(daysStr.c_str());
 
   // "DAY(S)"
   _u8g2.setFont(u8g2_font_helvB08_tf);
-  String unit;
+  const char *unit;
   if (TimeHelper::getLanguage() == "fr") {
     unit = (days <= 1 && days >= 0) ? "JOUR" : "JOURS";
   } else {
     unit = (days == 1) ? "DAY" : "DAYS";
   }
-  int wUnit = _u8g2.getUTF8Width(unit.c_str());
+  int wUnit = _u8g2.getUTF8Width(unit);
   _u8g2.setCursor(x - wUnit / 2, numY + 12);
   _u8g2.print(unit);
 
@@ -200,13 +204,13 @@ void EventsDisplay::drawBin(int x, int y, bool isBlack, bool isToday,
   _u8g2.setForegroundColor(GxEPD_BLACK);
   _u8g2.setBackgroundColor(GxEPD_WHITE);
   _u8g2.setFont(u8g2_font_helvB10_tf);
-  String label;
+  const char *label;
   if (TimeHelper::getLanguage() == "fr") {
     label = isBlack ? "NOIR" : "JAUNE";
   } else {
     label = isBlack ? "BLACK" : "YELLOW";
   }
-  int wLbl = _u8g2.getUTF8Width(label.c_str());
+  int wLbl = _u8g2.getUTF8Width(label);
   _u8g2.setCursor(x - wLbl / 2, top + binH + 20);
   _u8g2.print(label);
 }
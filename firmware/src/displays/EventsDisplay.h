@@ -1,22 +1,14 @@
 #ifndef EVENTS_DISPLAY_H
 #define EVENTS_DISPLAY_H
 
+#include "../FixedString.h"
 #include "BaseDisplay.h"
-#include <GxEPD2_BW.h>
-#include <U8g2_for_Adafruit_GFX.h>
 #include <vector>
 
 // Screen 3: Events (Trash + Birthdays)
 class EventsDisplay : public BaseDisplay {
 public:
-  EventsDisplay(
-      GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT> &display,
-      U8G2_FOR_ADAFRUIT_GFX &u8g2);
-
-  void init() override;
   void update(bool fullRefresh = false) override;
-  void clear() override;
-  void drawError(const char *message);
 
   struct TrashData {
     bool blackToday;
@@ -26,22 +18,37 @@ public:
   };
 
   struct Birthday {
-    String name;
+    FixedString<23> name;
     int day;
+    int month = 0; // 1-12, 0 = the current month (Tempus "this_month")
     int days_until;
     bool is_today;
   };
 
+  struct Event {
+    FixedString<23> title;
+    int month; // 1-12
+    int day;
+    int minutes; // Start after local midnight, -1 = all day
+    int days_until;
+  };
+
+  // upcoming: birthdays are a window of the next days rather than the
+  // current month
   void setData(const TrashData &trash, const std::vector<Birthday> &birthdays,
-               int currentDay);
+               int currentDay, bool upcoming = false);
+  // Agenda mode lists events and birthdays together by date, in place of
+  // the birthdays alone
+  void setAgenda(const std::vector<Event> &events, bool enabled);
+  bool agenda() const { return _agenda; }
 
 private:
-  GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT> &_display;
-  U8G2_FOR_ADAFRUIT_GFX &_u8g2;
-
   TrashData _trash;
   std::vector<Birthday> _birthdays;
-  int _currentDay;
+  int _currentDay = 0;
+  bool _upcoming = false;
+  std::vector<Event> _events;
+  bool _agenda = false;
 
   void drawBin(int x, int y, bool isBlack, bool isToday, int days);
 };
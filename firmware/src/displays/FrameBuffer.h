@@ -0,0 +1,103 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include "Panel.h"
+#include <algorithm>
+#include <string.h>
+
+// In-RAM frame in the controller's native layout (MSB first, 1 = white),
+// one plane per color. Views draw through Adafruit_GFX in rotated
+// coordinates; drawPixel maps them once, so pushing the frame is a plain
+// copy of the planes with no per-pixel work.
+template <PanelFormat F, uint16_t W, uint16_t H>
+class FrameBuffer : public Adafruit_GFX {
+public:
+  static const int PLANES = (F == PanelFormat::TRI_COLOR) ? 2 : 1;
+  static const uint16_t STRIDE = (W + 7) / 8;
+  static const size_t PLANE_SIZE = (size_t)STRIDE * H;
+
+  // Panels of one model render one at a time and share a single frame
+  static FrameBuffer &shared() {
+    static FrameBuffer instance;
+    return instance;
+  }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || y < 0 || x >= _width || y >= _height)
+      return;
+    toNative(x, y);
+    size_t i = (size_t)y * STRIDE + x / 8;
+    uint8_t bit = 0x80 >> (x & 7);
+
+    // Same mapping as GxEPD2_BW / GxEPD2_3C
+    bool black = color == GxEPD_BLACK;
+    bool white = color == GxEPD_WHITE;
+    if (PLANES == 1) {
+      setBit(_planes[0][i], bit, white);
+    } else {
+      setBit(_planes[0][i], bit, !black);
+      setBit(_planes[1][i], bit, white || black);
+    }
+  }
+
+  void fillScreen(uint16_t color) override {
+    if (PLANES == 1) {
+      memset(_planes[0], color == GxEPD_WHITE ? 0xFF : 0x00, PLANE_SIZE);
+    } else {
+      memset(_planes[0], color == GxEPD_BLACK ? 0x00 : 0xFF, PLANE_SIZE);
+      bool colored = color != GxEPD_BLACK && color != GxEPD_WHITE;
+      memset(_planes[1], colored ? 0x00 : 0xFF, PLANE_SIZE);
+    }
+  }
+
+  const uint8_t *plane(int index) const { return _planes[index]; }
+
+  // Canvas rectangle -> native rectangle, widened to whole bytes
+  void toNativeRect(int16_t &x, int16_t &y, int16_t &w, int16_t &h) const {
+    int16_t x0 = x, y0 = y, x1 = x + w - 1, y1 = y + h - 1;
+    toNative(x0, y0);
+    toNative(x1, y1);
+    if (x0 > x1)
+      std::swap(x0, x1);
+    if (y0 > y1)
+      std::swap(y0, y1);
+    x = x0 & ~7;
+    y = max<int16_t>(y0, 0);
+    w = min<int16_t>((x1 | 7) + 1, W) - x;
+    h = min<int16_t>(y1 + 1, H) - y;
+  }
+
+private:
+  uint8_t _planes[PLANES][PLANE_SIZE];
+
+  FrameBuffer() : Adafruit_GFX(W, H) {}
+
+  static void setBit(uint8_t &byte, uint8_t bit, bool on) {
+    if (on)
+      byte |= bit;
+    else
+      byte &= ~bit;
+  }
+
+  void toNative(int16_t &x, int16_t &y) const {
+    int16_t t;
+    switch (rotation) {
+    case 1:
+      t = x;
+      x = WIDTH - 1 - y;
+      y = t;
+      break;
+    case 2:
+      x = WIDTH - 1 - x;
+      y = HEIGHT - 1 - y;
+      break;
+    case 3:
+      t = x;
+      x = y;
+      y = HEIGHT - 1 - t;
+      break;
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef GX_PANEL_H
+#define GX_PANEL_H
+
+#include "FrameBuffer.h"
+#include "Panel.h"
+#include "PanelSpec.h"
+
+// Blit paths, one per panel format, chosen at compile time. Both push
+// whole bytes of a native frame to the controller (x and w multiples of 8);
+// a window is sent straight out of the frame planes, as GxEPD2's own
+// displayWindow() does, without copying it first.
+template <PanelFormat F> struct PanelBlit;
+
+template <> struct PanelBlit<PanelFormat::MONO> {
+  template <typename Epd, typename Frame>
+  static void full(Epd &epd, const Frame &frame) {
+    epd.writeImageForFullRefresh(frame.plane(0), 0, 0, Epd::WIDTH,
+                                 Epd::HEIGHT);
+    epd.refresh(false);
+    if (epd.hasFastPartialUpdate)
+      epd.writeImageAgain(frame.plane(0), 0, 0, Epd::WIDTH, Epd::HEIGHT);
+  }
+
+  template <typename Epd, typename Frame>
+  static void window(Epd &epd, const Frame &frame, int16_t x, int16_t y,
+                     int16_t w, int16_t h) {
+    epd.writeImagePart(frame.plane(0), x, y, Epd::WIDTH, Epd::HEIGHT, x, y,
+                       w, h);
+    epd.refresh(x, y, w, h);
+    if (epd.hasFastPartialUpdate)
+      epd.writeImagePartAgain(frame.plane(0), x, y, Epd::WIDTH, Epd::HEIGHT,
+                              x, y, w, h);
+  }
+};
+
+template <> struct PanelBlit<PanelFormat::TRI_COLOR> {
+  template <typename Epd, typename Frame>
+  static void full(Epd &epd, const Frame &frame) {
+    epd.writeImage(frame.plane(0), frame.plane(1), 0, 0, Epd::WIDTH,
+                   Epd::HEIGHT);
+    epd.refresh(false);
+  }
+
+  template <typename Epd, typename Frame>
+  static void window(Epd &epd, const Frame &frame, int16_t x, int16_t y,
+                     int16_t w, int16_t h) {
+    epd.writeImagePart(frame.plane(0), frame.plane(1), x, y, Epd::WIDTH,
+                       Epd::HEIGHT, x, y, w, h);
+    epd.refresh(x, y, w, h);
+  }
+};
+
+// Panel driven by a GxEPD2 display object (GxEPD2_BW or GxEPD2_3C), built
+// from its panel table entry. Only the driver (epd2) is used: the GxEPD2
+// page buffer can be as small as 1 row.
+template <typename GxDisplay, PanelFormat F> class GxPanel : public Panel {
+public:
+  using Epd = decltype(GxDisplay::epd2);
+  using Frame = FrameBuffer<F, Epd::WIDTH, Epd::HEIGHT>;
+
+  explicit GxPanel(const PanelSpec &spec)
+      : _display(Epd(spec.cs, spec.dc, spec.rst, spec.busy)),
+        _rotation(spec.rotation) {}
+
+  PanelFormat format() const override { return F; }
+  bool fastPartialRefresh() const override {
+    return Epd::hasFastPartialUpdate;
+  }
+
+  void init() override {
+    _display.init(115200);
+    // A 3-color clear costs a full refresh cycle; the first frame is full
+    if (F == PanelFormat::MONO)
+      _display.clearScreen();
+  }
+
+  void clear() override { _display.clearScreen(); }
+
+  Adafruit_GFX &canvas() override {
+    Frame &frame = Frame::shared();
+    frame.setRotation(_rotation);
+    return frame;
+  }
+
+  void present(bool fullRefresh, int16_t x, int16_t y, int16_t w,
+               int16_t h) override {
+    Frame &frame = Frame::shared();
+    if (fullRefresh || w <= 0) {
+      if (fullRefresh)
+        PanelBlit<F>::full(_display.epd2, frame);
+      else
+        PanelBlit<F>::window(_display.epd2, frame, 0, 0, Epd::WIDTH,
+                             Epd::HEIGHT);
+      return;
+    }
+    frame.toNativeRect(x, y, w, h);
+    PanelBlit<F>::window(_display.epd2, frame, x, y, w, h);
+  }
+
+private:
+  GxDisplay _display;
+  uint8_t _rotation;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef PANEL_H
+#define PANEL_H
+
+#include <Adafruit_GFX.h>
+#include <GxEPD2.h>
+
+// Pixel layout of a panel controller
+enum class PanelFormat : uint8_t {
+  MONO,     // 1bpp, black/white
+  TRI_COLOR // Two 1bpp planes, black + red/yellow
+};
+
+// Panel driver: owns the hardware, hands out a canvas in its rotation and
+// pushes finished frames to the controller. Content lives in the views
+// (BaseDisplay), which only ever see the Adafruit_GFX canvas.
+class Panel {
+public:
+  virtual ~Panel() {}
+
+  virtual PanelFormat format() const = 0;
+  virtual void init() = 0;
+  virtual void clear() = 0;
+
+  // Canvas for the next frame (shared between panels of the same model)
+  virtual Adafruit_GFX &canvas() = 0;
+
+  // Sends the canvas to the panel. A window (canvas coordinates, w > 0)
+  // limits a partial refresh to that area.
+  virtual void present(bool fullRefresh, int16_t x = 0, int16_t y = 0,
+                       int16_t w = 0, int16_t h = 0) = 0;
+
+  // Whether a window is sent with a fast partial refresh. Panels without
+  // one (GDEY042Z98) run a whole refresh cycle for any window.
+  virtual bool fastPartialRefresh() const { return true; }
+};
+
+#endif
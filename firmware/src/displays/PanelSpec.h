@@ -0,0 +1,22 @@
+#ifndef PANEL_SPEC_H
+#define PANEL_SPEC_H
+
+#include <stdint.h>
+
+// Supported panel models (4.2" 400x300 Good Display panels)
+enum class PanelModel : uint8_t {
+  GDEY042T81, // Black/white, fast partial refresh
+  GDEY042Z98  // Black/white/red, full refresh only
+};
+
+// One entry of the panel table in pin.h
+struct PanelSpec {
+  PanelModel model;
+  int8_t cs;
+  int8_t dc;
+  int8_t rst; // -1 = not wired
+  int8_t busy;
+  uint8_t rotation;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include "RefreshScheduler.h"
+#include "../telemetry.h"
+
+RefreshScheduler refreshScheduler;
+
+void RefreshScheduler::request(const char *owner, BaseDisplay *view,
+                               bool fullRefresh) {
+  enqueue({owner, view, nullptr, Kind::FRAME, fullRefresh, 0, ""});
+}
+
+void RefreshScheduler::requestCells(const char *owner, BaseDisplay *view,
+                                    uint8_t cells) {
+  if (cells != 0)
+    enqueue({owner, view, nullptr, Kind::CELLS, false, cells, ""});
+}
+
+void RefreshScheduler::requestBadge(const char *owner, BaseDisplay *view) {
+  if (!view->fastPartialRefresh())
+    return; // The corner alone would cost a full refresh cycle
+  enqueue({owner, view, nullptr, Kind::BADGE, false, 0, ""});
+}
+
+void RefreshScheduler::requestError(const char *owner, BaseDisplay *view,
+                                    const char *message) {
+  enqueue({owner, view, nullptr, Kind::ERROR, true, 0, message});
+}
+
+void RefreshScheduler::requestClear(const char *owner, Panel *panel) {
+  enqueue({owner, nullptr, panel, Kind::CLEAR, true, 0, ""});
+}
+
+void RefreshScheduler::enqueue(const Job &job) {
+  for (Job &queued : _queue) {
+    bool same = job.view ? queued.view == job.view
+                         : !queued.view && queued.panel == job.panel;
+    if (same) {
+      merge(queued, job);
+      return;
+    }
+  }
+  _queue.push_back(job);
+}
+
+void RefreshScheduler::merge(Job &queued, const Job &next) {
+  if (queued.kind == next.kind) {
+    queued.fullRefresh |= next.fullRefresh;
+    queued.cells |= next.cells;
+    queued.message = next.message;
+  } else if (next.kind == Kind::ERROR) {
+    queued.kind = Kind::ERROR;
+    queued.fullRefresh = true;
+    queued.message = next.message;
+  } else {
+    // Content after an error, or two partial kinds: one frame covers both
+    bool full = (queued.kind == Kind::FRAME && queued.fullRefresh) ||
+                next.fullRefresh;
+    queued.kind = Kind::FRAME;
+    queued.fullRefresh = full;
+  }
+}
+
+bool RefreshScheduler::run(const Job &job, bool &fullRefresh) {
+  fullRefresh = job.fullRefresh;
+  switch (job.kind) {
+  case Kind::FRAME:
+    job.view->update(job.fullRefresh);
+    return true;
+  case Kind::CELLS:
+    job.view->updateCells(job.cells);
+    return true;
+  case Kind::BADGE:
+    job.view->updateBadge();
+    return true;
+  case Kind::ERROR:
+    return job.view->drawError(job.message.c_str());
+  case Kind::CLEAR:
+    job.panel->clear();
+    return true;
+  }
+  return false;
+}
+
+void RefreshScheduler::loop() {
+  if (_queue.empty() || millis() - _lastEnd < _gap)
+    return;
+
+  Job job = _queue.front();
+  _queue.erase(_queue.begin());
+  if (job.view && !job.view->attached())
+    return; // Screen taken away while queued
+
+  unsigned long start = millis();
+  bool fullRefresh;
+  if (!run(job, fullRefresh))
+    return;
+  _lastEnd = millis();
+  _gap = fullRefresh ? FULL_GAP_MS : PARTIAL_GAP_MS;
+  telemetry.publishRefresh(job.owner, fullRefresh, _lastEnd - start);
+}
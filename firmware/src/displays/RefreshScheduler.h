@@ -0,0 +1,70 @@
+#ifndef REFRESH_SCHEDULER_H
+#define REFRESH_SCHEDULER_H
+
+#include "../FixedString.h"
+#include "BaseDisplay.h"
+#include <Arduino.h>
+#include <vector>
+
+// Serializes panel refreshes. Modules queue a view instead of refreshing
+// it inline; loop() starts at most one refresh per pass and waits a gap
+// after it, so panels sharing the SPI bus and the supply never refresh
+// back to back in one burst (peak current stays at one panel, and BLE gets
+// loop time between them). Every panel write goes through here: frames,
+// cell and badge updates, error screens and clears.
+class RefreshScheduler {
+public:
+  // Pause after a refresh before the next panel may start
+  static const uint32_t FULL_GAP_MS = 1500;
+  static const uint32_t PARTIAL_GAP_MS = 200;
+
+  enum class Kind : uint8_t {
+    FRAME, // Whole view, full or partial
+    CELLS, // Some cells of the view, partial
+    BADGE, // Stale badge corner only, partial (fast partial panels only)
+    ERROR, // Error screen, full
+    CLEAR  // Blank panel with no view on it, full
+  };
+
+  // A view already queued keeps its place and its jobs merge: full wins
+  // over partial, masks add up, mixed partial kinds redraw the frame and
+  // the newest of an error and content wins. owner is kept as a pointer
+  // and must outlive the job (a module name).
+  void request(const char *owner, BaseDisplay *view, bool fullRefresh);
+  void requestCells(const char *owner, BaseDisplay *view, uint8_t cells);
+  // Dropped on panels without a fast partial refresh: the age is already
+  // set on the view and shows with its next frame
+  void requestBadge(const char *owner, BaseDisplay *view);
+  void requestError(const char *owner, BaseDisplay *view,
+                    const char *message);
+  void requestClear(const char *owner, Panel *panel);
+
+  // Called from the main loop
+  void loop();
+
+  size_t pending() const { return _queue.size(); }
+
+private:
+  struct Job {
+    const char *owner;
+    BaseDisplay *view; // nullptr for CLEAR
+    Panel *panel;      // CLEAR only
+    Kind kind;
+    bool fullRefresh;
+    uint8_t cells;           // CELLS: bit i = cell i
+    FixedString<31> message; // ERROR
+  };
+
+  std::vector<Job> _queue; // FIFO, at most one job per view or panel
+  unsigned long _lastEnd = 0;
+  uint32_t _gap = 0;
+
+  void enqueue(const Job &job);
+  static void merge(Job &queued, const Job &next);
+  // Whether the job touched the panel (an error already shown does not)
+  static bool run(const Job &job, bool &fullRefresh);
+};
+
+extern RefreshScheduler refreshScheduler;
+
+#endif
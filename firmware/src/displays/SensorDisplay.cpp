@@ -1,51 +1,42 @@
 #include "SensorDisplay.h"
 
-SensorDisplay::SensorDisplay(
-    GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT> &display,
-    U8G2_FOR_ADAFRUIT_GFX &u8g2)
-    : _display(display), _u8g2(u8g2) {
+SensorDisplay::SensorDisplay() {
   for (int i = 0; i < 8; i++) {
-    _data[i] = {"", "--", ""};
+    _data[i].value = "--";
   }
 }
 
-void SensorDisplay::init() {
-  _display.init(115200);
-  _display.clearScreen();
+void SensorDisplay::setCell(int index, const char *label, const char *value,
+                            const char *unit) {
+  if (index < 0 || index >= 8)
+    return;
+  _data[index].label = label;
+  _data[index].value = value;
+  _data[index].unit = unit;
 }
 
-void SensorDisplay::clear() { _display.clearScreen(); }
-
-void SensorDisplay::setData(SensorData row1_col1, SensorData row1_col2,
-                            SensorData row2_col1, SensorData row2_col2,
-                            SensorData row3_col1, SensorData row3_col2,
-                            SensorData row4_col1, SensorData row4_col2) {
-  _data[0] = row1_col1;
-  _data[1] = row1_col2;
-  _data[2] = row2_col1;
-  _data[3] = row2_col2;
-  _data[4] = row3_col1;
-  _data[5] = row3_col2;
-  _data[6] = row4_col1;
-  _data[7] = row4_col2;
+void SensorDisplay::setSparkline(int index, int historySlot) {
+  if (index < 0 || index >= 8)
+    return;
+  _data[index].historySlot = historySlot;
 }
 
-void SensorDisplay::update(bool fullRefresh) {
-  _u8g2.begin(_display);
-  _display.setRotation(1);
+void SensorDisplay::setCellStaleAge(int index, const char *age) {
+  if (index < 0 || index >= 8)
+    return;
+  _data[index].staleAge = age;
+}
 
-  if (fullRefresh) {
-    _display.setFullWindow();
-  } else {
-    _display.setPartialWindow(0, 0, _display.width(), _display.height());
-  }
+void SensorDisplay::update(bool fullRefresh) {
+  if (!beginFrame())
+    return;
 
   _u8g2.setFontMode(1);
   _u8g2.setForegroundColor(GxEPD_BLACK);
   _u8g2.setBackgroundColor(GxEPD_WHITE);
 
-  int fullW = _display.width();
-  int fullH = _display.height();
+  int fullW = _gfx->width();
+  int fullH = _gfx->height();
   int margin = 10;
 
   int contentX = margin + 4;
@@ -57,75 +48,109 @@ void SensorDisplay::update(bool fullRefresh) {
   int colWidth = contentW / 2;
 
   if (_style == 1) {
-    drawCircles();
+    drawCircles(fullRefresh);
     return;
   }
 
-  _display.firstPage();
-  do {
-    // global background
-    _display.fillScreen(GxEPD_WHITE);
+  // global background
+  _gfx->fillScreen(GxEPD_WHITE);
 
-    for (int i = 0; i < 4; i++) {
-      _display.drawRect(margin + i, margin + i, fullW - 2 * (margin + i),
-                        fullH - 2 * (margin + i), GxEPD_BLACK);
-    }
+  for (int i = 0; i < 4; i++) {
+    _gfx->drawRect(margin + i, margin + i, fullW - 2 * (margin + i),
+                   fullH - 2 * (margin + i), GxEPD_BLACK);
+  }
 
-    // Draw 8 cells (4 rows x 2 columns)
-    drawCell(0, 0, _data[0].label, _data[0].value, _data[0].unit, false);
-    drawCell(1, 0, _data[1].label, _data[1].value, _data[1].unit, false);
+  // Draw 8 cells (4 rows x 2 columns)
+  drawCell(0, 0, _data[0], false);
+  drawCell(1, 0, _data[1], false);
 
-    drawCell(0, 1, _data[2].label, _data[2].value, _data[2].unit, false);
-    drawCell(1, 1, _data[3].label, _data[3].value, _data[3].unit, false);
+  drawCell(0, 1, _data[2], false);
+  drawCell(1, 1, _data[3], false);
 
-    drawCell(0, 2, _data[4].label, _data[4].value, _data[4].unit, true);
-    drawCell(1, 2, _data[5].label, _data[5].value, _data[5].unit, true);
+  drawCell(0, 2, _data[4], true);
+  drawCell(1, 2, _data[5], true);
 
-    drawCell(0, 3, _data[6].label, _data[6].value, _data[6].unit, true);
-    drawCell(1, 3, _data[7].label, _data[7].value, _data[7].unit, true);
+  drawCell(0, 3, _data[6], true);
+  drawCell(1, 3, _data[7], true);
 
-    // Draw Last Update Timestamp
-    if (!_lastUpdateTime.isEmpty()) {
-      _u8g2.setFont(u8g2_font_helvB10_tf);
-      String msg = "MAJ: " + _lastUpdateTime;
-      int bW = _u8g2.getUTF8Width(msg.c_str());
-      int x = (fullW - bW) / 2;
-      int y = fullH - 8;
+  // Draw Last Update Timestamp
+  if (!_lastUpdateTime.isEmpty()) {
+    _u8g2.setFont(u8g2_font_helvB10_tf);
+    FixedString<16> msg;
+    msg.format("MAJ: %s", _lastUpdateTime.c_str());
+    int bW = _u8g2.getUTF8Width(msg.c_str());
+    int x = (fullW - bW) / 2;
+    int y = fullH - 8;
 
-      // Draw white background for the text
-      _display.fillRect(x - 4, y - 12, bW + 8, 15, GxEPD_WHITE);
-      _display.drawRect(x - 4, y - 12, bW + 8, 15, GxEPD_BLACK);
+    // Draw white background for the text
+    _gfx->fillRect(x - 4, y - 12, bW + 8, 15, GxEPD_WHITE);
+    _gfx->drawRect(x - 4, y - 12, bW + 8, 15, GxEPD_BLACK);
 
-      _u8g2.setForegroundColor(GxEPD_BLACK);
-      _u8g2.setBackgroundColor(GxEPD_WHITE);
-      _u8g2.setCursor(x, y);
-      _u8g2.print(msg);
-    }
-  } while (_display.nextPage());
+    _u8g2.setForegroundColor(GxEPD_BLACK);
+    _u8g2.setBackgroundColor(GxEPD_WHITE);
+    _u8g2.setCursor(x, y);
+    _u8g2.print(msg.c_str());
+  }
+
+  _panel->present(fullRefresh, _windowX, _windowY, _windowW, _windowH);
+}
+
+void SensorDisplay::updateCells(uint8_t cells) {
+  if (cells == 0)
+    return;
+  if (_style == 1) {
+    update(false);
+    return;
+  }
+
+  // Bounding box of the dirty cells, only that window is sent to the panel
+  if (!beginFrame())
+    return;
+  int x0 = _gfx->width(), y0 = _gfx->height(), x1 = 0, y1 = 0;
+  for (int i = 0; i < 8; i++) {
+    if (!(cells & (1 << i)))
+      continue;
+    int x, y, w, h;
+    cellRect(i % 2, i / 2, x, y, w, h);
+    x0 = min(x0, x);
+    y0 = min(y0, y);
+    x1 = max(x1, x + w);
+    y1 = max(y1, y + h);
+  }
+
+  _windowX = x0;
+  _windowY = y0;
+  _windowW = x1 - x0;
+  _windowH = y1 - y0;
+  update(false);
+  _windowW = _windowH = 0;
 }
 
-void SensorDisplay::drawCell(int col, int row, String label, String val,
-                             String unit, bool inverted) {
-  int fullW = _display.width();
-  int fullH = _display.height();
+void SensorDisplay::cellRect(int col, int row, int &x, int &y, int &w,
+                             int &h) {
   int margin = 10;
   int contentX = margin + 4;
   int contentY = margin + 4;
-  int contentW = fullW - 2 * contentX;
-  int contentH = fullH - 2 * contentY;
-  int rowH = contentH / 4;
-  int colW = contentW / 2;
+  int contentW = _gfx->width() - 2 * contentX;
+  int contentH = _gfx->height() - 2 * contentY;
+  w = contentW / 2;
+  h = contentH / 4;
+  x = contentX + col * w;
+  y = contentY + row * h;
+}
 
-  int absX = contentX + col * colW;
-  int absY = contentY + row * rowH;
+void SensorDisplay::drawCell(int col, int row, const SensorData &data,
+                             bool inverted) {
+  int absX, absY, colW, rowH;
+  cellRect(col, row, absX, absY, colW, rowH);
 
   // background
   if (inverted) {
-    _display.fillRect(absX, absY, colW, rowH, GxEPD_BLACK);
+    _gfx->fillRect(absX, absY, colW, rowH, GxEPD_BLACK);
     _u8g2.setForegroundColor(GxEPD_WHITE);
     _u8g2.setBackgroundColor(GxEPD_BLACK);
   } else {
-    _display.fillRect(absX, absY, colW, rowH, GxEPD_WHITE);
+    _gfx->fillRect(absX, absY, colW, rowH, GxEPD_WHITE);
     _u8g2.setForegroundColor(GxEPD_BLACK);
     _u8g2.setBackgroundColor(GxEPD_WHITE);
   }
@@ -135,69 +160,122 @@ void SensorDisplay::drawCell(int col, int row, String label, String val,
   // Label
   _u8g2.setFont(u8g2_font_helvR10_tf);
   _u8g2.setCursor(absX + leftMargin, absY + 20);
-  _u8g2.print(label);
+  _u8g2.print(data.label.c_str());
 
   // value
   _u8g2.setFont(u8g2_font_logisoso28_tn);
   int valH = _u8g2.getFontAscent();
   _u8g2.setCursor(absX + leftMargin, absY + 35 + valH);
-  _u8g2.print(val);
+  _u8g2.print(data.value.c_str());
 
   // unit
-  int valW = _u8g2.getUTF8Width(val.c_str());
+  int valW = _u8g2.getUTF8Width(data.value.c_str());
   _u8g2.setFont(u8g2_font_helvR10_tf);
   _u8g2.setCursor(absX + leftMargin + valW + 4, absY + 35 + valH);
-  _u8g2.print(unit);
+  _u8g2.print(data.unit.c_str());
+
+  // stale marker, top-right corner
+  if (!data.staleAge.isEmpty())
+    drawBadge(absX + colW - 4, absY + 4, data.staleAge.c_str(),
+              inverted ? GxEPD_WHITE : GxEPD_BLACK,
+              inverted ? GxEPD_BLACK : GxEPD_WHITE);
+
+  // sparkline, in whatever width the value and unit leave free
+  if (data.historySlot >= 0) {
+    int unitW = _u8g2.getUTF8Width(data.unit.c_str());
+    int sparkX = absX + leftMargin + valW + 4 + unitW + 8;
+    int sparkW = absX + colW - 8 - sparkX;
+    drawSparkline(data.historySlot, sparkX, absY + 26, sparkW, valH + 9,
+                  inverted ? GxEPD_WHITE : GxEPD_BLACK);
+  }
 }
 
-void SensorDisplay::drawCircles() {
-  _display.setRotation(
-      1); // Keep rotation setting but adapt to reported dimensions
-  _display.firstPage();
-  do {
-    _display.fillScreen(GxEPD_WHITE);
-
-    int colW = 150; // 300 / 2
-    int rowH = 133; // 400 / 3
+// Min/max downsampling: one vertical segment per pixel column, so the cost
+// follows the sparkline width whatever the history depth
+void SensorDisplay::drawSparkline(int slot, int x, int y, int w, int h,
+                                  uint16_t color) {
+  static const int MIN_WIDTH = 16;
+  static const int MAX_WIDTH = 96;
+  if (w < MIN_WIDTH || h < 4)
+    return;
+  w = min(w, MAX_WIDTH);
 
-    _u8g2.setFontMode(1);
-    _u8g2.setForegroundColor(GxEPD_BLACK);
-    _u8g2.setBackgroundColor(GxEPD_WHITE);
+  int16_t lo[MAX_WIDTH], hi[MAX_WIDTH];
+  int columns = sensorHistory.downsample(slot, w, lo, hi);
+  if (columns < 2)
+    return;
 
-    for (int i = 0; i < 6; i++) {
-      int row = i / 2;
-      int col = i % 2;
-
-      // Cell Center
-      int cx = col * colW + colW / 2;
-      int cy = row * rowH + rowH / 2;
-
-      // Radius 60 fits 150px cell.
-      // 1. Outer Thick Ring (Radius 60)
-      _display.drawCircle(cx, cy, 60, GxEPD_BLACK);
-      _display.drawCircle(cx, cy, 59, GxEPD_BLACK);
-
-      // 2. Inner Thin Ring (Radius 55) - Creates a 4px "gap"
-      _display.drawCircle(cx, cy, 55, GxEPD_BLACK);
-
-      // 1. Label (Top) - Reduced to B08
-      _u8g2.setFont(u8g2_font_helvB08_tf);
-      int wLabel = _u8g2.getUTF8Width(_data[i].label.c_str());
-      _u8g2.setCursor(cx - wLabel / 2, cy - 22);
-      _u8g2.print(_data[i].label);
-
-      // 2. Value (Middle) - Keep Large
-      _u8g2.setFont(u8g2_font_helvB24_tf);
-      int wValue = _u8g2.getUTF8Width(_data[i].value.c_str());
-      int hValue = _u8g2.getFontAscent(); // ~24
-      _u8g2.setCursor(cx - wValue / 2, cy + 10);
-      _u8g2.print(_data[i].value);
-
-      // 3. Unit (Bottom) - Reduced to R08
-      _u8g2.setFont(u8g2_font_helvR08_tf);
-      int wUnit = _u8g2.getUTF8Width(_data[i].unit.c_str());
-      _u8g2.setCursor(cx - wUnit / 2, cy + 32);
-      _u8g2.print(_data[i].unit);
+  int16_t minD = lo[0], maxD = hi[0];
+  for (int c = 1; c < columns; c++) {
+    minD = min(minD, lo[c]);
+    maxD = max(maxD, hi[c]);
+  }
+  long range = max<long>((long)maxD - minD, 1);
+  int bottom = y + h - 1;
+  auto toY = [&](int16_t d) {
+    return maxD == minD ? y + h / 2
+                        : bottom - (int)(((long)d - minD) * (h - 1) / range);
+  };
+
+  // Newest sample on the right edge; each segment also reaches the
+  // previous column so the line stays connected
+  int left = x + w - columns;
+  for (int c = 0; c < columns; c++) {
+    int16_t segLo = lo[c], segHi = hi[c];
+    if (c > 0) {
+      segLo = min(segLo, hi[c - 1]);
+      segHi = max(segHi, lo[c - 1]);
     }
-  } while (_display.nextPage());
+    int top = toY(segHi);
+    _gfx->drawFastVLine(left + c, top, toY(segLo) - top + 1, color);
+  }
+}
+
+void SensorDisplay::drawCircles(bool fullRefresh) {
+  _gfx->fillScreen(GxEPD_WHITE);
+
+  int colW = 150; // 300 / 2
+  int rowH = 133; // 400 / 3
+
+  _u8g2.setFontMode(1);
+  _u8g2.setForegroundColor(GxEPD_BLACK);
+  _u8g2.setBackgroundColor(GxEPD_WHITE);
+
+  for (int i = 0; i < 6; i++) {
+    int row = i / 2;
+    int col = i % 2;
+
+    // Cell Center
+    int cx = col * colW + colW / 2;
+    int cy = row * rowH + rowH / 2;
+
+    // Radius 60 fits 150px cell.
+    // 1. Outer Thick Ring (Radius 60)
+    _gfx->drawCircle(cx, cy, 60, GxEPD_BLACK);
+    _gfx->drawCircle(cx, cy, 59, GxEPD_BLACK);
+
+    // 2. Inner Thin Ring (Radius 55) - Creates a 4px "gap"
+    _gfx->drawCircle(cx, cy, 55, GxEPD_BLACK);
+
+    // 1. Label (Top) - Reduced to B08
+    _u8g2.setFont(u8g2_font_helvB08_tf);
+    int wLabel = _u8g2.getUTF8Width(_data[i].label.c_str());
+    _u8g2.setCursor(cx - wLabel / 2, cy - 22);
+    _u8g2.print(_data[i].label.c_str());
+
+    // 2. Value (Middle) - Keep Large
+    _u8g2.setFont(u8g2_font_helvB24_tf);
+    int wValue = _u8g2.getUTF8Width(_data[i].value.c_str());
+    int hValue = _u8g2.getFontAscent(); // ~24
+    _u8g2.setCursor(cx - wValue / 2, cy + 10);
+    _u8g2.print(_data[i].value.c_str());
+
+    // 3. Unit (Bottom) - Reduced to R08
+    _u8g2.setFont(u8g2_font_helvR08_tf);
+    int wUnit = _u8g2.getUTF8Width(_data[i].unit.c_str());
+    _u8g2.setCursor(cx - wUnit / 2, cy + 32);
+    _u8g2.print(_data[i].unit.c_str());
+  }
+
+  _panel->present(fullRefresh);
 }
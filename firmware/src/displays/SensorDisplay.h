@@ -1,51 +1,56 @@
 #ifndef SENSOR_DISPLAY_H
 #define SENSOR_DISPLAY_H
 
+#include "../FixedString.h"
+#include "../SensorHistory.h"
 #include "BaseDisplay.h"
-#include <GxEPD2_BW.h>
-#include <U8g2_for_Adafruit_GFX.h>
 
 // Screen 1: Sensors + EDF Consumption
 class SensorDisplay : public BaseDisplay {
 public:
-  SensorDisplay(
-      GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT> &display,
-      U8G2_FOR_ADAFRUIT_GFX &u8g2);
+  SensorDisplay();
 
-  void init() override;
   void update(bool fullRefresh = false) override;
-  void clear() override;
+  // Partial refresh limited to the given cells (bit i = cell i); the circle
+  // style has no fixed cell grid and refreshes the whole panel instead
+  void updateCells(uint8_t cells) override;
+
+  // Cell text, stored inline (no heap); longer input is truncated
+  using Label = FixedString<31>;
+  using Value = FixedString<15>;
+  using Unit = FixedString<11>;
 
-  // Structure for sensor data
   struct SensorData {
-    String label;
-    String value;
-    String unit;
+    Label label;
+    Value value;
+    Unit unit;
+    int8_t historySlot = -1; // sensorHistory slot drawn as sparkline, -1 = off
+    Age staleAge;            // Shown in the cell corner while not refreshing
   };
 
-  void setData(SensorData row1_col1, SensorData row1_col2, SensorData row2_col1,
-               SensorData row2_col2, SensorData row3_col1, SensorData row3_col2,
-               SensorData row4_col1, SensorData row4_col2);
-
-  GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT> &
-  getDisplay() {
-    return _display;
-  }
+  // Cells are numbered row by row: 0 = row 1 col 1, 1 = row 1 col 2, ...
+  void setCell(int index, const char *label, const char *value,
+               const char *unit);
+  // Sparkline of sensorHistory's slot next to the value (-1 = none); only
+  // drawn in the grid style, where the value leaves room for it
+  void setSparkline(int index, int historySlot);
+  // Age of a value the slot failed to refresh ("" = fresh)
+  void setCellStaleAge(int index, const char *age);
 
   void setStyle(int style) { _style = style; }
-  void setLastUpdate(const String &time) { _lastUpdateTime = time; }
+  void setLastUpdate(const char *time) { _lastUpdateTime = time; }
 
 private:
-  GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT> &_display;
-  U8G2_FOR_ADAFRUIT_GFX &_u8g2;
-
   SensorData _data[8];
   int _style = 0;
-  String _lastUpdateTime = "";
+  FixedString<5> _lastUpdateTime; // "HH:MM"
+  int _windowX = 0, _windowY = 0, _windowW = 0, _windowH = 0; // 0 = panel
+
+  void cellRect(int col, int row, int &x, int &y, int &w, int &h);
 
-  void drawCell(int col, int row, String label, String val, String unit,
-                bool inverted);
-  void drawCircles();
+  void drawCell(int col, int row, const SensorData &data, bool inverted);
+  void drawSparkline(int slot, int x, int y, int w, int h, uint16_t color);
+  void drawCircles(bool fullRefresh);
 };
 
 #endif
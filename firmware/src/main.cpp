@@ -4,10 +4,12 @@
 #include <GxEPD2_3C.h>
 #include <GxEPD2_BW.h>
 #include <SPI.h>
-#include <U8g2_for_Adafruit_GFX.h>
 
 #include "ble.h"
+#include "config/ConfigStore.h"
 #include "displays/DisplayManager.h"
+#include "network/NetworkWindow.h"
+#include "SensorHistory.h"
 #include "pin.h"
 #include <esp-iot-utils.h>
 
@@ -18,30 +20,15 @@
 #include "modules/SensorModule.h"
 
 // --- Global Objects ---
-U8G2_FOR_ADAFRUIT_GFX u8g2Fonts;
 ConfigHelper config;
-Ble ble(config);
-
-// --- Display Hardware Instances ---
-// Screen 1 (Top Right) - BW
-GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT>
-    display1(GxEPD2_420_GDEY042T81(CS_PIN_1, DC_PIN_1, RES_PIN_1, BUSY_PIN_1));
-
-// Screen 0 (Top Left) - Color
-GxEPD2_3C<GxEPD2_420c_GDEY042Z98, GxEPD2_420c_GDEY042Z98::HEIGHT>
-    display2(GxEPD2_420c_GDEY042Z98(CS_PIN_2, DC_PIN_2, RES_PIN_2, BUSY_PIN_2));
-
-GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT>
-    display3(GxEPD2_420_GDEY042T81(CS_PIN_3, DC_PIN_3, RES_PIN_3, BUSY_PIN_3));
-GxEPD2_BW<GxEPD2_420_GDEY042T81, GxEPD2_420_GDEY042T81::HEIGHT>
-    display4(GxEPD2_420_GDEY042T81(CS_PIN_4, DC_PIN_4, RES_PIN_4, BUSY_PIN_4));
+ConfigStore configStore(config);
+Ble ble(configStore);
 
 // Display Manager
-DisplayManager displayManager(display2, display1, display3, display4,
-                              u8g2Fonts);
+DisplayManager displayManager;
 
 // Module Manager
-ModuleManager moduleManager(displayManager, config);
+ModuleManager moduleManager(displayManager, configStore);
 
 // Modules
 EphemerisModule ephemerisModule;
@@ -49,9 +36,6 @@ EventsModule eventsModule;
 SensorModule sensorModule1("Sensors", 0);
 SensorModule sensorModule2("Sensors", 8);
 
-// Global flag shared with BleConfig
-volatile bool shouldUpdateSensors = false;
-
 // BLE Timeout tracking
 unsigned long lastBleActivity = 0;
 bool bleActive = true;
@@ -64,30 +48,24 @@ void setup() {
   SPI.begin(SPI_SCK, -1, SPI_MOSI);
 
   // Set display pins as outputs/inputs
-  pinMode(CS_PIN_1, OUTPUT);
-  pinMode(DC_PIN_1, OUTPUT);
-  pinMode(RES_PIN_1, OUTPUT);
-  pinMode(BUSY_PIN_1, INPUT);
-  pinMode(CS_PIN_2, OUTPUT);
-  pinMode(DC_PIN_2, OUTPUT);
-  pinMode(RES_PIN_2, OUTPUT);
-  pinMode(BUSY_PIN_2, INPUT);
-  pinMode(CS_PIN_3, OUTPUT);
-  pinMode(DC_PIN_3, OUTPUT);
-  pinMode(RES_PIN_3, OUTPUT);
-  pinMode(BUSY_PIN_3, INPUT);
-  pinMode(CS_PIN_4, OUTPUT);
-  pinMode(DC_PIN_4, OUTPUT);
-  pinMode(RES_PIN_4, OUTPUT);
-  pinMode(BUSY_PIN_4, INPUT);
+  for (const PanelSpec &spec : PANELS) {
+    pinMode(spec.cs, OUTPUT);
+    pinMode(spec.dc, OUTPUT);
+    if (spec.rst >= 0)
+      pinMode(spec.rst, OUTPUT);
+    pinMode(spec.busy, INPUT);
+  }
 
   config.begin();
   Serial.println("NVS Initialized");
 
+  // Load the typed configuration snapshot once, hot paths never touch NVS
+  configStore.load();
+  const SystemConfig &sys = configStore.current().system;
+
   // Load language preference
-  String lang = config.get("language", String("en"));
-  TimeHelper::setLanguage(lang);
-  Serial.println("Language loaded: " + lang);
+  TimeHelper::setLanguage(sys.language);
+  Serial.println("Language loaded: " + sys.language);
 
   // 2. Display Init
   displayManager.init();
@@ -97,19 +75,17 @@ void setup() {
   Serial.println("[Main] BLE Started");
 
   // 4. Network Init
-  bool wifiConnected = WiFiHelper::connect(
-      config.get("ssid", String("")), config.get("password", String("")),
-      config.get("dns_mode", String("auto")),
-      config.get("dns_pri", String("8.8.8.8")),
-      config.get("dns_sec", String("1.1.1.1")));
+  bool wifiConnected =
+      WiFiHelper::connect(sys.ssid, sys.password, sys.dnsMode, sys.dnsPrimary,
+                          sys.dnsSecondary);
 
   if (wifiConnected) {
     Serial.println("[Main] WiFi Connected: " + WiFiHelper::getIP());
 
     // 4.1 Time Init (Perform AFTER WiFi is connected)
-    String ntpServer = config.get("ntp_srv", String("pool.ntp.org"));
-    long gmtOffset = config.get("ntp_gmt", 3600L);
-    int daylightOffset = config.get("ntp_dst", 3600);
+    String ntpServer = sys.ntpServer;
+    long gmtOffset = sys.gmtOffset;
+    int daylightOffset = sys.dstOffset;
 
     Serial.println("[Main] Initializing NTP: " + ntpServer);
     TimeHelper::init(ntpServer.c_str(), gmtOffset, daylightOffset);
@@ -139,9 +115,11 @@ void setup() {
     Serial.println("[Main] Offline Mode");
   }
 
+  // Fetches are grouped into network bursts from here on
+  networkWindow.begin(configStore, wifiConnected);
+
   // 5. Config Tempus
-  String tempusUrl = config.get("tempus_url", String(""));
-  if (tempusUrl.isEmpty()) {
+  if (sys.tempusUrl.isEmpty()) {
     Serial.println("[Main] Warning: Tempus URL not set!");
   } else {
     Serial.println("[Main] Tempus URL OK");
@@ -153,39 +131,40 @@ void setup() {
   moduleManager.registerModule(&eventsModule);
   moduleManager.registerModule(&sensorModule2);
 
-  // 7. Apply System Configuration (before begin)
-  int sensorInterval = config.get("sensorInterval", 60);
-  if (sensorInterval < 10)
-    sensorInterval = 10;
-  sensorModule1.setRefreshInterval(sensorInterval * 1000);
-  sensorModule2.setRefreshInterval(sensorInterval * 1000);
-
-  // 8. Start Modules (ModuleManager handles screen assignment and begin)
+  // 7. Start Modules (ModuleManager handles screen assignment and begin)
   Serial.println("[Main] Starting Modules...");
+  fetchWorker.begin();
   moduleManager.begin();
 
-  // 9. Initialize BLE timeout timer AFTER boot completes
+  // 8. Initialize BLE timeout timer AFTER boot completes
   lastBleActivity = millis();
-  int bleTimeoutMin = config.get("ble_timeout", 15);
-  Serial.println("[Main] BLE timeout: " + String(bleTimeoutMin) + "min");
+  Serial.println("[Main] BLE timeout: " + String(sys.bleTimeout) + "min");
   Serial.println("[Main] === BOOT COMPLETE ===");
 }
 
 void loop() {
-  // Check for BLE configuration changes
-  if (shouldUpdateSensors) {
-    Serial.println("[Main] Configuration changed - forcing updates");
-    moduleManager.forceUpdate();
-    shouldUpdateSensors = false;
+  // No configuration reference survives a pass; the BLE task may now
+  // reuse the previous snapshot's buffer
+  configStore.quiesce();
+
+  // Check for BLE configuration changes, redo only what they invalidate
+  ConfigChange change = configStore.takeChanges();
+  if (!change.empty()) {
+    Serial.println("[Main] Configuration changed - applying");
+    if (change.language)
+      TimeHelper::setLanguage(configStore.current().system.language);
+    moduleManager.applyChange(change);
     lastBleActivity = millis(); // Reset timeout on activity
   }
 
   // BLE Timeout Logic
   if (bleActive) {
+    ble.loop();
     if (ble.isConnected()) {
       lastBleActivity = millis(); // Keep alive while connected
     } else {
-      int timeoutMinutes = config.get("ble_timeout", 15);
+      telemetry.unsubscribe(); // Stream ends with the connection
+      int timeoutMinutes = configStore.current().system.bleTimeout;
       if (timeoutMinutes > 0 && (millis() - lastBleActivity >
                                  (unsigned long)timeoutMinutes * 60 * 1000)) {
         Serial.println("[Main] BLE Timeout - Stopping BLE");
@@ -198,5 +177,14 @@ void loop() {
   // Update all modules
   moduleManager.update();
 
+  // Release the radio once a network burst has gone idle
+  networkWindow.loop();
+
+  // Run the next queued panel refresh, one panel at a time
+  refreshScheduler.loop();
+
+  // Push live values and refresh events to a subscribed client
+  telemetry.loop();
+
   delay(100);
 }
\ No newline at end of file
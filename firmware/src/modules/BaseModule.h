@@ -1,7 +1,11 @@
 #ifndef BASE_MODULE_H
 #define BASE_MODULE_H
 
+#include "config/ConfigStore.h"
 #include "displays/BaseDisplay.h"
+#include "displays/RefreshScheduler.h"
+#include "network/FetchWorker.h"
+#include "telemetry.h"
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <esp-iot-utils.h>
@@ -14,26 +18,66 @@ class BaseModule {
 public:
   virtual ~BaseModule() {}
 
-  // Metadata
-  virtual String getName() = 0;
+  // Metadata (a name that lives as long as the module)
+  virtual const char *getName() = 0;
 
   // Requirements
   virtual int getRequiredScreenCount() { return 0; }
   virtual ScreenType getRequiredScreenType(int index) { return SCREEN_TYPE_BW; }
 
-  // Resource Injection
-  virtual void assignScreen(int index, BaseDisplay *display) {}
+  // Resource Injection (panel is nullptr when the screen is taken away)
+  virtual void assignScreen(int index, Panel *panel) {}
+  // Whether this module's views can be drawn on the given panel: BW content
+  // shows on any panel, color content needs a 3-color one
+  virtual bool accepts(const Panel *panel) {
+    return getRequiredScreenType(0) == SCREEN_TYPE_BW ||
+           panel->format() == PanelFormat::TRI_COLOR;
+  }
+  // Redraw from cached data after moving to another screen
+  virtual void redraw() {}
 
-  // ConfigHelper Injection (Inversion of Control)
-  void setConfig(ConfigHelper *config) { _config = config; }
+  // ConfigStore Injection (Inversion of Control)
+  void setConfig(ConfigStore *config) { _config = config; }
 
   // Lifecycle
   virtual void begin() {}
   virtual void update() {}
   virtual void forceUpdate() { _lastUpdate = 0; }
 
+  // Redo only the work a configuration change invalidates
+  virtual void onConfigChange(const ConfigChange &change) {}
+  // A fetch submitted to the fetch task finished (called on the main loop)
+  virtual void onFetchResult(const FetchResult &result) {}
+
 protected:
-  ConfigHelper *_config = nullptr;
+  // Queues a panel refresh; the scheduler runs it and reports it on the
+  // telemetry stream
+  void refresh(BaseDisplay *display, bool fullRefresh) {
+    refreshScheduler.request(getName(), display, fullRefresh);
+  }
+
+  // Queues a partial refresh of the given cells only
+  void refreshCells(BaseDisplay *display, uint8_t cells) {
+    refreshScheduler.requestCells(getName(), display, cells);
+  }
+
+  // Queues the full-screen error, shown when there is no data to keep
+  void showError(BaseDisplay *display, const char *message) {
+    refreshScheduler.requestError(getName(), display, message);
+  }
+
+  // Keeps the last good content on screen after a failed revalidation and
+  // marks it with its age; only the badge corner is refreshed, and only
+  // when the age label changes (3-color panels show it with the next frame)
+  void showStale(BaseDisplay *display, unsigned long fetchedAt) {
+    BaseDisplay::Age age = BaseDisplay::formatAge(millis() - fetchedAt);
+    if (age == display->staleAge())
+      return;
+    display->setStaleAge(age.c_str());
+    refreshScheduler.requestBadge(getName(), display);
+  }
+
+  ConfigStore *_config = nullptr;
   unsigned long _lastUpdate = 0;
   unsigned long _updateInterval = 60000; // Default 1 min
 };
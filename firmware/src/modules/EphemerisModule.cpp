@@ -1,20 +1,44 @@
 #include "EphemerisModule.h"
+#include "../JsonArena.h"
+#include "../SolarCalculator.h"
+#include "../network/NetworkWindow.h"
 #include <ArduinoJson.h>
 #include <esp-iot-utils.h>
 
-EphemerisModule::EphemerisModule() {
+// Retries after a failed fetch: 1 min, 2 min, ... up to 1 hour. The
+// screen keeps the last good data meanwhile.
+static const unsigned long RETRY_BASE_MS = 30000;
+static const unsigned long RETRY_CAP_MS = 3600000;
+
+// "HH:MM" local time of a UTC instant
+static String formatClock(time_t t) {
+  struct tm local;
+  localtime_r(&t, &local);
+  char buf[6];
+  snprintf(buf, sizeof(buf), "%02d:%02d", local.tm_hour, local.tm_min);
+  return String(buf);
+}
+
+// Local calendar day of a UTC instant, as a daysFromCivil() number
+static long localDay(time_t t) {
+  struct tm local;
+  localtime_r(&t, &local);
+  return SolarCalculator::daysFromCivil(local.tm_year + 1900,
+                                        local.tm_mon + 1, local.tm_mday);
+}
+
+EphemerisModule::EphemerisModule() : _retry(RETRY_BASE_MS, RETRY_CAP_MS) {
   _updateInterval = 3600000; // 1 hour
 }
 
-void EphemerisModule::assignScreen(int index, BaseDisplay *display) {
+void EphemerisModule::assignScreen(int index, Panel *panel) {
   if (index == 0) {
-    _display = static_cast<EphemerisDisplay *>(display);
+    _view.setPanel(panel);
+    _display = panel ? &_view : nullptr;
   }
 }
 
 void EphemerisModule::begin() {
-  if (_display)
-    _display->init();
   update();
 }
 
@@ -28,6 +52,15 @@ void EphemerisModule::update() {
     return;
   }
 
+  if (usesLocation()) {
+    // Computed, no network: on first boot, when forced and at midnight
+    if (_lastFullRefreshDay != timeinfo.tm_mday)
+      computeLocal(timeinfo);
+    else if (_needsRender && _hasData)
+      render(timeinfo);
+    return;
+  }
+
   // Logic:
   // 1. Always update on first boot (_lastFullRefreshDay == -1)
   // 2. Otherwise, only update once a day at 00:01
@@ -35,63 +68,181 @@ void EphemerisModule::update() {
   bool isScheduledTime = (timeinfo.tm_hour == 0 && timeinfo.tm_min == 1);
   bool isNewDay = (_lastFullRefreshDay != timeinfo.tm_mday);
 
-  if (isFirstBoot || (isScheduledTime && isNewDay)) {
+  // A due fetch is latched: the network window may run it a little later
+  if (isFirstBoot) {
+    _fetchPending = true;
+    _fetchDueAt = 0; // Right away, no coalescing
+  } else if (!_fetchPending && isScheduledTime && isNewDay) {
+    _fetchPending = true;
+    _fetchDueAt = millis();
+  }
+  bool isRetry = !_fetchPending && _retry.failing();
+  unsigned long dueAt = isRetry ? _retry.retryAt() : _fetchDueAt;
+
+  if ((_fetchPending || isRetry) && networkWindow.admit(dueAt, _burst)) {
+    _fetchPending = false;
     Serial.println("[EphemerisModule] Performing daily update...");
 
-    String url = _config->get("tempus_url", String(""));
+    String url = _config->current().system.tempusUrl;
     String finalUrl = UrlHelper::replaceDatePlaceholders(url);
-    JsonDocument doc;
+    JsonDocument doc(&loopArena);
 
     if (url.isEmpty() || !HttpClient::fetchJson(finalUrl, doc)) {
       Serial.println("[EphemerisModule] Failed to fetch Sun/Season data");
-      _display->drawError("Fetch Failed");
+      _retry.failed(millis());
+      Serial.printf("[EphemerisModule] Retry %u in %lus\n", _retry.failures(),
+                    (_retry.retryAt() - millis()) / 1000);
+      _lastFullRefreshDay = timeinfo.tm_mday;
+      if (!_hasData)
+        showError(_display, "Fetch Failed");
+      else if (_renderedDay != timeinfo.tm_mday)
+        render(timeinfo); // The date is local and still has to move on
+      else
+        showStale(_display, _fetchedAt);
       return;
     }
 
-    // Local buffers for C-string storage
-    static char jourNom[12];
-    static char jourChiffre[3];
-    static char moisNom[12];
-    static char annee[5];
-
-    strcpy(jourNom, TimeHelper::getDayName(timeinfo.tm_wday));
-    snprintf(jourChiffre, sizeof(jourChiffre), "%d", timeinfo.tm_mday);
-    strcpy(moisNom, TimeHelper::getMonthName(timeinfo.tm_mon));
-    snprintf(annee, sizeof(annee), "%d", 1900 + timeinfo.tm_year);
-
-    int jourAnnee = timeinfo.tm_yday + 1;
-    int jourTotal = ((timeinfo.tm_year + 1900) % 4 == 0) ? 366 : 365;
-    int semaine = (jourAnnee / 7) + 1;
-
-    // Use static pointers to these buffers for the display struct
-    EphemerisDisplay::DateData dateData = {
-        jourNom, jourChiffre, moisNom, annee, jourAnnee, jourTotal, semaine};
-
-    EphemerisDisplay::SunData sunData;
-    sunData.sunrise = doc["sun"]["sunrise"].as<String>();
-    sunData.sunset = doc["sun"]["sunset"].as<String>();
-    sunData.dailyChange = doc["sun"]["daily_change"].as<String>();
-
-    EphemerisDisplay::SeasonData seasonData;
-    seasonData.currentSeason = doc["season"]["name"].as<String>();
-    seasonData.seasonProgress = doc["season"]["progress"].as<float>();
-    seasonData.daysUntilSpring = doc["season"]["days_until_spring"].as<int>();
-    seasonData.daysUntilSummer = doc["season"]["days_until_summer"].as<int>();
-    seasonData.daysUntilFall = doc["season"]["days_until_fall"].as<int>();
-    seasonData.daysUntilWinter = doc["season"]["days_until_winter"].as<int>();
-
-    _display->setData(dateData, sunData, seasonData);
-    _display->update(true); // Always full refresh for Ephemeris (Color)
+    _sunData.sunrise = doc["sun"]["sunrise"].as<String>();
+    _sunData.sunset = doc["sun"]["sunset"].as<String>();
+    _sunData.dailyChange = doc["sun"]["daily_change"].as<String>();
+
+    _seasonData.currentSeason = doc["season"]["name"].as<String>();
+    _seasonData.seasonProgress = doc["season"]["progress"].as<float>();
+    _seasonData.daysUntilSpring = doc["season"]["days_until_spring"].as<int>();
+    _seasonData.daysUntilSummer = doc["season"]["days_until_summer"].as<int>();
+    _seasonData.daysUntilFall = doc["season"]["days_until_fall"].as<int>();
+    _seasonData.daysUntilWinter = doc["season"]["days_until_winter"].as<int>();
+    _hasData = true;
+    _fetchedAt = millis();
+    _retry.succeeded();
+
+    _display->setStaleAge("");
+    render(timeinfo);
 
     _lastFullRefreshDay = timeinfo.tm_mday;
     _lastUpdate = millis();
     Serial.println("[EphemerisModule] Daily update completed");
+  } else if (_needsRender && _hasData) {
+    // Day and month names follow the language, the fetched data does not
+    render(timeinfo);
   }
 }
 
+bool EphemerisModule::usesLocation() const {
+  const SystemConfig &sys = _config->current().system;
+  return sys.latitude != 0 || sys.longitude != 0;
+}
+
+void EphemerisModule::computeLocal(const struct tm &timeinfo) {
+  const SystemConfig &sys = _config->current().system;
+  unsigned long start = micros();
+  int year = timeinfo.tm_year + 1900;
+  long today = SolarCalculator::daysFromCivil(year, timeinfo.tm_mon + 1,
+                                              timeinfo.tm_mday);
+
+  SolarCalculator::Day sun =
+      SolarCalculator::day(today, sys.latitude, sys.longitude);
+  SolarCalculator::Day before =
+      SolarCalculator::day(today - 1, sys.latitude, sys.longitude);
+  _sunData.sunrise = sun.rises ? formatClock(sun.sunrise) : "--:--";
+  _sunData.sunset = sun.rises ? formatClock(sun.sunset) : "--:--";
+  if (sun.rises && before.rises) {
+    long change = sun.lengthSec - before.lengthSec;
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%c%ldm%02lds", change < 0 ? '-' : '+',
+             labs(change) / 60, labs(change) % 60);
+    _sunData.dailyChange = buf;
+  } else {
+    _sunData.dailyChange = "--";
+  }
+
+  // Seasons start at the astronomical boundaries, shifted by two in the
+  // southern hemisphere (the March equinox starts autumn there)
+  static const char *SEASONS[4] = {"spring", "summer", "fall", "winter"};
+  int shift = sys.latitude < 0 ? 2 : 0;
+  time_t now = time(nullptr);
+  time_t seasonStart =
+      SolarCalculator::boundary(year - 1, SolarCalculator::DECEMBER_SOLSTICE);
+  time_t seasonEnd = 0;
+  int current = SolarCalculator::DECEMBER_SOLSTICE;
+  int *daysUntil[4] = {&_seasonData.daysUntilSpring,
+                       &_seasonData.daysUntilSummer, &_seasonData.daysUntilFall,
+                       &_seasonData.daysUntilWinter};
+  for (int b = 0; b < 4; b++) {
+    auto which = (SolarCalculator::Boundary)b;
+    time_t at = SolarCalculator::boundary(year, which);
+    if (at <= now) {
+      seasonStart = at;
+      current = b;
+    } else if (seasonEnd == 0) {
+      seasonEnd = at;
+    }
+    if (at <= now)
+      at = SolarCalculator::boundary(year + 1, which);
+    *daysUntil[(b + shift) % 4] = localDay(at) - today;
+  }
+  if (seasonEnd == 0) // After the December solstice
+    seasonEnd =
+        SolarCalculator::boundary(year + 1, SolarCalculator::MARCH_EQUINOX);
+
+  _seasonData.currentSeason = SEASONS[(current + shift) % 4];
+  _seasonData.seasonProgress =
+      100.0f * (now - seasonStart) / (seasonEnd - seasonStart);
+
+  _hasData = true;
+  _fetchedAt = millis();
+  _fetchPending = false;
+  _retry.succeeded();
+  Serial.printf("[EphemerisModule] Computed sun and seasons in %luus\n",
+                micros() - start);
+
+  _display->setStaleAge("");
+  render(timeinfo);
+  _lastFullRefreshDay = timeinfo.tm_mday;
+  _lastUpdate = millis();
+}
+
+void EphemerisModule::render(const struct tm &timeinfo) {
+  // Local buffers for C-string storage
+  static char jourNom[12];
+  static char jourChiffre[3];
+  static char moisNom[12];
+  static char annee[5];
+
+  strcpy(jourNom, TimeHelper::getDayName(timeinfo.tm_wday));
+  snprintf(jourChiffre, sizeof(jourChiffre), "%d", timeinfo.tm_mday);
+  strcpy(moisNom, TimeHelper::getMonthName(timeinfo.tm_mon));
+  snprintf(annee, sizeof(annee), "%d", 1900 + timeinfo.tm_year);
+
+  int jourAnnee = timeinfo.tm_yday + 1;
+  int jourTotal = ((timeinfo.tm_year + 1900) % 4 == 0) ? 366 : 365;
+  int semaine = (jourAnnee / 7) + 1;
+
+  // Use static pointers to these buffers for the display struct
+  EphemerisDisplay::DateData dateData = {
+      jourNom, jourChiffre, moisNom, annee, jourAnnee, jourTotal, semaine};
+
+  if (_retry.failing()) // Still not revalidated
+    _display->setStaleAge(
+        BaseDisplay::formatAge(millis() - _fetchedAt).c_str());
+
+  _display->setData(dateData, _sunData, _seasonData);
+  refresh(_display, true); // Always full refresh for Ephemeris (Color)
+  _needsRender = false;
+  _renderedDay = timeinfo.tm_mday;
+}
+
 void EphemerisModule::forceUpdate() {
   Serial.println("[EphemerisModule] Force update called!");
   Serial.print("[EphemerisModule] Current Language: ");
   Serial.println(TimeHelper::getLanguage());
-  _lastUpdate = 0;
+  // update() schedules on _lastFullRefreshDay, not _lastUpdate
+  _lastFullRefreshDay = -1;
+}
+
+void EphemerisModule::onConfigChange(const ConfigChange &change) {
+  if (change.tempus || change.location)
+    forceUpdate();
+  else if (change.language)
+    _needsRender = true;
 }
@@ -2,6 +2,7 @@
 #define EPHEMERIS_MODULE_H
 
 #include "../displays/EphemerisDisplay.h"
+#include "../network/RetryPolicy.h"
 #include "BaseModule.h"
 
 // Responsibilities: Date, Sun, Seasons
@@ -9,19 +10,41 @@
 class EphemerisModule : public BaseModule {
 public:
   EphemerisModule();
-  String getName() override { return "Ephemeris"; }
+  const char *getName() override { return "Ephemeris"; }
   int getRequiredScreenCount() override { return 1; }
   ScreenType getRequiredScreenType(int index) override {
     return SCREEN_TYPE_COLOR;
   }
-  void assignScreen(int index, BaseDisplay *display) override;
+  void assignScreen(int index, Panel *panel) override;
   void begin();
   void update();
   void forceUpdate() override;
+  void onConfigChange(const ConfigChange &change) override;
+  void redraw() override { _needsRender = true; }
 
 private:
-  EphemerisDisplay *_display;
-  int _lastFullRefreshDay = -1;
+  // View drawn on the assigned panel; _display is nullptr while unassigned
+  EphemerisDisplay _view;
+  EphemerisDisplay *_display = nullptr;
+  int _lastFullRefreshDay = -1; // -1 = fetch on next update()
+  bool _needsRender = false;    // Redraw cached data (language change)
+
+  // Last fetched data, kept to redraw without refetching
+  bool _hasData = false;
+  unsigned long _fetchedAt = 0; // millis() of the last good fetch
+  RetryPolicy _retry;           // Background revalidation after failures
+  bool _fetchPending = false;   // Due, waiting for the network window
+  unsigned long _fetchDueAt = 0;
+  uint32_t _burst = 0; // Network burst of the last fetch
+  int _renderedDay = -1;
+  EphemerisDisplay::SunData _sunData;
+  EphemerisDisplay::SeasonData _seasonData;
+
+  void render(const struct tm &timeinfo);
+
+  // Sun and seasons from the configured location instead of Tempus
+  bool usesLocation() const;
+  void computeLocal(const struct tm &timeinfo);
 };
 
 #endif
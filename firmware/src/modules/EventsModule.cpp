@@ -1,22 +1,89 @@
 #include "EventsModule.h"
+#include "../JsonArena.h"
+#include "../SolarCalculator.h"
+#include "../network/NetworkWindow.h"
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
 #include <esp-iot-utils.h>
 #include <vector>
 
-EventsModule::EventsModule() {
+// Retries after a failed fetch: 1 min, 2 min, ... up to 1 hour. The
+// screen keeps the last good data meanwhile.
+static const unsigned long RETRY_BASE_MS = 30000;
+static const unsigned long RETRY_CAP_MS = 3600000;
+
+// Birthdays listed from the local calendar
+static const int BIRTHDAY_WINDOW_DAYS = 30;
+static const int BIRTHDAY_LIMIT = 8;
+
+// Agenda window and refresh period of the ICS feed
+static const int AGENDA_DAYS = 14;
+static const unsigned long AGENDA_INTERVAL_MS = 3600000;
+
+EventsModule::EventsModule()
+    : _retry(RETRY_BASE_MS, RETRY_CAP_MS),
+      _agendaRetry(RETRY_BASE_MS, RETRY_CAP_MS) {
   _updateInterval = 3600000; // 1 hour
 }
 
-void EventsModule::assignScreen(int index, BaseDisplay *display) {
+// Local midnight of the day in timeinfo
+static time_t startOfDay(const struct tm &timeinfo) {
+  struct tm midnight = timeinfo;
+  midnight.tm_hour = midnight.tm_min = midnight.tm_sec = 0;
+  midnight.tm_isdst = -1;
+  return mktime(&midnight);
+}
+
+// Streams the feed through IcsParser; -1 on failure
+static int fetchAgenda(String url, time_t from, time_t to,
+                       IcsParser::Occurrence *out) {
+  if (WiFi.status() != WL_CONNECTED) {
+    Serial.println("[EventsModule] WiFi not connected");
+    return -1;
+  }
+  if (url.startsWith("webcal://"))
+    url = "https://" + url.substring(9);
+
+  WiFiClient plainClient;
+  WiFiClientSecure secureClient;
+  bool isHttps = url.startsWith("https://");
+  if (isHttps)
+    secureClient.setInsecure();
+
+  HTTPClient http;
+  if (!http.begin(isHttps ? (WiFiClient &)secureClient : plainClient, url)) {
+    Serial.println("[EventsModule] Invalid ICS URL: " + url);
+    return -1;
+  }
+  http.setTimeout(10000);
+  // Parsed from the raw socket, which must not be chunked
+  http.useHTTP10(true);
+
+  int code = http.GET();
+  if (code != HTTP_CODE_OK) {
+    Serial.printf("[EventsModule] ICS HTTP error %d\n", code);
+    http.end();
+    return -1;
+  }
+  int count = IcsParser::upcoming(http.getStream(), from, to, out,
+                                  IcsParser::MAX_EVENTS);
+  http.end();
+  if (count < 0)
+    Serial.println("[EventsModule] Response is not an iCalendar feed");
+  return count;
+}
+
+void EventsModule::assignScreen(int index, Panel *panel) {
   if (index == 0) {
-    _display = static_cast<EventsDisplay *>(display);
+    _view.setPanel(panel);
+    _display = panel ? &_view : nullptr;
   }
 }
 
 void EventsModule::begin() {
-  if (_display)
-    _display->init();
   update();
 }
 
@@ -30,20 +97,52 @@ void EventsModule::update() {
     return;
   }
 
+  updateAgenda(timeinfo);
+
+  if (usesCalendar()) {
+    // Computed, no network: on first boot, when forced and at midnight
+    if (_lastFullRefreshDay != timeinfo.tm_mday) {
+      computeLocal(timeinfo);
+    } else if (_needsRender && _hasData) {
+      refresh(_display, true);
+      _needsRender = false;
+    }
+    return;
+  }
+
   bool isFirstBoot = (_lastFullRefreshDay == -1);
   bool isScheduledTime = (timeinfo.tm_hour == 0 && timeinfo.tm_min == 1);
   bool isNewDay = (_lastFullRefreshDay != timeinfo.tm_mday);
 
-  if (isFirstBoot || (isScheduledTime && isNewDay)) {
+  // A due fetch is latched: the network window may run it a little later
+  if (isFirstBoot) {
+    _fetchPending = true;
+    _fetchDueAt = 0; // Right away, no coalescing
+  } else if (!_fetchPending && isScheduledTime && isNewDay) {
+    _fetchPending = true;
+    _fetchDueAt = millis();
+  }
+  bool isRetry = !_fetchPending && _retry.failing();
+  unsigned long dueAt = isRetry ? _retry.retryAt() : _fetchDueAt;
+
+  if ((_fetchPending || isRetry) && networkWindow.admit(dueAt, _burst)) {
+    _fetchPending = false;
     Serial.println("[EventsModule] Performing daily update...");
 
-    String url = _config->get("tempus_url", String(""));
+    String url = _config->current().system.tempusUrl;
     String finalUrl = UrlHelper::replaceDatePlaceholders(url);
-    JsonDocument doc;
+    JsonDocument doc(&loopArena);
 
     if (url.isEmpty() || !HttpClient::fetchJson(finalUrl, doc)) {
       Serial.println("[EventsModule] Failed to fetch Trash/Birthday data");
-      _display->drawError("Fetch Failed");
+      _retry.failed(millis());
+      Serial.printf("[EventsModule] Retry %u in %lus\n", _retry.failures(),
+                    (_retry.retryAt() - millis()) / 1000);
+      _lastFullRefreshDay = timeinfo.tm_mday;
+      if (_hasData)
+        showStale(_display, _fetchedAt);
+      else
+        showError(_display, "Fetch Failed");
       return;
     }
 
@@ -57,7 +156,7 @@ void EventsModule::update() {
     JsonArray bdayArray = doc["birthdays"]["this_month"].as<JsonArray>();
     for (JsonObject b : bdayArray) {
       EventsDisplay::Birthday bd;
-      bd.name = b["name"].as<String>();
+      bd.name = b["name"] | "";
       bd.day = b["day"].as<int>();
       bd.days_until = b["days_until"].as<int>();
       bd.is_today = b["is_today"].as<bool>();
@@ -65,15 +164,159 @@ void EventsModule::update() {
     }
 
     _display->setData(trashData, birthdays, timeinfo.tm_mday);
-    _display->update(true); // Full refresh to avoid ghosting
+    _display->setStaleAge("");
+    refresh(_display, true); // Full refresh to avoid ghosting
+    _hasData = true;
+    _fetchedAt = millis();
+    _retry.succeeded();
+    _needsRender = false;
 
     _lastFullRefreshDay = timeinfo.tm_mday;
     _lastUpdate = millis();
     Serial.println("[EventsModule] Daily update completed");
+  } else if (_needsRender && _hasData) {
+    // Headings follow the language, the display keeps the fetched data
+    refresh(_display, true);
+    _needsRender = false;
+  }
+}
+
+bool EventsModule::usesCalendar() const {
+  const ConfigSnapshot &config = _config->current();
+  return !config.calendar.empty() ||
+         (config.system.tempusUrl.isEmpty() && !config.system.icsUrl.isEmpty());
+}
+
+void EventsModule::computeLocal(const struct tm &timeinfo) {
+  const CalendarRules &rules = _config->current().calendar;
+  unsigned long start = micros();
+  long today = SolarCalculator::daysFromCivil(
+      timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday);
+
+  EventsDisplay::TrashData trashData;
+  trashData.blackDays = rules.nextCollection(CalendarRules::BLACK, today);
+  trashData.blackToday = trashData.blackDays == 0;
+  trashData.yellowDays = rules.nextCollection(CalendarRules::YELLOW, today);
+  trashData.yellowToday = trashData.yellowDays == 0;
+
+  CalendarRules::Upcoming upcoming[BIRTHDAY_LIMIT];
+  int count =
+      rules.upcoming(today, BIRTHDAY_WINDOW_DAYS, upcoming, BIRTHDAY_LIMIT);
+  std::vector<EventsDisplay::Birthday> birthdays;
+  for (int i = 0; i < count; i++) {
+    EventsDisplay::Birthday bd;
+    bd.name = upcoming[i].name;
+    bd.day = upcoming[i].day;
+    bd.month = upcoming[i].month;
+    bd.days_until = upcoming[i].daysUntil;
+    bd.is_today = upcoming[i].daysUntil == 0;
+    birthdays.push_back(bd);
+  }
+  Serial.printf("[EventsModule] Computed trash and birthdays in %luus\n",
+                micros() - start);
+
+  _display->setData(trashData, birthdays, timeinfo.tm_mday, true);
+  _display->setStaleAge("");
+  refresh(_display, true); // Full refresh to avoid ghosting
+  _hasData = true;
+  _fetchedAt = millis();
+  _fetchPending = false;
+  _retry.succeeded();
+  _needsRender = false;
+
+  _lastFullRefreshDay = timeinfo.tm_mday;
+  _lastUpdate = millis();
+}
+
+void EventsModule::updateAgenda(const struct tm &timeinfo) {
+  String url = _config->current().system.icsUrl;
+  if (url.isEmpty()) {
+    if (_display->agenda()) {
+      _display->setAgenda({}, false);
+      _needsRender = true;
+    }
+    return;
+  }
+
+  unsigned long now = millis();
+  bool forced = _agendaDay == -1;
+  if (!forced && _agendaDay != timeinfo.tm_mday) {
+    // The window moved: redraw from the known events, refetch soon
+    _agendaDay = timeinfo.tm_mday;
+    showAgenda(timeinfo);
+    if ((long)(_agendaDueAt - now) > 0)
+      _agendaDueAt = now;
+  }
+  if (!networkWindow.admit(forced ? 0 : _agendaDueAt, _agendaBurst))
+    return;
+
+  unsigned long start = millis();
+  time_t from = startOfDay(timeinfo);
+  IcsParser::Occurrence found[IcsParser::MAX_EVENTS];
+  int count = fetchAgenda(url, from, from + AGENDA_DAYS * 86400L, found);
+  _agendaDay = timeinfo.tm_mday;
+  if (count < 0) {
+    _agendaRetry.failed(millis());
+    _agendaDueAt = _agendaRetry.retryAt();
+    return; // The last agenda stays on screen
+  }
+  _agendaRetry.succeeded();
+  _agendaDueAt = millis() + AGENDA_INTERVAL_MS;
+  Serial.printf("[EventsModule] Agenda: %d events in %lums\n", count,
+                millis() - start);
+
+  uint32_t hash = 2166136261u; // FNV-1a over what is drawn
+  for (int i = 0; i < count; i++) {
+    const IcsParser::Occurrence &occ = found[i];
+    hash = (hash ^ (uint32_t)occ.start) * 16777619u;
+    for (const char *c = occ.summary; *c; c++)
+      hash = (hash ^ (uint8_t)*c) * 16777619u;
+  }
+  memcpy(_occurrences, found, count * sizeof(found[0]));
+  _occurrenceCount = count;
+  if (hash != _agendaHash || !_display->agenda()) {
+    _agendaHash = hash;
+    showAgenda(timeinfo);
   }
 }
 
+void EventsModule::showAgenda(const struct tm &timeinfo) {
+  long today = SolarCalculator::daysFromCivil(
+      timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday);
+  time_t from = startOfDay(timeinfo);
+
+  std::vector<EventsDisplay::Event> events;
+  for (int i = 0; i < _occurrenceCount; i++) {
+    const IcsParser::Occurrence &occ = _occurrences[i];
+    if (occ.start < from)
+      continue; // Fetched yesterday, now past
+    struct tm local;
+    localtime_r(&occ.start, &local);
+    EventsDisplay::Event ev;
+    ev.title = occ.summary;
+    ev.month = local.tm_mon + 1;
+    ev.day = local.tm_mday;
+    ev.minutes = occ.allDay ? -1 : local.tm_hour * 60 + local.tm_min;
+    ev.days_until = SolarCalculator::daysFromCivil(local.tm_year + 1900,
+                                                   local.tm_mon + 1,
+                                                   local.tm_mday) -
+                    today;
+    events.push_back(ev);
+  }
+  _display->setAgenda(events, true);
+  _needsRender = true;
+}
+
 void EventsModule::forceUpdate() {
   Serial.println("[EventsModule] Force update called!");
-  _lastUpdate = 0;
+  // update() schedules on _lastFullRefreshDay, not _lastUpdate
+  _lastFullRefreshDay = -1;
+  _agendaDay = -1;
+}
+
+void EventsModule::onConfigChange(const ConfigChange &change) {
+  if (change.tempus || change.calendar)
+    forceUpdate(); // Also the ICS feed
+  else if (change.language)
+    _needsRender = true;
 }
@@ -2,6 +2,8 @@
 #define EVENTS_MODULE_H
 
 #include "../displays/EventsDisplay.h"
+#include "../network/IcsParser.h"
+#include "../network/RetryPolicy.h"
 #include "BaseModule.h"
 
 // Responsibilities: Trash, Birthdays
@@ -10,22 +12,50 @@ class EventsModule : public BaseModule {
 public:
   EventsModule();
 
-  String getName() override { return "Events"; }
+  const char *getName() override { return "Events"; }
 
   int getRequiredScreenCount() override { return 1; }
   ScreenType getRequiredScreenType(int index) override {
     return SCREEN_TYPE_BW;
   }
 
-  void assignScreen(int index, BaseDisplay *display) override;
+  void assignScreen(int index, Panel *panel) override;
 
   void begin() override;
   void update() override;
   void forceUpdate() override;
+  void onConfigChange(const ConfigChange &change) override;
+  void redraw() override { _needsRender = true; }
 
 private:
+  // View drawn on the assigned panel; _display is nullptr while unassigned
+  EventsDisplay _view;
   EventsDisplay *_display = nullptr;
-  int _lastFullRefreshDay = -1;
+  int _lastFullRefreshDay = -1; // -1 = fetch on next update()
+  bool _hasData = false;
+  unsigned long _fetchedAt = 0; // millis() of the last good fetch
+  RetryPolicy _retry;           // Background revalidation after failures
+  bool _fetchPending = false;   // Due, waiting for the network window
+  bool _needsRender = false;    // Redraw cached data (language change)
+  unsigned long _fetchDueAt = 0;
+  uint32_t _burst = 0; // Network burst of the last fetch
+
+  // Agenda from SystemConfig::icsUrl: the next events, refetched hourly
+  IcsParser::Occurrence _occurrences[IcsParser::MAX_EVENTS];
+  int _occurrenceCount = 0;
+  int _agendaDay = -1;            // -1 = fetch on next update()
+  unsigned long _agendaDueAt = 0; // millis() of the next fetch
+  uint32_t _agendaHash = 0;       // Redraw only when the agenda changed
+  uint32_t _agendaBurst = 0;      // Network burst of the last fetch
+  RetryPolicy _agendaRetry;       // Backoff after failed fetches
+
+  // Trash and birthdays from SystemConfig::calendar instead of Tempus
+  // (also with only an ICS feed configured)
+  bool usesCalendar() const;
+  void computeLocal(const struct tm &timeinfo);
+
+  void updateAgenda(const struct tm &timeinfo);
+  void showAgenda(const struct tm &timeinfo);
 };
 
 #endif
@@ -1,125 +1,157 @@
 #include "ModuleManager.h"
+#include "../JsonArena.h"
 
 ModuleManager::ModuleManager(DisplayManager &displayManager,
-                             ConfigHelper &config)
+                             ConfigStore &config)
     : _displayManager(displayManager), _config(config) {}
 
 void ModuleManager::registerModule(BaseModule *module) {
   // Inject Config dependency
   module->setConfig(&_config);
   _modules.push_back(module);
+  _byName[module->getName()].push_back(module);
 }
 
 void ModuleManager::begin() {
   Serial.println("[ModuleManager] Starting...");
 
-  // Load Mapping from Config
-  String mappingJson = _config.get("module_map", String(""));
-  Serial.println("[ModuleManager] Loaded Mapping: " + mappingJson);
-
-  std::vector<String> mapping;
-  if (mappingJson.length() > 2) {
-    JsonDocument doc;
-    if (!deserializeJson(doc, mappingJson)) {
-      JsonArray arr = doc.as<JsonArray>();
-      for (JsonVariant v : arr) {
-        mapping.push_back(v.as<String>());
-      }
-    }
-  }
-
   // 1. Assign Screens
-  // First, verify if we have a valid mapping for all 4 screens
-  bool useMapping = (mapping.size() == 4);
-
-  if (useMapping) {
+  Assignment assignment = {};
+  if (resolveMapping(_config.current().system.moduleMap, assignment)) {
     Serial.println("[ModuleManager] Using Custom Mapping");
+  } else {
+    Serial.println("[ModuleManager] Using Default Logic");
+    defaultMapping(assignment);
+  }
 
-    // Track which module instances are already assigned
-    std::vector<BaseModule *> assignedModules;
-
-    // Iterate over screens 0 to 3
-    for (int screenIdx = 0; screenIdx < 4; screenIdx++) {
-      String moduleName = mapping[screenIdx];
-      BaseDisplay *display = _displayManager.getDisplay(screenIdx);
+  for (int screenIdx = 0; screenIdx < SCREEN_COUNT; screenIdx++) {
+    _assignment[screenIdx] = assignment[screenIdx];
+    if (assignment[screenIdx]) {
+      assignment[screenIdx]->assignScreen(
+          0, _displayManager.getPanel(screenIdx));
+      Serial.printf("[ModuleManager] Assigned %s to Screen %d\n",
+                    assignment[screenIdx]->getName(), screenIdx);
+    }
+  }
 
-      if (moduleName == "None" || moduleName == "Empty") {
-        continue;
-      }
+  // 2. Begin Module
+  for (auto *module : _modules) {
+    module->begin();
+  }
+}
 
-      // Find an available module with this name
-      BaseModule *targetModule = nullptr;
-      for (auto *m : _modules) {
-        if (m->getName() == moduleName) {
-          // Check if THIS instance is already assigned
-          bool alreadyAssigned = false;
-          for (auto *am : assignedModules) {
-            if (am == m) {
-              alreadyAssigned = true;
-              break;
-            }
-          }
-          if (!alreadyAssigned) {
-            targetModule = m;
-            break;
-          }
-        }
-      }
+void ModuleManager::remap() {
+  Assignment next = {};
+  if (!resolveMapping(_config.current().system.moduleMap, next))
+    defaultMapping(next);
 
-      if (targetModule) {
-        targetModule->assignScreen(0, display);
-        assignedModules.push_back(targetModule);
-        _screenAssigned[screenIdx] = true;
-        Serial.printf("[ModuleManager] Assigned %s to Screen %d\n",
-                      moduleName.c_str(), screenIdx);
+  // Detach first: a module moving from screen A to B must not keep A
+  for (int screenIdx = 0; screenIdx < SCREEN_COUNT; screenIdx++) {
+    BaseModule *previous = _assignment[screenIdx];
+    if (previous && previous != next[screenIdx])
+      previous->assignScreen(0, nullptr);
+  }
 
-      } else {
-        Serial.printf("[ModuleManager] No available module %s for Screen %d\n",
-                      moduleName.c_str(), screenIdx);
-      }
+  for (int screenIdx = 0; screenIdx < SCREEN_COUNT; screenIdx++) {
+    BaseModule *module = next[screenIdx];
+    if (module == _assignment[screenIdx])
+      continue; // Unchanged screen: no redraw
+
+    Panel *panel = _displayManager.getPanel(screenIdx);
+    _assignment[screenIdx] = module;
+    if (module) {
+      module->assignScreen(0, panel);
+      module->redraw();
+      Serial.printf("[ModuleManager] Moved %s to Screen %d\n",
+                    module->getName(), screenIdx);
+    } else if (panel) {
+      refreshScheduler.requestClear("None", panel);
+      Serial.printf("[ModuleManager] Screen %d cleared\n", screenIdx);
     }
+  }
+}
 
-  } else {
-    // FALBACK TO DEFAULT LOGIC (First Fit)
-    Serial.println("[ModuleManager] Using Default Logic");
+// Parses ["Ephemeris", "Sensors", "Events", "Sensors"]; repeated names take
+// the next instance registered under that name. A map shorter than the
+// panel table leaves the remaining screens empty.
+bool ModuleManager::resolveMapping(const String &mappingJson,
+                                   Assignment &out) {
+  if (mappingJson.length() <= 2)
+    return false;
+
+  JsonDocument doc(&loopArena);
+  if (deserializeJson(doc, mappingJson))
+    return false;
+  JsonArray arr = doc.as<JsonArray>();
+  if (arr.size() == 0 || arr.size() > (size_t)SCREEN_COUNT)
+    return false;
+
+  std::map<String, size_t> used;
+  int screenIdx = 0;
+  for (JsonVariant v : arr) {
+    String moduleName = v.as<String>();
+    int idx = screenIdx++;
+    if (moduleName == "None" || moduleName == "Empty")
+      continue;
 
-    for (auto *module : _modules) {
-      Serial.printf("[ModuleManager] Configuring module: %s\n",
-                    module->getName().c_str());
-
-      int required = module->getRequiredScreenCount();
-      for (int i = 0; i < required; i++) {
-        ScreenType type = module->getRequiredScreenType(i);
-        BaseDisplay *screen = findFreeScreen(type);
-
-        if (screen) {
-          Serial.printf("[ModuleManager] Assigned screen to %s\n",
-                        module->getName().c_str());
-          module->assignScreen(i, screen);
-
-          // Find which index this screen corresponds to
-          for (int j = 0; j < 4; j++) {
-            if (_displayManager.getDisplay(j) == screen) {
-              break;
-            }
-          }
-
-        } else {
-          Serial.printf("[ModuleManager] ERROR: No free screen of type %d for "
-                        "module %s\n",
-                        type, module->getName().c_str());
-        }
-      }
+    auto it = _byName.find(moduleName);
+    size_t &next = used[moduleName];
+    if (it == _byName.end() || next >= it->second.size()) {
+      Serial.printf("[ModuleManager] No available module %s for Screen %d\n",
+                    moduleName.c_str(), idx);
+      continue;
     }
+
+    BaseModule *module = it->second[next];
+    if (!fits(module, idx)) {
+      Serial.printf("[ModuleManager] %s cannot drive Screen %d\n",
+                    moduleName.c_str(), idx);
+      continue;
+    }
+    out[idx] = module;
+    next++;
   }
+  return true;
+}
 
-  // 2. Begin Module
+// First fit, in registration order, on panels of the module's own type
+void ModuleManager::defaultMapping(Assignment &out) {
   for (auto *module : _modules) {
-    module->begin();
+    if (module->getRequiredScreenCount() == 0)
+      continue;
+    for (int screenIdx = 0; screenIdx < SCREEN_COUNT; screenIdx++) {
+      if (out[screenIdx] ||
+          nativeType(screenIdx) != module->getRequiredScreenType(0))
+        continue;
+      if (fits(module, screenIdx)) {
+        out[screenIdx] = module;
+        break;
+      }
+    }
   }
 }
 
+ScreenType ModuleManager::nativeType(int screenIdx) {
+  Panel *panel = _displayManager.getPanel(screenIdx);
+  return panel && panel->format() == PanelFormat::TRI_COLOR ? SCREEN_TYPE_COLOR
+                                                            : SCREEN_TYPE_BW;
+}
+
+// Any module whose content the panel can show; a custom map may put a BW
+// module on the color panel
+bool ModuleManager::fits(BaseModule *module, int screenIdx) {
+  Panel *panel = _displayManager.getPanel(screenIdx);
+  return panel && module->accepts(panel);
+}
+
 void ModuleManager::update() {
+  // Hand finished fetches to their modules before they decide what to draw
+  FetchResult result;
+  while (fetchWorker.poll(result)) {
+    for (auto *module : _modules)
+      module->onFetchResult(result);
+  }
+
   for (auto *module : _modules) {
     module->update();
   }
@@ -129,36 +161,21 @@ void ModuleManager::forceUpdate() {
   Serial.println("[ModuleManager] Force Update Triggered");
   for (auto *module : _modules) {
     Serial.printf("[ModuleManager] Forcing update for %s\n",
-                  module->getName().c_str());
+                  module->getName());
     module->forceUpdate();
   }
 }
 
-BaseDisplay *ModuleManager::findFreeScreen(ScreenType type) {
-  // Current mapping (Hardcoded in DisplayManager / hardware setup)
-  // Index 0: Color (CalendarDisplay)
-  // Index 1: BW (SensorDisplay)
-  // Index 2: BW (EventsDisplay)
-  // Index 3: BW (QRCodeDisplay)
+void ModuleManager::applyChange(const ConfigChange &change) {
+  Serial.printf("[ModuleManager] Config change: refetch 0x%04x, relabel "
+                "0x%04x, layout %d, language %d, tempus %d, location %d, "
+                "calendar %d\n",
+                change.refetch, change.relabel, change.layout, change.language,
+                change.tempus, change.location, change.calendar);
+  if (change.moduleMap)
+    remap();
 
-  // Strategy: First Fit
-  for (int i = 0; i < 4; i++) {
-    if (_screenAssigned[i])
-      continue;
-
-    // Check compatibility
-    bool isCompatible = false;
-    if (type == SCREEN_TYPE_COLOR &&
-        i == 0) { // Screen 0 is Color (Previously 1)
-      isCompatible = true;
-    } else if (type == SCREEN_TYPE_BW && i != 0) { // Screens 1, 2, 3 are BW
-      isCompatible = true;
-    }
-
-    if (isCompatible) {
-      _screenAssigned[i] = true;
-      return _displayManager.getDisplay(i);
-    }
+  for (auto *module : _modules) {
+    module->onConfigChange(change);
   }
-  return nullptr;
 }
@@ -4,27 +4,42 @@
 #include "../displays/DisplayManager.h"
 #include "modules/BaseModule.h"
 #include <esp-iot-utils.h>
+#include <map>
 #include <vector>
 
 class ModuleManager {
 public:
-  ModuleManager(DisplayManager &displayManager, ConfigHelper &config);
+  static const int SCREEN_COUNT = PANEL_COUNT;
+
+  ModuleManager(DisplayManager &displayManager, ConfigStore &config);
 
   void registerModule(BaseModule *module);
   void begin();
   void update();
   void forceUpdate();
+  void applyChange(const ConfigChange &change);
+
+  // Re-reads module_map and moves modules without a reboot. Only screens
+  // whose module changed are redrawn, from the modules' cached data.
+  void remap();
 
 private:
+  using Assignment = BaseModule *[SCREEN_COUNT];
+
   DisplayManager &_displayManager;
-  ConfigHelper &_config;
+  ConfigStore &_config;
   std::vector<BaseModule *> _modules;
 
-  // Track assigned screens to avoid double assignment
-  // 4 screens total as per config.h
-  bool _screenAssigned[4] = {false, false, false, false};
+  // Module name -> registered instances, in registration order
+  std::map<String, std::vector<BaseModule *>> _byName;
+
+  // Module currently driving each screen (nullptr = unused)
+  BaseModule *_assignment[SCREEN_COUNT] = {};
 
-  BaseDisplay *findFreeScreen(ScreenType type);
+  bool resolveMapping(const String &mappingJson, Assignment &out);
+  void defaultMapping(Assignment &out);
+  bool fits(BaseModule *module, int screenIdx);
+  ScreenType nativeType(int screenIdx);
 };
 
 #endif
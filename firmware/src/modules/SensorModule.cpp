@@ -1,114 +1,310 @@
 #include "SensorModule.h"
+#include "../SensorHistory.h"
+#include "../network/FetchWorker.h"
+#include "../network/NetworkWindow.h"
+#include "../network/RetryPolicy.h"
 #include <esp-iot-utils.h>
 
-SensorModule::SensorModule(String name, int startSlot)
+SensorModule::SensorModule(const char *name, int startSlot)
     : _moduleName(name), _startSlot(startSlot) {}
 
-void SensorModule::assignScreen(int index, BaseDisplay *display) {
+void SensorModule::assignScreen(int index, Panel *panel) {
   if (index == 0) {
-    _display = static_cast<SensorDisplay *>(display);
+    _view.setPanel(panel);
+    _display = panel ? &_view : nullptr;
   }
 }
 
-void SensorModule::begin() {
-  if (_display) {
-    _display->init();
+// Stable values are polled less often (up to 4x the base interval, a day
+// at most), failing slots back off exponentially with +/-20% jitter.
+static const uint8_t STABLE_RUNS_PER_STEP = 3;
+static const uint8_t MAX_STABLE_SHIFT = 2;
+static const unsigned long MAX_ERROR_BACKOFF = 3600000; // 1 hour
+static const unsigned long MAX_STABLE_DELAY = 86400000; // 1 day
+
+std::atomic<uint32_t> SensorModule::_suppressedRefreshes{0};
+
+// Decide whether a fresh value is worth an e-paper refresh: wobble inside
+// the deadband, or a value that formats to the same string, is dropped.
+bool SensorModule::isSignificant(int slot, const SensorConfig &config,
+                                 float value) {
+  if (!_hasData[slot] || _labels[slot] != SensorDisplay::Label(config.label) ||
+      _units[slot] != SensorDisplay::Unit(config.unit) ||
+      _decimals[slot] != config.decimals)
+    return true;
+
+  float shown = _values[slot];
+  if (config.deadband > 0) {
+    float threshold = (config.deadbandMode == "rel")
+                          ? fabsf(shown) * config.deadband / 100.0f
+                          : config.deadband;
+    if (fabsf(value - shown) < threshold)
+      return false;
   }
+
+  if (config.onChange &&
+      SensorDisplay::Value().format(value, config.decimals) ==
+          SensorDisplay::Value().format(shown, config.decimals))
+    return false;
+
+  return true;
 }
 
-void SensorModule::update() {
-  if (_lastUpdate != 0 && millis() - _lastUpdate < _updateInterval)
+// Stale markers change with the age label only, and redraw just their cell
+void SensorModule::markStale(int slot, const SensorDisplay::Age &age) {
+  if (age == _staleAge[slot])
     return;
+  _staleAge[slot] = age;
+  _relabeled |= 1 << slot;
+}
 
-  Serial.println("[SensorModule] Updating sensors...");
-  _lastUpdate = millis();
+// Date placeholders only change at midnight: the URL is expanded once a day
+// (and after a source change), not on every fetch. The time is read without
+// getLocalTime(), which may wait for NTP.
+const String &SensorModule::expandedUrl(int slot, const SensorConfig &config) {
+  time_t now = time(nullptr);
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  int day = timeinfo.tm_year * 366 + timeinfo.tm_yday;
+  if (_urlDay[slot] != day) {
+    _urls[slot] = UrlHelper::replaceDatePlaceholders(config.url);
+    _urlDay[slot] = day;
+  }
+  return _urls[slot];
+}
 
+unsigned long SensorModule::nextDelay(int slot, unsigned long baseInterval) {
+  if (_failures[slot] > 0)
+    return RetryPolicy::backoff(baseInterval, _failures[slot],
+                                MAX_ERROR_BACKOFF);
+
+  uint8_t shift =
+      min<uint8_t>(_stableRuns[slot] / STABLE_RUNS_PER_STEP, MAX_STABLE_SHIFT);
+  // Compared before shifting: long intervals would wrap past 32 bits
+  if (baseInterval > MAX_STABLE_DELAY >> shift)
+    return max(baseInterval, MAX_STABLE_DELAY);
+  return baseInterval << shift;
+}
+
+void SensorModule::onConfigChange(const ConfigChange &change) {
+  const ConfigSnapshot &snap = _config->current();
   for (int slot = 0; slot < 8; slot++) {
-    String key = "sensor_" + String(_startSlot + slot);
-    SensorConfig config;
-    JsonDocument sDoc;
-    if (_config->get(key.c_str(), sDoc)) {
-      SensorConfigHelper::fromJson(sDoc.as<JsonVariantConst>(), config);
+    uint16_t bit = 1u << (_startSlot + slot);
+    if (change.refetch & bit) {
+      _generation[slot]++;       // A fetch in flight is for the old source
+      _revalidate[slot] = false; // Its validators would answer with a 304
+      _urlDay[slot] = -1;
+      sensorHistory.clear(_startSlot + slot);
+      _nextFetch[slot] = 0;
+      _failures[slot] = 0;
+      _stableRuns[slot] = 0;
+    } else if ((change.relabel & bit) && _hasData[slot]) {
+      // Same source: keep the value, only its presentation changes
+      const SensorConfig &config = snap.sensors[_startSlot + slot];
+      _labels[slot] = config.label;
+      _units[slot] = config.unit;
+      _decimals[slot] = config.decimals;
+      _relabeled |= 1 << slot;
+    }
+  }
+  if (change.layout)
+    _needsRender = true;
+}
+
+// Runs on the main loop with a result from the fetch task
+void SensorModule::onFetchResult(const FetchResult &result) {
+  int slot = result.slot - _startSlot;
+  if (slot < 0 || slot >= 8)
+    return;
+  _inFlight[slot] = false;
+  networkWindow.release();
+  if (result.tag != _generation[slot])
+    return; // Source changed meanwhile, _nextFetch is already 0
+
+  const ConfigSnapshot &snap = _config->current();
+  const SensorConfig &config = snap.sensors[result.slot];
+  FetchStatus status = result.status;
+  _polled = true;
+
+  unsigned long baseInterval = config.interval > 0
+                                   ? max(config.interval, 10) * 1000UL
+                                   : _updateInterval;
+  // The first value from a new source is shown even if close to the old one
+  bool significant =
+      status == FetchStatus::OK &&
+      (!_revalidate[slot] || isSignificant(slot, config, result.value));
+  if (status == FetchStatus::OK) {
+    _revalidate[slot] = true;
+    // Every reading, shown or not
+    sensorHistory.push(result.slot, result.value, config.decimals);
+  }
+
+  if (status == FetchStatus::FAILED) {
+    if (_failures[slot] < 255)
+      _failures[slot]++;
+    if (_hasData[slot])
+      markStale(slot, SensorDisplay::formatAge(millis() - _goodAt[slot]));
+  } else {
+    _failures[slot] = 0;
+    _goodAt[slot] = millis();
+    markStale(slot, SensorDisplay::Age());
+    if (significant)
+      _stableRuns[slot] = 0;
+    else if (_stableRuns[slot] < 255)
+      _stableRuns[slot]++;
+  }
+
+  unsigned long delayMs = nextDelay(slot, baseInterval);
+  _nextFetch[slot] = millis() + delayMs;
+  Serial.printf("[SensorModule] Slot %d (%s): status %d in %lums, next in "
+                "%lus\n",
+                result.slot, config.label.c_str(), (int)status,
+                (unsigned long)result.fetchMs, delayMs / 1000);
+
+  if (status == FetchStatus::NOT_MODIFIED && _hasData[slot]) {
+    // Unchanged upstream: keep the cached value, no parse, no render
+    return;
+  }
+
+  if (status == FetchStatus::OK && !significant) {
+    // Keep showing the previous value, the panel stays untouched
+    _suppressed = true;
+    return;
+  }
+
+  if (status == FetchStatus::OK) {
+    _values[slot] = result.value;
+    _labels[slot] = config.label;
+    _units[slot] = config.unit;
+    _decimals[slot] = config.decimals;
+    _hasData[slot] = true;
+    _changed = true;
+    telemetry.publishValue(result.slot, result.value);
+
+    struct tm timeinfo;
+    if (TimeHelper::getLocalTime(&timeinfo)) {
+      _lastUpdateTimes[slot].format("%02d:%02d", timeinfo.tm_hour,
+                                    timeinfo.tm_min);
+      if (_display)
+        _display->setLastUpdate(_lastUpdateTimes[slot].c_str());
     }
+  }
+}
+
+void SensorModule::update() {
+  const ConfigSnapshot &snap = _config->current();
+  _updateInterval = max(snap.system.sensorInterval, 10) * 1000UL;
+
+  unsigned long now = millis();
+
+  for (int slot = 0; slot < 8; slot++) {
+    if (_inFlight[slot])
+      continue;
+
+    const SensorConfig &config = snap.sensors[_startSlot + slot];
 
     if (config.enabled && !config.url.isEmpty()) {
-      Serial.println("[SensorModule] Updating slot " +
-                     String(_startSlot + slot) + ": " + config.label);
-
-      float value = 0;
-      bool success = false;
-      String finalUrl = UrlHelper::replaceDatePlaceholders(config.url);
-
-      if (config.type == "prometheus") {
-        PrometheusResult res;
-        if (PrometheusFetcher::fetch(finalUrl, config.divisor, config.decimals,
-                                     res)) {
-          value = res.value.toFloat();
-          success = res.valid;
-        }
-      } else {
-        JsonFetcherResult res;
-        if (JsonFetcher::fetch(finalUrl, config.jsonPath, config.divisor,
-                               config.decimals, res)) {
-          value = res.value.toFloat();
-          success = res.success;
-        }
+      // Due (or close enough to join the current network burst)
+      if (!networkWindow.admit(_nextFetch[slot], _burst[slot]))
+        continue;
+
+      const String &url = expandedUrl(slot, config);
+      if (url.length() > FetchRequest::MAX_URL) {
+        Serial.printf("[SensorModule] Slot %d: URL longer than %u bytes\n",
+                      _startSlot + slot, (unsigned)FetchRequest::MAX_URL);
+        _nextFetch[slot] = now + _updateInterval;
+        continue;
       }
 
-      if (success) {
-        _values[slot] = value;
-        _labels[slot] = config.label;
-        _units[slot] = config.unit;
-        _decimals[slot] = config.decimals;
-        _hasData[slot] = true;
-
-        struct tm timeinfo;
-        if (TimeHelper::getLocalTime(&timeinfo)) {
-          char timeStr[6];
-          snprintf(timeStr, sizeof(timeStr), "%02d:%02d", timeinfo.tm_hour,
-                   timeinfo.tm_min);
-          _lastUpdateTimes[slot] = String(timeStr);
-          if (_display) {
-            _display->setLastUpdate(String(timeStr));
-
-            // Refresh daily at 3 AM
-            if (timeinfo.tm_hour == 3 &&
-                _lastFullRefreshDay != timeinfo.tm_mday) {
-              _display->update(true); // Full refresh
-              _lastFullRefreshDay = timeinfo.tm_mday;
-              Serial.println("[SensorModule] Daily full refresh triggered");
-            } else {
-              _display->update(false); // Partial refresh
-            }
-          }
-        }
+      // The fetch task answers through onFetchResult()
+      FetchRequest request;
+      request.slot = _startSlot + slot;
+      request.tag = _generation[slot];
+      request.url = url;
+      request.source.prometheus = config.type == "prometheus";
+      request.source.divisor = config.divisor;
+      request.source.path = snap.jsonPaths[_startSlot + slot];
+      request.conditional = _revalidate[slot];
+      // A full ring is retried on the next pass
+      if (fetchWorker.submit(request)) {
+        _inFlight[slot] = true;
+        networkWindow.hold(); // The burst stays open until the result
       }
-    } else {
+    } else if (_nextFetch[slot] == 0 ||
+               (long)(now - _nextFetch[slot]) >= 0) {
       // Clear data for disabled/empty slots
+      _polled = true;
+      _nextFetch[slot] = now + _updateInterval;
       _values[slot] = 0;
-      _labels[slot] = "";
-      _units[slot] = "";
+      _labels[slot].clear();
+      _units[slot].clear();
       _decimals[slot] = 0;
+      if (_hasData[slot])
+        _changed = true;
       _hasData[slot] = false;
+      _revalidate[slot] = false;
+      _staleAge[slot].clear();
+      sensorHistory.clear(_startSlot + slot);
     }
   }
 
+  // Hold the frame while a slot without data is still being fetched, so
+  // the panel does not flash "--" first
+  for (int slot = 0; slot < 8; slot++) {
+    if (_inFlight[slot] && !_hasData[slot])
+      return;
+  }
+
+  bool polled = _polled;
+  bool changed = _changed;
+  bool suppressed = _suppressed;
+  _polled = _changed = _suppressed = false;
+
+  if (!polled && !_needsRender && !_relabeled)
+    return;
+
   // Final display update with ALL data (8 sensors)
+  struct tm timeinfo;
+  bool haveTime = TimeHelper::getLocalTime(&timeinfo);
+  bool fullRefreshDue = haveTime && timeinfo.tm_hour == 3 &&
+                        _lastFullRefreshDay != timeinfo.tm_mday;
+
+  bool cellsOnly = !changed && !_needsRender && !fullRefreshDue;
+  if (cellsOnly && !_relabeled) {
+    if (suppressed) {
+      uint32_t total = ++_suppressedRefreshes;
+      Serial.printf("[SensorModule] Refresh suppressed (%lu total)\n",
+                    (unsigned long)total);
+    }
+    return;
+  }
+
   if (_display) {
-    auto getValueStr = [&](int slot) {
-      return _hasData[slot] ? String(_values[slot], _decimals[slot]) : "--";
-    };
-
-    _display->setData({_labels[0], getValueStr(0), _units[0]},
-                      {_labels[1], getValueStr(1), _units[1]},
-                      {_labels[2], getValueStr(2), _units[2]},
-                      {_labels[3], getValueStr(3), _units[3]},
-                      {_labels[4], getValueStr(4), _units[4]},
-                      {_labels[5], getValueStr(5), _units[5]},
-                      {_labels[6], getValueStr(6), _units[6]},
-                      {_labels[7], getValueStr(7), _units[7]});
-
-    _display->setStyle(_config->get("sens_style", 0));
-    _display->update(false);
+    SensorDisplay::Value value;
+    for (int slot = 0; slot < 8; slot++) {
+      if (_hasData[slot])
+        value.format(_values[slot], _decimals[slot]);
+      else
+        value = "--";
+      _display->setCell(slot, _labels[slot].c_str(), value.c_str(),
+                        _units[slot].c_str());
+      bool spark = _hasData[slot] && snap.sensors[_startSlot + slot].sparkline;
+      _display->setSparkline(slot, spark ? _startSlot + slot : -1);
+      _display->setCellStaleAge(slot, _staleAge[slot].c_str());
+    }
+
+    _display->setStyle(snap.system.sensorStyle);
+
+    if (cellsOnly) {
+      refreshCells(_display, _relabeled); // Only the relabeled cells
+    } else if (fullRefreshDue) { // Refresh daily at 3 AM
+      refresh(_display, true); // Full refresh
+      _lastFullRefreshDay = timeinfo.tm_mday;
+      Serial.println("[SensorModule] Daily full refresh triggered");
+    } else {
+      refresh(_display, false); // Partial refresh
+    }
+    _needsRender = false;
+    _relabeled = 0;
   }
 }
@@ -1,90 +1,90 @@
 #ifndef SENSOR_MODULE_H
 #define SENSOR_MODULE_H
 
+#include "../config/SensorConfig.h"
 #include "../displays/SensorDisplay.h"
 #include "BaseModule.h"
-#include <ArduinoJson.h>
-
-struct SensorConfig {
-  String label;  // Label displayed on screen (e.g., "Conso. EDF")
-  String url;    // Full URL (Prometheus query or JSON API)
-  String unit;   // Unit of measurement (e.g., "kWh", "°C", "W")
-  float divisor; // Conversion divisor (e.g., 1000 for Wh → kWh)
-  int decimals;  // Number of decimals to display (0-2)
-  bool enabled;  // Whether this sensor is active
-  String type;   // "prometheus" or "json"
-  String
-      jsonPath; // Path based on simple dot/check notation (e.g. data.values[0])
-
-  SensorConfig()
-      : label(""), url(""), unit(""), divisor(1.0), decimals(1), enabled(false),
-        type("prometheus"), jsonPath("") {}
-};
-
-class SensorConfigHelper {
-public:
-  static void fromJson(JsonVariantConst src, SensorConfig &dest) {
-    dest.label = src["label"] | "";
-    dest.url = src["url"] | "";
-    dest.unit = src["unit"] | "";
-    dest.divisor = src["divisor"] | 1.0f;
-    dest.decimals = src["decimals"] | 1;
-    dest.enabled = src["enabled"] | false;
-    dest.type = src["type"] | "prometheus";
-    dest.jsonPath = src["jsonPath"] | "";
-  }
-
-  static void toJson(const SensorConfig &src, JsonVariant dest) {
-    dest["label"] = src.label;
-    dest["url"] = src.url;
-    dest["unit"] = src.unit;
-    dest["divisor"] = src.divisor;
-    dest["decimals"] = src.decimals;
-    dest["enabled"] = src.enabled;
-    dest["type"] = src.type;
-    dest["jsonPath"] = src.jsonPath;
-  }
-};
+#include <atomic>
 
 class SensorModule : public BaseModule {
 public:
-  SensorModule(String name, int startSlot);
+  SensorModule(const char *name, int startSlot);
 
-  String getName() override { return _moduleName; }
+  const char *getName() override { return _moduleName; }
 
   int getRequiredScreenCount() override { return 1; }
   ScreenType getRequiredScreenType(int index) override {
     return SCREEN_TYPE_BW;
   }
 
-  void assignScreen(int index, BaseDisplay *display) override;
+  void assignScreen(int index, Panel *panel) override;
 
-  void begin() override;
   void update() override;
   void forceUpdate() override {
-    _lastUpdate = 0;
+    for (int i = 0; i < 8; i++) {
+      _nextFetch[i] = 0;
+      _failures[i] = 0;
+      _stableRuns[i] = 0;
+    }
     _lastFullRefreshDay = -1;
+    _needsRender = true;
   }
+  void onConfigChange(const ConfigChange &change) override;
+  void onFetchResult(const FetchResult &result) override;
+  void redraw() override { _needsRender = true; }
 
-  void setRefreshInterval(unsigned long interval) {
-    _updateInterval = interval;
-  }
+  // Panel refreshes skipped because no value moved enough (all instances)
+  static uint32_t suppressedRefreshes() { return _suppressedRefreshes.load(); }
 
 private:
+  // View drawn on the assigned panel; _display is nullptr while unassigned
+  SensorDisplay _view;
   SensorDisplay *_display = nullptr;
-  String _moduleName;
+  const char *_moduleName;
   int _startSlot;
 
   float _values[8] = {0, 0, 0, 0, 0, 0, 0, 0};
   bool _hasData[8] = {false, false, false, false, false, false, false, false};
-  String _labels[8] = {"", "", "", "", "", "", "", ""};
-  String _units[8] = {"", "", "", "", "", "", "", ""};
+  SensorDisplay::Label _labels[8];
+  SensorDisplay::Unit _units[8];
   int _decimals[8] = {0, 0, 0, 0, 0, 0, 0, 0};
-  String _lastUpdateTimes[8] = {"", "", "", "", "", "", "", ""};
+  FixedString<5> _lastUpdateTimes[8]; // "HH:MM"
+
+  // Last good reading per slot; a failing slot keeps showing its value,
+  // marked with its age
+  unsigned long _goodAt[8] = {};
+  SensorDisplay::Age _staleAge[8];
+
+  // Per-slot scheduling (0 = due now)
+  unsigned long _nextFetch[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  uint8_t _failures[8] = {0, 0, 0, 0, 0, 0, 0, 0};   // Consecutive errors
+  uint8_t _stableRuns[8] = {0, 0, 0, 0, 0, 0, 0, 0}; // Unchanged fetches
+  bool _inFlight[8] = {};       // Submitted to the fetch task, no result yet
+  uint32_t _generation[8] = {}; // Bumped when the slot's source changes
+  uint32_t _burst[8] = {};      // Network burst of the last fetch
+  bool _revalidate[8] = {};     // Value from the current source, send ETags
+
+  // config.url with its date placeholders replaced, for the local day in
+  // _urlDay (-1: expand again)
+  String _urls[8];
+  int _urlDay[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
+
+  // Results since the last render decision
+  bool _polled = false;
+  bool _changed = false;
+  bool _suppressed = false;
 
   int _lastFullRefreshDay = -1;
-  unsigned long _lastUpdate = 0;
-  unsigned long _updateInterval = 60000; // Default 1 minute
+  bool _needsRender = true; // Redraw even if every slot answered 304
+  uint8_t _relabeled = 0;   // Cells to redraw for presentation changes only
+  unsigned long _updateInterval = 60000; // From system sensorInterval
+
+  static std::atomic<uint32_t> _suppressedRefreshes; // Read from BLE task
+
+  unsigned long nextDelay(int slot, unsigned long baseInterval);
+  bool isSignificant(int slot, const SensorConfig &config, float value);
+  void markStale(int slot, const SensorDisplay::Age &age);
+  const String &expandedUrl(int slot, const SensorConfig &config);
 };
 
 #endif
@@ -0,0 +1,75 @@
+#include "FetchWorker.h"
+
+FetchWorker fetchWorker;
+
+// HTTPS handshakes need the larger stack
+static const uint32_t TASK_STACK = 12288;
+static const UBaseType_t TASK_PRIORITY = 1; // Same as loopTask
+
+bool FetchWorker::begin() {
+  if (_task)
+    return true;
+  if (xTaskCreate(taskEntry, "fetch", TASK_STACK, this, TASK_PRIORITY,
+                  &_task) != pdPASS) {
+    Serial.println("[FetchWorker] Failed to start task");
+    _task = nullptr;
+    return false;
+  }
+  Serial.println("[FetchWorker] Started");
+  return true;
+}
+
+bool FetchWorker::submit(FetchRequest &request) {
+  if (!_task)
+    return false;
+  request.queuedAt = millis();
+  if (!_requests.push(request)) {
+    _stats.rejected++;
+    return false;
+  }
+  _stats.maxDepth = max(_stats.maxDepth.load(), _requests.size());
+  xTaskNotifyGive(_task);
+  return true;
+}
+
+bool FetchWorker::poll(FetchResult &result) {
+  if (!_results.pop(result))
+    return false;
+
+  uint32_t latency = millis() - result.queuedAt;
+  uint32_t completed = ++_stats.completed;
+  _latencySum += latency;
+  _stats.avgLatencyMs = _latencySum / completed;
+  _stats.maxLatencyMs = max(_stats.maxLatencyMs.load(), latency);
+  _stats.maxFetchMs = max(_stats.maxFetchMs.load(), result.fetchMs);
+  return true;
+}
+
+void FetchWorker::taskEntry(void *arg) {
+  static_cast<FetchWorker *>(arg)->run();
+}
+
+void FetchWorker::run() {
+  FetchRequest request;
+  for (;;) {
+    if (!_requests.pop(request)) {
+      // Woken by submit(); the timeout only guards against a lost wakeup
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+      continue;
+    }
+
+    FetchResult result;
+    result.slot = request.slot;
+    result.tag = request.tag;
+    result.queuedAt = request.queuedAt;
+    unsigned long start = millis();
+    result.status =
+        SensorFetcher::fetch(request.slot, request.url.c_str(), request.source,
+                             request.conditional, result.value);
+    result.fetchMs = millis() - start;
+
+    // Cannot stay full for long: the main loop drains it every pass
+    while (!_results.push(result))
+      vTaskDelay(pdMS_TO_TICKS(10));
+  }
+}
@@ -0,0 +1,72 @@
+#ifndef FETCH_WORKER_H
+#define FETCH_WORKER_H
+
+#include "../FixedString.h"
+#include "SensorFetcher.h"
+#include "SpscQueue.h"
+#include <Arduino.h>
+#include <atomic>
+
+// Built on the main loop every time a slot is due: inline, no heap
+struct FetchRequest {
+  static const size_t MAX_URL = 511;
+
+  int slot = -1;            // Global sensor slot
+  uint32_t tag = 0;         // Opaque to the worker, echoed in the result
+  FixedString<MAX_URL> url; // Placeholders already replaced
+  FetchSource source;
+  bool conditional = false; // Send stored validators (a 304 keeps the value)
+  unsigned long queuedAt = 0;
+};
+
+struct FetchResult {
+  int slot = -1;
+  uint32_t tag = 0;
+  FetchStatus status = FetchStatus::FAILED;
+  float value = 0;
+  unsigned long queuedAt = 0;
+  uint32_t fetchMs = 0; // Time spent in the HTTP request itself
+};
+
+// Runs sensor fetches on a dedicated FreeRTOS task so a slow endpoint no
+// longer stalls the main loop (rendering, BLE, timeouts). The main loop
+// submits requests and polls results through two SPSC rings; it is the
+// only producer of requests and the only consumer of results.
+class FetchWorker {
+public:
+  // One request in flight per sensor slot fits in either ring
+  static const size_t DEPTH = 16;
+
+  // Written on the main loop only, read by get_stats on the BLE task
+  struct Stats {
+    std::atomic<uint32_t> completed{0};
+    std::atomic<uint32_t> rejected{0};     // submit() on a full ring
+    std::atomic<size_t> maxDepth{0};       // Request ring high-water mark
+    std::atomic<uint32_t> maxLatencyMs{0}; // submit() -> poll()
+    std::atomic<uint32_t> avgLatencyMs{0};
+    std::atomic<uint32_t> maxFetchMs{0};
+  };
+
+  bool begin();
+
+  // Main loop side
+  bool submit(FetchRequest &request);
+  bool poll(FetchResult &result);
+  size_t depth() const { return _requests.size(); }
+  const Stats &stats() const { return _stats; }
+
+private:
+  SpscQueue<FetchRequest, DEPTH> _requests; // Main loop -> worker
+  SpscQueue<FetchResult, DEPTH> _results;   // Worker -> main loop
+  TaskHandle_t _task = nullptr;
+
+  Stats _stats;
+  uint64_t _latencySum = 0;
+
+  static void taskEntry(void *arg);
+  void run();
+};
+
+extern FetchWorker fetchWorker;
+
+#endif
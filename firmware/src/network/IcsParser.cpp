@@ -0,0 +1,461 @@
+#include "IcsParser.h"
+#include "../SolarCalculator.h"
+
+static const char *WEEKDAYS[7] = {"MO", "TU", "WE", "TH", "FR", "SA", "SU"};
+
+static long floorMod(long a, long b) {
+  long r = a % b;
+  return r < 0 ? r + b : r;
+}
+
+// 0 = Monday; day 0 (1970-01-01) was a Thursday
+static int weekday(long day) {
+  return floorMod(day + 3, 7);
+}
+
+static long daysInMonth(int year, int month) {
+  long first = SolarCalculator::daysFromCivil(year, month, 1);
+  return month == 12 ? SolarCalculator::daysFromCivil(year + 1, 1, 1) - first
+                     : SolarCalculator::daysFromCivil(year, month + 1, 1) -
+                           first;
+}
+
+static uint32_t hashUid(const char *s) {
+  uint32_t h = 2166136261u; // FNV-1a
+  while (*s)
+    h = (h ^ (uint8_t)*s++) * 16777619u;
+  return h;
+}
+
+// Unescapes a TEXT value into out, never ending on a partial UTF-8
+// sequence when truncated
+static void copyText(char *out, size_t cap, const char *in) {
+  size_t n = 0;
+  for (; *in && n + 1 < cap; in++) {
+    char c = *in;
+    if (c == '\\' && in[1]) {
+      c = *++in;
+      if (c == 'n' || c == 'N')
+        c = ' ';
+    }
+    out[n++] = c;
+  }
+  if (*in && n > 0) {
+    size_t lead = n - 1;
+    while (lead > 0 && ((uint8_t)out[lead] & 0xC0) == 0x80)
+      lead--;
+    uint8_t b = out[lead];
+    size_t len = b >= 0xF0 ? 4 : b >= 0xE0 ? 3 : b >= 0xC0 ? 2 : 1;
+    if (lead + len > n)
+      n = lead;
+  }
+  out[n] = '\0';
+}
+
+int IcsParser::upcoming(Stream &stream, time_t from, time_t to,
+                        Occurrence *out, int max) {
+  max = constrain(max, 0, MAX_EVENTS);
+  IcsParser parser(stream, from, to, max);
+  bool calendar = false;
+
+  while (parser.readLine()) {
+    char *line = parser._line;
+    if (!calendar) {
+      if (!strncmp(line, "\xEF\xBB\xBF", 3)) // UTF-8 BOM
+        line += 3;
+      if (!*line)
+        continue;
+      if (strcasecmp(line, "BEGIN:VCALENDAR"))
+        return -1; // An error page, not a calendar
+      calendar = true;
+      continue;
+    }
+    if (!strcasecmp(line, "END:VCALENDAR"))
+      break;
+
+    // NAME;PARAM=...:VALUE, a ':' inside a quoted parameter is not the end
+    char *value = line;
+    bool quoted = false;
+    while (*value && (quoted || *value != ':')) {
+      if (*value == '"')
+        quoted = !quoted;
+      value++;
+    }
+    if (!*value)
+      continue;
+    *value++ = '\0';
+    char *params = strchr(line, ';');
+    if (params)
+      *params = '\0'; // TZID is taken as local time, VALUE from the text
+
+    if (!strcasecmp(line, "BEGIN")) {
+      if (parser._inEvent) {
+        parser._depth++; // VALARM: its properties are not the event's
+      } else if (!strcasecmp(value, "VEVENT")) {
+        parser._event = Event{};
+        parser._event.interval = 1;
+        parser._inEvent = true;
+      }
+    } else if (!strcasecmp(line, "END")) {
+      if (parser._inEvent && parser._depth > 0)
+        parser._depth--;
+      else if (parser._inEvent && !strcasecmp(value, "VEVENT"))
+        parser.endEvent();
+    } else if (parser._inEvent && parser._depth == 0) {
+      parser.property(line, value);
+    }
+  }
+  if (!calendar)
+    return -1;
+
+  // Heap order to start order, without the spare slots
+  int count = 0;
+  for (int i = 0; i < parser._heapSize; i++) {
+    const Occurrence &occ = parser._heap[i];
+    int j = count;
+    while (j > 0 && out[j - 1].start > occ.start) {
+      if (j < max)
+        out[j] = out[j - 1];
+      j--;
+    }
+    if (j < max) {
+      out[j] = occ;
+      count = min(count + 1, max);
+    }
+  }
+  return count;
+}
+
+// Makes sure _buf[_pos] is valid; false at end of stream or timeout
+bool IcsParser::fill() {
+  if (_pos < _len)
+    return true;
+  // Take what is buffered, or block (stream timeout) for one byte
+  size_t want = constrain(_stream.available(), 1, (int)sizeof(_buf));
+  _len = _stream.readBytes(_buf, want);
+  _pos = 0;
+  return _len > 0;
+}
+
+// Next content line with folding undone; false at end of stream
+bool IcsParser::readLine() {
+  size_t n = 0;
+  bool any = false;
+  while (fill()) {
+    any = true;
+    char c = _buf[_pos++];
+    if (c == '\r')
+      continue;
+    if (c != '\n') {
+      if (n + 1 < sizeof(_line))
+        _line[n++] = c;
+      continue;
+    }
+    // Nothing follows the last line: do not wait for a fold
+    if (n == 13 && !strncasecmp(_line, "END:VCALENDAR", 13))
+      break;
+    if (!fill() || (_buf[_pos] != ' ' && _buf[_pos] != '\t'))
+      break;
+    _pos++; // Folded: the line goes on after the blank
+  }
+  _line[n] = '\0';
+  return any;
+}
+
+void IcsParser::property(char *name, char *value) {
+  Event &e = _event;
+  if (!strcasecmp(name, "UID")) {
+    e.uid = hashUid(value);
+  } else if (!strcasecmp(name, "SUMMARY")) {
+    copyText(e.summary, sizeof(e.summary), value);
+  } else if (!strcasecmp(name, "DTSTART")) {
+    parseMoment(value, e.start);
+  } else if (!strcasecmp(name, "RECURRENCE-ID")) {
+    parseMoment(value, e.recurrenceId);
+  } else if (!strcasecmp(name, "STATUS")) {
+    e.cancelled = !strcasecmp(value, "CANCELLED");
+  } else if (!strcasecmp(name, "EXDATE")) {
+    char *rest = value;
+    char *item;
+    while ((item = strtok_r(rest, ",", &rest)) &&
+           e.exdateCount < MAX_EXDATES) {
+      Moment m;
+      if (parseMoment(item, m))
+        e.exdates[e.exdateCount++] = toTime(m);
+    }
+  } else if (!strcasecmp(name, "RRULE")) {
+    char *rest = value;
+    char *part;
+    while ((part = strtok_r(rest, ";", &rest))) {
+      char *arg = strchr(part, '=');
+      if (!arg)
+        continue;
+      *arg++ = '\0';
+      if (!strcasecmp(part, "FREQ")) {
+        e.freq = !strcasecmp(arg, "DAILY")     ? DAILY
+                 : !strcasecmp(arg, "WEEKLY")  ? WEEKLY
+                 : !strcasecmp(arg, "MONTHLY") ? MONTHLY
+                 : !strcasecmp(arg, "YEARLY")  ? YEARLY
+                                               : NONE; // Sub-daily: once
+      } else if (!strcasecmp(part, "INTERVAL")) {
+        e.interval = max(atoi(arg), 1);
+      } else if (!strcasecmp(part, "COUNT")) {
+        e.count = max(atoi(arg), 0);
+      } else if (!strcasecmp(part, "UNTIL")) {
+        parseMoment(arg, e.until);
+      } else if (!strcasecmp(part, "BYMONTHDAY")) {
+        e.monthDay = constrain(atoi(arg), -31, 31); // First value only
+      } else if (!strcasecmp(part, "BYDAY")) {
+        char *days = arg;
+        char *day;
+        while ((day = strtok_r(days, ",", &days))) {
+          char *code;
+          long n = strtol(day, &code, 10);
+          for (int wd = 0; wd < 7; wd++) {
+            if (!strncasecmp(code, WEEKDAYS[wd], 2))
+              e.weekdays |= 1 << wd;
+          }
+          if (n != 0 && e.ordinal == 0)
+            e.ordinal = constrain(n, -5, 5);
+        }
+      }
+    }
+  }
+}
+
+void IcsParser::endEvent() {
+  _inEvent = false;
+  const Event &e = _event;
+  if (!e.start.valid)
+    return;
+
+  if (e.recurrenceId.valid) {
+    // One instance of a series, moved, edited or cancelled
+    exclude(e.uid, toTime(e.recurrenceId));
+    if (!e.cancelled)
+      offer(toTime(e.start), true);
+  } else if (!e.cancelled) {
+    if (e.freq == NONE)
+      offer(toTime(e.start), false);
+    else
+      expand();
+  }
+}
+
+void IcsParser::expand() {
+  const Event &e = _event;
+  long d0 = e.start.day;
+  int y0, m0, md0;
+  SolarCalculator::civilFromDays(d0, y0, m0, md0);
+  long weekStart = d0 - weekday(d0);
+  uint8_t weekdays = e.weekdays ? e.weekdays : 1 << weekday(d0);
+
+  time_t until = 0;
+  if (e.until.valid)
+    until = e.until.date ? toTime(e.until.day, 86399, false) : toTime(e.until);
+
+  // Rules with one instance per period can skip whole periods and still
+  // keep COUNT right; others walk from DTSTART when COUNT is set
+  bool single;
+  switch (e.freq) {
+  case WEEKLY:
+    single = weekdays == 1 << weekday(d0);
+    break;
+  case MONTHLY:
+    single = e.ordinal ? (e.ordinal >= -1 && e.ordinal <= 4)
+                       : (e.monthDay ? e.monthDay : md0) <= 28;
+    break;
+  case YEARLY:
+    single = !(m0 == 2 && md0 == 29);
+    break;
+  default:
+    single = true;
+  }
+
+  long period = 0;
+  if (!e.count || single) {
+    // Periods wholly before the window (local days may be a day off UTC)
+    long fromDay = (long)(_from / 86400) - 2;
+    int fy, fm, fd;
+    SolarCalculator::civilFromDays(fromDay, fy, fm, fd);
+    switch (e.freq) {
+    case DAILY:
+      period = (fromDay - d0) / e.interval;
+      break;
+    case WEEKLY:
+      period = (fromDay - weekStart) / (7 * e.interval);
+      break;
+    case MONTHLY:
+      period = ((fy - y0) * 12 + fm - m0 - 1) / e.interval;
+      break;
+    default:
+      period = (fy - y0 - 1) / e.interval;
+    }
+    period = max(period, 0L);
+  }
+  long counted = single ? period : 0;
+
+  for (long end = period + MAX_PERIODS; period < end; period++) {
+    long days[7];
+    int n = 0;
+    long step = period * e.interval;
+    if (e.freq == DAILY) {
+      days[n++] = d0 + step;
+    } else if (e.freq == WEEKLY) {
+      for (int wd = 0; wd < 7; wd++) {
+        if (weekdays & (1 << wd))
+          days[n++] = weekStart + 7 * step + wd;
+      }
+    } else {
+      long month = (long)y0 * 12 + (m0 - 1) + (e.freq == MONTHLY ? step : 0);
+      int year = e.freq == YEARLY ? y0 + step : month / 12;
+      int mon = e.freq == YEARLY ? m0 : month % 12 + 1;
+      long first = SolarCalculator::daysFromCivil(year, mon, 1);
+      long length = daysInMonth(year, mon);
+      long mday;
+      if (e.freq == MONTHLY && e.ordinal) {
+        int target = 0;
+        while (target < 6 && !(weekdays & (1 << target)))
+          target++;
+        long last = first + length - 1;
+        long day;
+        if (e.ordinal > 0)
+          day = first + floorMod(target - weekday(first), 7) +
+                7 * (e.ordinal - 1);
+        else
+          day = last - floorMod(weekday(last) - target, 7) +
+                7 * (e.ordinal + 1);
+        mday = day - first + 1;
+      } else {
+        mday = (e.freq == MONTHLY && e.monthDay) ? e.monthDay : md0;
+        if (mday < 0)
+          mday += length + 1;
+      }
+      if (mday >= 1 && mday <= length)
+        days[n++] = first + mday - 1;
+    }
+
+    for (int i = 0; i < n; i++) {
+      if (days[i] < d0)
+        continue;
+      if (e.count && ++counted > e.count)
+        return;
+      time_t start = toTime(days[i], e.start.seconds, e.start.utc);
+      if ((until && start > until) || start >= _to)
+        return;
+      bool skipped = false;
+      for (uint8_t x = 0; x < e.exdateCount; x++)
+        skipped |= e.exdates[x] == start;
+      if (!skipped)
+        offer(start, false);
+    }
+  }
+}
+
+bool IcsParser::excluded(uint32_t uid, time_t start) const {
+  for (int i = 0; i < _excludedCount; i++) {
+    if (_excluded[i].uid == uid && _excluded[i].start == start)
+      return true;
+  }
+  return false;
+}
+
+// Drops an instance of a series, whether it was already read or comes
+// later. What the instance pushed out of the heap does not come back: the
+// spare slots cover the first SPARE removals.
+void IcsParser::exclude(uint32_t uid, time_t start) {
+  if (start < _from || start >= _to)
+    return; // Never offered anyway
+  if (_excludedCount < MAX_EXCLUDED)
+    _excluded[_excludedCount++] = {uid, start};
+
+  for (int i = 0; i < _heapSize; i++) {
+    if (_heap[i].uid == uid && _heap[i].start == start) {
+      _heap[i] = _heap[--_heapSize];
+      for (int j = _heapSize / 2 - 1; j >= 0; j--)
+        siftDown(j);
+      return;
+    }
+  }
+}
+
+void IcsParser::offer(time_t start, bool override) {
+  if (start < _from || start >= _to)
+    return;
+  if (!override && excluded(_event.uid, start))
+    return;
+  if (_heapSize == _capacity && start >= _heap[0].start)
+    return; // Later than everything kept
+
+  Occurrence occ;
+  occ.start = start;
+  occ.allDay = _event.start.date;
+  occ.uid = _event.uid;
+  memcpy(occ.summary, _event.summary, sizeof(occ.summary));
+
+  if (_heapSize == _capacity) {
+    _heap[0] = occ;
+    siftDown(0);
+    return;
+  }
+  int i = _heapSize++;
+  while (i > 0 && _heap[(i - 1) / 2].start < start) {
+    _heap[i] = _heap[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  _heap[i] = occ;
+}
+
+void IcsParser::siftDown(int i) {
+  for (;;) {
+    int largest = i;
+    int l = 2 * i + 1;
+    int r = l + 1;
+    if (l < _heapSize && _heap[l].start > _heap[largest].start)
+      largest = l;
+    if (r < _heapSize && _heap[r].start > _heap[largest].start)
+      largest = r;
+    if (largest == i)
+      return;
+    Occurrence tmp = _heap[i];
+    _heap[i] = _heap[largest];
+    _heap[largest] = tmp;
+    i = largest;
+  }
+}
+
+// 20260314, 20260314T093000 or 20260314T093000Z
+bool IcsParser::parseMoment(const char *value, Moment &out) {
+  int year, month, mday, hour = 0, minute = 0, second = 0, n = 0;
+  if (sscanf(value, "%4d%2d%2d%n", &year, &month, &mday, &n) != 3 || n != 8)
+    return false;
+  const char *rest = value + 8;
+  out.date = *rest != 'T'; // VALUE=DATE
+  if (!out.date &&
+      sscanf(rest, "T%2d%2d%2d", &hour, &minute, &second) != 3)
+    return false;
+  out.day = SolarCalculator::daysFromCivil(year, month, mday);
+  out.seconds = hour * 3600L + minute * 60 + second;
+  out.utc = !out.date && rest[7] == 'Z';
+  out.valid = true;
+  return true;
+}
+
+time_t IcsParser::toTime(long day, long seconds, bool utc) {
+  if (utc)
+    return (time_t)day * 86400 + seconds;
+  struct tm local = {};
+  SolarCalculator::civilFromDays(day, local.tm_year, local.tm_mon,
+                                 local.tm_mday);
+  local.tm_year -= 1900;
+  local.tm_mon -= 1;
+  local.tm_hour = seconds / 3600;
+  local.tm_min = seconds / 60 % 60;
+  local.tm_sec = seconds % 60;
+  local.tm_isdst = -1;
+  return mktime(&local);
+}
+
+time_t IcsParser::toTime(const Moment &m) {
+  return toTime(m.day, m.seconds, m.utc);
+}
@@ -0,0 +1,112 @@
+#ifndef ICS_PARSER_H
+#define ICS_PARSER_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Pull parser for an iCalendar (RFC 5545) feed, read straight from the
+// socket one unfolded line at a time. Only the VEVENT being read is kept
+// (one line, a few EXDATEs) plus a fixed max-heap of the soonest
+// occurrences, so memory stays bounded whatever the calendar size.
+//
+// RRULEs are expanded only inside [from, to): DAILY, WEEKLY (BYDAY),
+// MONTHLY (BYMONTHDAY or one ordinal BYDAY such as 2TU or -1FR) and
+// YEARLY, with INTERVAL, COUNT and UNTIL. Rules without COUNT jump
+// straight to the window instead of walking from DTSTART. RECURRENCE-ID
+// overrides and cancelled instances replace or drop the occurrence they
+// name. TZID times are taken as device local time (no tz database).
+class IcsParser {
+public:
+  static const int MAX_EVENTS = 8;
+
+  struct Occurrence {
+    time_t start;
+    bool allDay;
+    uint32_t uid; // UID hash, matches overrides with their series
+    char summary[24];
+  };
+
+  // Writes the soonest occurrences starting in [from, to) to out (at most
+  // max, max <= MAX_EVENTS), sorted. Returns their count, or -1 when the
+  // body is not a calendar.
+  static int upcoming(Stream &stream, time_t from, time_t to,
+                      Occurrence *out, int max);
+
+private:
+  static const int MAX_EXDATES = 8;
+  static const int MAX_EXCLUDED = 16;
+  static const int SPARE = 4; // Kept beyond max, for overrides to remove
+  static const int MAX_PERIODS = 5000; // Expansion bound per event
+
+  enum Freq : uint8_t { NONE, DAILY, WEEKLY, MONTHLY, YEARLY };
+
+  // A DTSTART-like value: local or UTC wall time, or a date
+  struct Moment {
+    long day = 0; // SolarCalculator::daysFromCivil() number
+    long seconds = 0;
+    bool utc = false;
+    bool date = false;
+    bool valid = false;
+  };
+
+  struct Event {
+    uint32_t uid;
+    char summary[24];
+    Moment start;
+    Moment recurrenceId;
+    bool cancelled;
+    Freq freq;
+    int interval;
+    int count; // 0 = unbounded
+    Moment until;
+    uint8_t weekdays; // BYDAY mask, bit 0 = Monday
+    int8_t ordinal;   // MONTHLY BYDAY position, 0 = none
+    int8_t monthDay;  // BYMONTHDAY, 0 = DTSTART's day
+    time_t exdates[MAX_EXDATES];
+    uint8_t exdateCount;
+  };
+
+  struct Excluded {
+    uint32_t uid;
+    time_t start;
+  };
+
+  IcsParser(Stream &stream, time_t from, time_t to, int max)
+      : _stream(stream), _from(from), _to(to), _capacity(max + SPARE) {}
+
+  Stream &_stream;
+  time_t _from;
+  time_t _to;
+  int _capacity;
+
+  uint8_t _buf[64];
+  size_t _pos = 0;
+  size_t _len = 0;
+  char _line[160]; // Unfolded, truncated content line
+
+  Event _event;
+  int _depth = 0; // Nesting inside the VEVENT (VALARM...)
+  bool _inEvent = false;
+
+  Occurrence _heap[MAX_EVENTS + SPARE]; // Max-heap on start
+  int _heapSize = 0;
+  Excluded _excluded[MAX_EXCLUDED]; // Instances replaced by an override
+  int _excludedCount = 0;
+
+  bool fill();
+  bool readLine();
+  void property(char *name, char *value);
+  void endEvent();
+  void expand();
+
+  bool excluded(uint32_t uid, time_t start) const;
+  void exclude(uint32_t uid, time_t start);
+  void offer(time_t start, bool override);
+  void siftDown(int i);
+
+  static bool parseMoment(const char *value, Moment &out);
+  static time_t toTime(long day, long seconds, bool utc);
+  static time_t toTime(const Moment &m);
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "NetworkWindow.h"
+#include <WiFi.h>
+#include <esp-iot-utils.h>
+
+NetworkWindow networkWindow;
+
+static const unsigned long HOUR_MS = 3600000;
+
+void NetworkWindow::begin(ConfigStore &config, bool connected) {
+  _config = &config;
+  _tolerance = max(config.current().system.netTolerance, 0) * 1000UL;
+  _open = connected;
+  _bursts = connected ? 1 : 0; // The boot connection
+  _openedAt = _onSince = _hourStart = _lastActivity = millis();
+}
+
+bool NetworkWindow::admit(unsigned long dueAt, uint32_t &lastBurst) {
+  unsigned long now = millis();
+  bool urgent = dueAt == 0;
+  long wait = urgent ? 0 : (long)(dueAt - now); // > 0: not due yet
+
+  if (_tolerance == 0)
+    return wait <= 0;
+
+  if (_open) {
+    // Bounded by the burst start, so work re-scheduled during the burst
+    // does not keep it open
+    if (!urgent && (long)(dueAt - _openedAt) > (long)_tolerance)
+      return false; // For a later burst
+    if (wait > 0 && lastBurst == _bursts)
+      return false; // Already ran early in this burst
+    lastBurst = _bursts;
+    _lastActivity = now;
+    return true;
+  }
+
+  // Closed: let late work wait for more to join, up to the tolerance
+  if (!urgent && wait > -(long)_tolerance)
+    return false;
+  if (_reconnect.failing() && !_reconnect.due(now))
+    return false;
+  if (!openBurst(now))
+    return false;
+  lastBurst = _bursts;
+  _lastActivity = millis();
+  return true;
+}
+
+void NetworkWindow::loop() {
+  if (!_config)
+    return;
+  unsigned long now = millis();
+  _tolerance = max(_config->current().system.netTolerance, 0) * 1000UL;
+
+  if (_tolerance == 0) {
+    // Planning turned off: bring back the radio this class switched off
+    if (_released && (!_reconnect.failing() || _reconnect.due(now)))
+      openBurst(now);
+  } else if (_open && _holds == 0 && now - _lastActivity >= IDLE_MS) {
+    closeBurst(now);
+  }
+
+  if (now - _hourStart >= HOUR_MS) {
+    account(now);
+    _lastHourMs = _thisHourMs;
+    _thisHourMs = 0;
+    _hourStart = now;
+  }
+}
+
+uint32_t NetworkWindow::radioOnThisHourMs() const {
+  return _thisHourMs + (_open ? millis() - _onSince : 0);
+}
+
+void NetworkWindow::account(unsigned long now) {
+  if (!_open)
+    return;
+  _thisHourMs += now - _onSince;
+  _onSince = now;
+}
+
+bool NetworkWindow::openBurst(unsigned long now) {
+  const SystemConfig &sys = _config->current().system;
+  bool connected =
+      WiFiHelper::connect(sys.ssid, sys.password, sys.dnsMode, sys.dnsPrimary,
+                          sys.dnsSecondary);
+  unsigned long end = millis();
+
+  if (!connected) {
+    // The radio was on while trying; count it, then switch it off again
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    _thisHourMs += end - now;
+    _connectFailures++;
+    _reconnect.failed(end);
+    Serial.printf("[NetworkWindow] WiFi connect failed, retry in %lus\n",
+                  (_reconnect.retryAt() - end) / 1000);
+    return false;
+  }
+
+  _reconnect.succeeded();
+  _open = true;
+  _released = false;
+  _openedAt = _onSince = now;
+  _bursts++;
+  Serial.printf("[NetworkWindow] Burst %lu open (connect %lums)\n",
+                (unsigned long)_bursts, end - now);
+  return true;
+}
+
+void NetworkWindow::closeBurst(unsigned long now) {
+  account(now);
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+  _open = false;
+  _released = true;
+  Serial.printf("[NetworkWindow] Burst closed, radio on %lus this hour\n",
+                (unsigned long)(_thisHourMs / 1000));
+}
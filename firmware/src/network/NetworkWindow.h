@@ -0,0 +1,73 @@
+#ifndef NETWORK_WINDOW_H
+#define NETWORK_WINDOW_H
+
+#include "../config/ConfigStore.h"
+#include "RetryPolicy.h"
+#include <Arduino.h>
+
+// Plans network use into shared bursts so WiFi can be off in between.
+// Every fetch asks admit() with the time it is due. A closed window opens
+// (WiFi up) once some work is `tolerance` late; an open window takes all
+// work due within `tolerance` after it opened. Fetches due up to
+// 2 x tolerance apart therefore share one burst. The window closes (WiFi
+// off) once nothing has been admitted or held for IDLE_MS.
+//
+// The tolerance is SystemConfig::netTolerance. 0 disables planning: the
+// radio stays up and work runs exactly when due.
+class NetworkWindow {
+public:
+  static const unsigned long IDLE_MS = 2000;
+
+  // connected: WiFi state after the boot connection
+  void begin(ConfigStore &config, bool connected);
+
+  // Whether work due at dueAt (millis) may use the network now. dueAt 0
+  // means due now, without waiting for other work (boot, forced refresh,
+  // configuration change). lastBurst belongs to the caller's work item: it
+  // runs early at most once per burst, so work rescheduled within the
+  // tolerance does not run again in the same burst.
+  bool admit(unsigned long dueAt, uint32_t &lastBurst);
+
+  // Work running off the main loop (fetch task) keeps the burst open
+  void hold() { _holds++; }
+  void release() {
+    if (_holds > 0)
+      _holds--;
+  }
+
+  // Called from the main loop: closes an idle burst
+  void loop();
+
+  bool open() const { return _open; }
+  unsigned long tolerance() const { return _tolerance; }
+  uint32_t bursts() const { return _bursts; }
+  uint32_t connectFailures() const { return _connectFailures; }
+  // Radio-on time during the last full hour / the current hour so far
+  uint32_t radioOnLastHourMs() const { return _lastHourMs; }
+  uint32_t radioOnThisHourMs() const;
+
+private:
+  ConfigStore *_config = nullptr;
+  unsigned long _tolerance = 0;
+  bool _open = false;
+  bool _released = false; // WiFi turned off by closeBurst()
+  int _holds = 0;
+  unsigned long _openedAt = 0;
+  unsigned long _lastActivity = 0;
+  RetryPolicy _reconnect = RetryPolicy(5000, 300000);
+
+  uint32_t _bursts = 0; // Also the id of the current burst
+  uint32_t _connectFailures = 0;
+  unsigned long _onSince = 0;
+  unsigned long _hourStart = 0;
+  uint32_t _thisHourMs = 0;
+  uint32_t _lastHourMs = 0;
+
+  bool openBurst(unsigned long now);
+  void closeBurst(unsigned long now);
+  void account(unsigned long now);
+};
+
+extern NetworkWindow networkWindow;
+
+#endif
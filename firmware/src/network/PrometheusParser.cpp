@@ -0,0 +1,260 @@
+#include "PrometheusParser.h"
+
+PrometheusParser::Result PrometheusParser::firstSample(Stream &stream,
+                                                       float &value) {
+  PrometheusParser parser(stream);
+  if (!parser.parseRoot())
+    return Result::MALFORMED;
+  if (!parser._sawStatus || !parser._success)
+    return Result::NOT_SUCCESS;
+  if (!parser._haveSample)
+    return Result::NO_SAMPLE;
+
+  char *end;
+  value = strtof(parser._sample, &end);
+  return end != parser._sample ? Result::OK : Result::NO_SAMPLE;
+}
+
+// Makes sure _buf[_pos] is valid; false at end of stream or timeout
+bool PrometheusParser::fill() {
+  if (_pos < _len)
+    return true;
+  // Take what is buffered, or block (stream timeout) for one byte
+  size_t want = constrain(_stream.available(), 1, (int)sizeof(_buf));
+  _len = _stream.readBytes(_buf, want);
+  _pos = 0;
+  return _len > 0;
+}
+
+// Next non-blank byte, -1 at end of stream or timeout
+int PrometheusParser::peek() {
+  for (;;) {
+    if (!fill())
+      return -1;
+    uint8_t c = _buf[_pos];
+    if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+      return c;
+    _pos++;
+  }
+}
+
+int PrometheusParser::next() {
+  int c = peek();
+  if (c >= 0)
+    _pos++;
+  return c;
+}
+
+bool PrometheusParser::expect(char c) { return next() == c; }
+
+// Reads a string into out (truncated to cap - 1 bytes), or skips it when
+// out is nullptr. Escapes are consumed but not decoded: keys and samples
+// never contain them.
+bool PrometheusParser::readString(char *out, size_t cap) {
+  if (!expect('"'))
+    return false;
+  size_t n = 0;
+  for (;;) {
+    if (!fill())
+      return false;
+    char c = _buf[_pos++]; // Raw byte: blanks are part of the string
+    if (c == '"')
+      break;
+    if (c == '\\') {
+      if (!fill())
+        return false;
+      c = _buf[_pos++];
+    }
+    if (out && n + 1 < cap)
+      out[n++] = c;
+  }
+  if (out)
+    out[n] = '\0';
+  return true;
+}
+
+// A string or a bare number/literal, as text
+bool PrometheusParser::readScalar(char *out, size_t cap) {
+  int c = peek();
+  if (c == '"')
+    return readString(out, cap);
+  if (c == '{' || c == '[' || c < 0)
+    return false;
+  size_t n = 0;
+  while ((c = peek()) >= 0 && c != ',' && c != ']' && c != '}') {
+    if (n + 1 < cap)
+      out[n++] = c;
+    _pos++;
+  }
+  out[n] = '\0';
+  return c >= 0;
+}
+
+// Skips one value of any type without storing it
+bool PrometheusParser::skipValue() {
+  int depth = 0;
+  do {
+    int c = peek();
+    if (c < 0)
+      return false;
+    if (c == '"') {
+      if (!readString(nullptr, 0))
+        return false;
+    } else if (c == '{' || c == '[') {
+      if (++depth > MAX_DEPTH)
+        return false;
+      _pos++;
+    } else if (c == '}' || c == ']') {
+      if (depth == 0)
+        return false;
+      depth--;
+      _pos++;
+    } else if (c == ',' || c == ':') {
+      if (depth == 0)
+        return false;
+      _pos++;
+    } else {
+      char scratch[2];
+      if (!readScalar(scratch, sizeof(scratch)))
+        return false;
+    }
+  } while (depth > 0);
+  return true;
+}
+
+// After an element: true with more = true on ',', more = false on close
+bool PrometheusParser::nextElement(char close, bool &more) {
+  int c = next();
+  more = c == ',';
+  return more || c == close;
+}
+
+bool PrometheusParser::parseRoot() {
+  if (!expect('{'))
+    return false;
+  if (peek() == '}')
+    return true;
+
+  char key[16];
+  bool more = true;
+  while (more) {
+    if (!readString(key, sizeof(key)) || !expect(':'))
+      return false;
+    bool ok;
+    if (strcmp(key, "status") == 0) {
+      char status[16];
+      ok = readString(status, sizeof(status));
+      _sawStatus = true;
+      _success = strcmp(status, "success") == 0;
+    } else if (strcmp(key, "data") == 0) {
+      ok = parseData();
+    } else {
+      ok = skipValue();
+    }
+    if (!ok)
+      return false;
+    if (done())
+      return true; // The rest of the body is never read
+    if (!nextElement('}', more))
+      return false;
+  }
+  return true;
+}
+
+bool PrometheusParser::parseData() {
+  if (peek() != '{')
+    return skipValue(); // null on errors
+  _pos++;
+  if (peek() == '}') {
+    _pos++;
+    return true;
+  }
+
+  char key[16];
+  bool more = true;
+  while (more) {
+    if (!readString(key, sizeof(key)) || !expect(':'))
+      return false;
+    bool ok = (strcmp(key, "result") == 0 && !_haveSample) ? parseResult()
+                                                            : skipValue();
+    if (!ok)
+      return false;
+    if (done())
+      return true;
+    if (!nextElement('}', more))
+      return false;
+  }
+  return true;
+}
+
+// The first element tells the shape: an object is a vector series, a
+// number is the timestamp of a scalar [ts, "value"]
+bool PrometheusParser::parseResult() {
+  if (peek() != '[')
+    return skipValue();
+  _pos++;
+  int c = peek();
+  if (c == ']') {
+    _pos++;
+    return true;
+  }
+
+  bool more;
+  if (c == '{') {
+    if (!parseSeries())
+      return false;
+  } else {
+    if (!skipValue() || !expect(','))
+      return false;
+    if (!readScalar(_sample, sizeof(_sample)))
+      return false;
+    _haveSample = true;
+  }
+  if (done())
+    return true;
+  if (!nextElement(']', more))
+    return false;
+
+  // Sample already taken, "status" still to come: skip the other series
+  while (more) {
+    if (!skipValue() || !nextElement(']', more))
+      return false;
+  }
+  return true;
+}
+
+// {"metric": {...}, "value": [ts, "v"]}
+bool PrometheusParser::parseSeries() {
+  if (!expect('{'))
+    return false;
+  if (peek() == '}') {
+    _pos++;
+    return true;
+  }
+
+  char key[16];
+  bool more = true;
+  while (more) {
+    if (!readString(key, sizeof(key)) || !expect(':'))
+      return false;
+    bool ok = (strcmp(key, "value") == 0 && !_haveSample) ? parsePair()
+                                                           : skipValue();
+    if (!ok)
+      return false;
+    if (done())
+      return true;
+    if (!nextElement('}', more))
+      return false;
+  }
+  return true;
+}
+
+// [ts, "v"]
+bool PrometheusParser::parsePair() {
+  if (!expect('[') || !skipValue() || !expect(','))
+    return false;
+  if (!readScalar(_sample, sizeof(_sample)))
+    return false;
+  _haveSample = true;
+  return done() || expect(']');
+}
@@ -0,0 +1,56 @@
+#ifndef PROMETHEUS_PARSER_H
+#define PROMETHEUS_PARSER_H
+
+#include <Arduino.h>
+
+// Pull parser for a Prometheus /api/v1/query response, read straight from
+// the socket. Only the current key and the sample text are kept (plus a
+// 64-byte read window), so memory stays bounded whatever the response size,
+// and reading stops as soon as "status" and the first sample are known:
+//   vector: data.result[0].value[1]
+//   scalar: data.result[1]
+class PrometheusParser {
+public:
+  enum class Result {
+    OK,
+    NOT_SUCCESS, // "status" is not "success"
+    NO_SAMPLE,   // Valid response without a sample (empty vector, ...)
+    MALFORMED    // Not JSON, truncated, nested too deep or timed out
+  };
+
+  static Result firstSample(Stream &stream, float &value);
+
+private:
+  static const int MAX_DEPTH = 32;
+
+  explicit PrometheusParser(Stream &stream) : _stream(stream) {}
+
+  Stream &_stream;
+  uint8_t _buf[64];
+  size_t _pos = 0;
+  size_t _len = 0;
+
+  bool _sawStatus = false;
+  bool _success = false;
+  bool _haveSample = false;
+  char _sample[32] = {};
+
+  bool done() const { return _sawStatus && (!_success || _haveSample); }
+
+  bool fill();
+  int peek();
+  int next();
+  bool expect(char c);
+  bool readString(char *out, size_t cap);
+  bool readScalar(char *out, size_t cap);
+  bool skipValue();
+  bool nextElement(char close, bool &more);
+
+  bool parseRoot();
+  bool parseData();
+  bool parseResult();
+  bool parseSeries();
+  bool parsePair();
+};
+
+#endif
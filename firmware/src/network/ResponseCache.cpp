@@ -0,0 +1,37 @@
+#include "ResponseCache.h"
+
+const ResponseCache::Entry *ResponseCache::find(int slot,
+                                                const String &url) const {
+  if (slot < 0 || slot >= CAPACITY)
+    return nullptr;
+  const Entry &e = _entries[slot];
+  return !e.url.isEmpty() && e.url == url ? &e : nullptr;
+}
+
+void ResponseCache::store(int slot, const String &url, const String &etag,
+                          const String &lastModified) {
+  if (slot < 0 || slot >= CAPACITY)
+    return;
+  if (etag.isEmpty() && lastModified.isEmpty()) {
+    // Server sent no validators, nothing to revalidate against
+    remove(slot);
+    return;
+  }
+
+  Entry &e = _entries[slot];
+  if (e.url.isEmpty() && !url.isEmpty())
+    _size++;
+  else if (!e.url.isEmpty() && url.isEmpty())
+    _size--;
+  e.url = url;
+  e.etag = etag;
+  e.lastModified = lastModified;
+}
+
+void ResponseCache::remove(int slot) {
+  if (slot < 0 || slot >= CAPACITY)
+    return;
+  if (!_entries[slot].url.isEmpty())
+    _size--;
+  _entries[slot] = Entry();
+}
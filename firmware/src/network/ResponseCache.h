@@ -0,0 +1,42 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// HTTP validator cache (ETag / Last-Modified), one entry per sensor slot.
+// Two slots reading the same URL with different paths or divisors must not
+// answer each other's 304s, so an entry belongs to its slot and also
+// records the final URL its validators came from. Only metadata is kept,
+// the parsed value stays in the owning module. The counters are atomic so
+// get_stats can read them from the BLE task while the fetch task stores.
+class ResponseCache {
+public:
+  static const int CAPACITY = 16; // One entry per sensor slot
+
+  struct Entry {
+    String url;
+    String etag;
+    String lastModified;
+  };
+
+  // Null unless validators were stored for this slot and URL
+  const Entry *find(int slot, const String &url) const;
+  void store(int slot, const String &url, const String &etag,
+             const String &lastModified);
+  void remove(int slot);
+
+  void recordHit() { _hits++; }
+  void recordMiss() { _misses++; }
+  uint32_t hits() const { return _hits; }
+  uint32_t misses() const { return _misses; }
+  int size() const { return _size; }
+
+private:
+  Entry _entries[CAPACITY];
+  std::atomic<uint32_t> _hits{0};
+  std::atomic<uint32_t> _misses{0};
+  std::atomic<int> _size{0}; // Entries holding validators
+};
+
+#endif
@@ -0,0 +1,18 @@
+#include "RetryPolicy.h"
+
+static const uint8_t MAX_SHIFT = 8;
+
+unsigned long RetryPolicy::backoff(unsigned long baseMs, uint8_t failures,
+                                   unsigned long capMs) {
+  uint8_t shift = min<uint8_t>(failures, MAX_SHIFT);
+  // Compared before shifting: a long base would wrap past 32 bits and come
+  // back as a short delay
+  unsigned long delayMs = baseMs > capMs >> shift ? capMs : baseMs << shift;
+  return delayMs / 100 * random(80, 121);
+}
+
+void RetryPolicy::failed(unsigned long now) {
+  if (_failures < 255)
+    _failures++;
+  _retryAt = now + backoff(_baseMs, _failures, _capMs);
+}
@@ -0,0 +1,38 @@
+#ifndef RETRY_POLICY_H
+#define RETRY_POLICY_H
+
+#include <Arduino.h>
+
+// Failure-aware scheduling for anything polling a remote source: each
+// consecutive failure doubles the delay up to a cap, with +/-20% jitter so
+// devices (and slots) that failed together do not retry in lockstep.
+// Time is passed in by the caller, which keeps the policy clock-agnostic.
+class RetryPolicy {
+public:
+  RetryPolicy(unsigned long baseMs, unsigned long capMs)
+      : _baseMs(baseMs), _capMs(capMs) {}
+
+  // Delay after `failures` consecutive failures (>= 1): base << failures,
+  // capped, then jittered
+  static unsigned long backoff(unsigned long baseMs, uint8_t failures,
+                               unsigned long capMs);
+
+  void failed(unsigned long now);
+  void succeeded() { _failures = 0; }
+
+  // A retry is scheduled and its time has come
+  bool due(unsigned long now) const {
+    return _failures > 0 && (long)(now - _retryAt) >= 0;
+  }
+  bool failing() const { return _failures > 0; }
+  uint8_t failures() const { return _failures; }
+  unsigned long retryAt() const { return _retryAt; }
+
+private:
+  unsigned long _baseMs;
+  unsigned long _capMs;
+  uint8_t _failures = 0;
+  unsigned long _retryAt = 0;
+};
+
+#endif
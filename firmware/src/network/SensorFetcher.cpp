@@ -0,0 +1,119 @@
+#include "SensorFetcher.h"
+#include "../JsonArena.h"
+#include "PrometheusParser.h"
+#include <HTTPClient.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+
+ResponseCache SensorFetcher::_cache;
+
+FetchStatus SensorFetcher::fetch(int slot, const String &url,
+                                 const FetchSource &source, bool conditional,
+                                 float &value) {
+  if (WiFi.status() != WL_CONNECTED) {
+    Serial.println("[SensorFetcher] WiFi not connected");
+    return FetchStatus::FAILED;
+  }
+
+  WiFiClient plainClient;
+  WiFiClientSecure secureClient;
+  bool isHttps = url.startsWith("https://");
+  if (isHttps)
+    secureClient.setInsecure();
+
+  HTTPClient http;
+  if (!http.begin(isHttps ? (WiFiClient &)secureClient : plainClient, url)) {
+    Serial.println("[SensorFetcher] Invalid URL: " + url);
+    return FetchStatus::FAILED;
+  }
+  http.setTimeout(10000);
+  // Bodies are parsed from the raw socket, which must not be chunked
+  http.useHTTP10(true);
+
+  const char *headerKeys[] = {"ETag", "Last-Modified"};
+  http.collectHeaders(headerKeys, 2);
+
+  // Only this task touches the cache, so invalidations arrive as
+  // unconditional requests rather than direct calls from the main loop
+  const ResponseCache::Entry *cached = nullptr;
+  if (conditional)
+    cached = _cache.find(slot, url);
+  else
+    _cache.remove(slot);
+  if (cached) {
+    if (!cached->etag.isEmpty())
+      http.addHeader("If-None-Match", cached->etag);
+    if (!cached->lastModified.isEmpty())
+      http.addHeader("If-Modified-Since", cached->lastModified);
+  }
+
+  int code = http.GET();
+
+  if (code == HTTP_CODE_NOT_MODIFIED) {
+    http.end();
+    _cache.recordHit();
+    return FetchStatus::NOT_MODIFIED;
+  }
+
+  if (code != HTTP_CODE_OK) {
+    Serial.printf("[SensorFetcher] HTTP error %d for %s\n", code, url.c_str());
+    http.end();
+    return FetchStatus::FAILED;
+  }
+
+  _cache.recordMiss();
+  String etag = http.header("ETag");
+  String lastModified = http.header("Last-Modified");
+
+  float raw = 0;
+  bool ok;
+  const JsonPath &path = source.path;
+  if (source.prometheus) {
+    // Streamed: stops after the first sample, whatever the body size
+    PrometheusParser::Result result =
+        PrometheusParser::firstSample(http.getStream(), raw);
+    http.end();
+    ok = result == PrometheusParser::Result::OK;
+    if (!ok)
+      Serial.printf("[SensorFetcher] Prometheus response rejected (%d)\n",
+                    (int)result);
+  } else if (!path.valid()) {
+    http.end();
+    Serial.println("[SensorFetcher] Unsupported JSON path");
+    return FetchStatus::FAILED;
+  } else {
+    // Only the branch the path addresses is materialized
+    JsonDocument filter(&fetchArena);
+    path.buildFilter(filter);
+    JsonDocument doc(&fetchArena);
+    DeserializationError err =
+        deserializeJson(doc, http.getStream(),
+                        DeserializationOption::Filter(filter));
+    http.end();
+
+    if (err) {
+      Serial.println("[SensorFetcher] JSON error: " + String(err.c_str()));
+      _cache.remove(slot);
+      return FetchStatus::FAILED;
+    }
+
+    JsonVariantConst v = path.resolve(doc.as<JsonVariantConst>());
+    ok = !v.isNull();
+    if (ok) {
+      // APIs often return numbers as strings
+      raw = v.is<const char *>() ? String(v.as<const char *>()).toFloat()
+                                 : v.as<float>();
+    }
+  }
+
+  if (!ok) {
+    Serial.println("[SensorFetcher] Value not found in response");
+    _cache.remove(slot);
+    return FetchStatus::FAILED;
+  }
+
+  // Only remember validators once the body proved usable
+  _cache.store(slot, url, etag, lastModified);
+  value = (source.divisor != 0) ? raw / source.divisor : raw;
+  return FetchStatus::OK;
+}
@@ -0,0 +1,40 @@
+#ifndef SENSOR_FETCHER_H
+#define SENSOR_FETCHER_H
+
+#include "../config/JsonPath.h"
+#include "../config/SensorConfig.h"
+#include "ResponseCache.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+enum class FetchStatus {
+  OK,           // Fresh body parsed, value is valid
+  NOT_MODIFIED, // 304, keep the previous value
+  FAILED
+};
+
+// What a fetch reads from a slot's SensorConfig, without its heap strings
+struct FetchSource {
+  bool prometheus = true; // Otherwise a JSON API, read through path
+  float divisor = 1;
+  JsonPath path; // Compiled SensorConfig::jsonPath
+};
+
+// Conditional GET for sensor slots (Prometheus or JSON API).
+// Validators are remembered per slot and final URL so unchanged responses
+// are answered with a 304 and never parsed. Without `conditional` (the
+// slot has no value from this source to keep) the slot's validators are
+// dropped and the body is always fetched.
+class SensorFetcher {
+public:
+  static FetchStatus fetch(int slot, const String &url,
+                           const FetchSource &source, bool conditional,
+                           float &value);
+
+  static ResponseCache &cache() { return _cache; }
+
+private:
+  static ResponseCache _cache;
+};
+
+#endif
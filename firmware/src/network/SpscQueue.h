@@ -0,0 +1,50 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <utility>
+
+// Bounded lock-free ring for exactly one producer task and one consumer
+// task. Indices only grow (wrapping at SIZE_MAX), the slot is index & (N-1);
+// the release store of an index publishes the slot it covers.
+template <typename T, size_t N> class SpscQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+  static const size_t CAPACITY = N;
+
+  // Producer side; false when full (the item is left untouched)
+  bool push(T &item) {
+    size_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) == N)
+      return false;
+    _slots[head & (N - 1)] = std::move(item);
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side; false when empty
+  bool pop(T &out) {
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    if (_head.load(std::memory_order_acquire) == tail)
+      return false;
+    out = std::move(_slots[tail & (N - 1)]);
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Snapshot, exact only from the producer or consumer side
+  size_t size() const {
+    return _head.load(std::memory_order_acquire) -
+           _tail.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+
+private:
+  T _slots[N];
+  std::atomic<size_t> _head{0}; // Next slot to write, owned by the producer
+  std::atomic<size_t> _tail{0}; // Next slot to read, owned by the consumer
+};
+
+#endif
@@ -1,32 +1,26 @@
 #ifndef PIN_H
 #define PIN_H
 
+#include "displays/PanelSpec.h"
+#include <stddef.h>
+
 // ==================== PIN CONFIGURATION ====================
 #define SPI_MOSI 7 // FSPID
 #define SPI_SCK 6  // FSPICLK
 
-// first screen
-#define CS_PIN_1 (10)
-#define DC_PIN_1 (0)
-#define RES_PIN_1 (18)
-#define BUSY_PIN_1 (22)
-
-// second screen
-#define CS_PIN_2 (11)
-#define DC_PIN_2 (1)
-#define RES_PIN_2 (19)
-#define BUSY_PIN_2 (23)
-
-// third screen
-#define CS_PIN_3 (2)
-#define DC_PIN_3 (3)
-#define RES_PIN_3 (20)
-#define BUSY_PIN_3 (21)
+// ==================== PANEL TABLE ====================
+// One line per panel, in screen order (screen index = line index). The
+// panel count, the module_map length and every per-screen array follow
+// this table. DC is only sampled while CS is low, so panels may share one
+// DC line when GPIOs run short; CS and BUSY must be per panel.
+constexpr PanelSpec PANELS[] = {
+    // model, cs, dc, rst, busy, rotation
+    {PanelModel::GDEY042Z98, 11, 1, 19, 23, 1}, // Screen 0 (Top Left)
+    {PanelModel::GDEY042T81, 10, 0, 18, 22, 1}, // Screen 1 (Top Right)
+    {PanelModel::GDEY042T81, 2, 3, 20, 21, 1},  // Screen 2 (Bottom Left)
+    {PanelModel::GDEY042T81, 4, 5, 8, 9, 1},    // Screen 3 (Bottom Right)
+};
 
-// Screen 4
-#define CS_PIN_4 (4)
-#define DC_PIN_4 (5)
-#define RES_PIN_4 (8)
-#define BUSY_PIN_4 (9)
+constexpr size_t PANEL_COUNT = sizeof(PANELS) / sizeof(PANELS[0]);
 
-#endif // CONFIG_H
+#endif // PIN_H
@@ -0,0 +1,139 @@
+#include "telemetry.h"
+#include "JsonArena.h"
+
+Telemetry telemetry;
+
+uint32_t Telemetry::subscribe(Sink sink, uint32_t intervalMs) {
+  std::lock_guard<std::mutex> guard(_lock);
+  _sink = sink;
+  _interval = constrain(intervalMs, MIN_INTERVAL, MAX_INTERVAL);
+  _lastFlush = 0;
+  Serial.printf("[Telemetry] Subscribed, interval %lums\n",
+                (unsigned long)_interval);
+  return _interval;
+}
+
+void Telemetry::unsubscribe() {
+  std::lock_guard<std::mutex> guard(_lock);
+  if (!_sink)
+    return;
+  _sink = nullptr;
+  _dirty = 0;
+  _refreshCount = 0;
+  Serial.println("[Telemetry] Unsubscribed");
+}
+
+bool Telemetry::active() {
+  std::lock_guard<std::mutex> guard(_lock);
+  return (bool)_sink;
+}
+
+void Telemetry::publishValue(int slot, float value) {
+  if (slot < 0 || slot >= SENSOR_SLOTS)
+    return;
+  std::lock_guard<std::mutex> guard(_lock);
+  if (!_sink)
+    return;
+  if (_dirty & (1u << slot))
+    _dropped++; // Superseded before it was sent
+  _values[slot] = value;
+  _dirty |= 1u << slot;
+}
+
+void Telemetry::publishRefresh(const char *module, bool full,
+                               uint32_t durationMs) {
+  std::lock_guard<std::mutex> guard(_lock);
+  if (!_sink)
+    return;
+  if (_refreshCount == MAX_REFRESHES) {
+    // Keep the most recent events
+    for (int i = 1; i < MAX_REFRESHES; i++)
+      _refreshes[i - 1] = _refreshes[i];
+    _refreshCount--;
+    _dropped++;
+  }
+  _refreshes[_refreshCount++] = {module, full, durationMs};
+}
+
+void Telemetry::loop() {
+  // Build the message and take the pending state under the lock, but send
+  // without it: producers run on other tasks and must not wait on the link
+  JsonDocument doc(&loopArena);
+  Sink sink;
+  float values[SENSOR_SLOTS];
+  uint32_t dirty;
+  RefreshEvent refreshes[MAX_REFRESHES];
+  int refreshCount;
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (!_sink || (_dirty == 0 && _refreshCount == 0))
+      return;
+    unsigned long now = millis();
+    if (_lastFlush != 0 && now - _lastFlush < _interval)
+      return;
+
+    doc["cmd"] = "telemetry";
+    doc["t"] = now;
+    if (_dirty) {
+      JsonObject v = doc["values"].to<JsonObject>();
+      for (int i = 0; i < SENSOR_SLOTS; i++) {
+        if (_dirty & (1u << i))
+          v[String(i)] = _values[i];
+      }
+    }
+    if (_refreshCount > 0) {
+      JsonArray r = doc["refresh"].to<JsonArray>();
+      for (int i = 0; i < _refreshCount; i++) {
+        JsonObject e = r.add<JsonObject>();
+        e["module"] = _refreshes[i].module.c_str();
+        e["full"] = _refreshes[i].full;
+        e["ms"] = _refreshes[i].durationMs;
+      }
+    }
+    doc["dropped"] = _dropped;
+
+    sink = _sink;
+    memcpy(values, _values, sizeof(values));
+    dirty = _dirty;
+    refreshCount = _refreshCount;
+    for (int i = 0; i < refreshCount; i++)
+      refreshes[i] = _refreshes[i];
+    _dirty = 0;
+    _refreshCount = 0;
+    _lastFlush = now;
+  }
+
+  bool delivered = sink(doc);
+
+  std::lock_guard<std::mutex> guard(_lock);
+  if (delivered) {
+    _sent++;
+    return;
+  }
+  if (!_sink)
+    return; // Unsubscribed meanwhile
+
+  // Busy link: put the state back, values published meanwhile are newer
+  for (int i = 0; i < SENSOR_SLOTS; i++) {
+    if (!(dirty & (1u << i)))
+      continue;
+    if (_dirty & (1u << i)) {
+      _dropped++;
+    } else {
+      _values[i] = values[i];
+      _dirty |= 1u << i;
+    }
+  }
+  // Older events go first, keep the most recent MAX_REFRESHES
+  int total = refreshCount + _refreshCount;
+  int skip = max(0, total - MAX_REFRESHES);
+  _dropped += skip;
+  RefreshEvent merged[MAX_REFRESHES];
+  int n = 0;
+  for (int i = skip; i < total; i++)
+    merged[n++] = i < refreshCount ? refreshes[i]
+                                   : _refreshes[i - refreshCount];
+  for (int i = 0; i < n; i++)
+    _refreshes[i] = merged[i];
+  _refreshCount = n;
+}
@@ -0,0 +1,61 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "FixedString.h"
+#include "config/SensorConfig.h"
+#include <ArduinoJson.h>
+#include <functional>
+#include <mutex>
+
+// Live notify stream for a connected client: per-slot sensor values and
+// panel refresh events. Producers only record the latest state; loop()
+// flushes it at most once per interval, so a slow link drops superseded
+// values instead of queueing them behind the main loop.
+class Telemetry {
+public:
+  // Returns false when the link cannot take the message right now
+  using Sink = std::function<bool(const JsonDocument &)>;
+
+  static const uint32_t MIN_INTERVAL = 200;
+  static const uint32_t MAX_INTERVAL = 60000;
+
+  // Returns the effective interval
+  uint32_t subscribe(Sink sink, uint32_t intervalMs);
+  void unsubscribe();
+  bool active();
+
+  void publishValue(int slot, float value);
+  void publishRefresh(const char *module, bool full, uint32_t durationMs);
+
+  // Called from the main loop
+  void loop();
+
+  uint32_t sent() const { return _sent; }
+  uint32_t dropped() const { return _dropped; }
+
+private:
+  static const int MAX_REFRESHES = 4;
+
+  struct RefreshEvent {
+    FixedString<15> module;
+    bool full;
+    uint32_t durationMs;
+  };
+
+  std::mutex _lock;
+  Sink _sink;
+  uint32_t _interval = 1000;
+  unsigned long _lastFlush = 0;
+
+  float _values[SENSOR_SLOTS] = {};
+  uint32_t _dirty = 0; // One bit per sensor slot
+  RefreshEvent _refreshes[MAX_REFRESHES];
+  int _refreshCount = 0;
+
+  uint32_t _sent = 0;
+  uint32_t _dropped = 0;
+};
+
+extern Telemetry telemetry;
+
+#endif
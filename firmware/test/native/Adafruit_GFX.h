@@ -0,0 +1,102 @@
+#ifndef NATIVE_ADAFRUIT_GFX_H
+#define NATIVE_ADAFRUIT_GFX_H
+
+// Host stand-in for Adafruit_GFX: rotation and the shape primitives the
+// views use, all drawn through drawPixel() like the real library.
+
+#include <Arduino.h>
+
+class Adafruit_GFX {
+public:
+  Adafruit_GFX(int16_t w, int16_t h)
+      : WIDTH(w), HEIGHT(h), _width(w), _height(h) {}
+  virtual ~Adafruit_GFX() {}
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+  virtual void setRotation(uint8_t r) {
+    rotation = r & 3;
+    bool swap = rotation & 1;
+    _width = swap ? HEIGHT : WIDTH;
+    _height = swap ? WIDTH : HEIGHT;
+  }
+  uint8_t getRotation() const { return rotation; }
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+  virtual void fillScreen(uint16_t color) {
+    fillRect(0, 0, _width, _height, color);
+  }
+  virtual void drawFastVLine(int16_t x, int16_t y, int16_t h,
+                             uint16_t color) {
+    fillRect(x, y, 1, h, color);
+  }
+  virtual void drawFastHLine(int16_t x, int16_t y, int16_t w,
+                             uint16_t color) {
+    fillRect(x, y, w, 1, color);
+  }
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                        uint16_t color) {
+    for (int16_t j = y; j < y + h; j++)
+      for (int16_t i = x; i < x + w; i++)
+        drawPixel(i, j, color);
+  }
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+  }
+  void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t,
+                     uint16_t color) {
+    drawRect(x, y, w, h, color);
+  }
+  void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t,
+                     uint16_t color) {
+    fillRect(x, y, w, h, color);
+  }
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                uint16_t color) {
+    int dx = abs(x1 - x0), dy = -abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1, err = dx + dy;
+    for (;;) {
+      drawPixel(x0, y0, color);
+      if (x0 == x1 && y0 == y1)
+        break;
+      int e2 = 2 * err;
+      if (e2 >= dy) {
+        err += dy;
+        x0 += sx;
+      }
+      if (e2 <= dx) {
+        err += dx;
+        y0 += sy;
+      }
+    }
+  }
+  void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    circle(x0, y0, r, color, false);
+  }
+  void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    circle(x0, y0, r, color, true);
+  }
+
+protected:
+  const int16_t WIDTH, HEIGHT;
+  int16_t _width, _height;
+  uint8_t rotation = 0;
+
+private:
+  void circle(int16_t x0, int16_t y0, int16_t r, uint16_t color,
+              bool fill) {
+    for (int16_t y = -r; y <= r; y++) {
+      for (int16_t x = -r; x <= r; x++) {
+        int d = x * x + y * y;
+        if (d <= r * r && (fill || d > (r - 1) * (r - 1)))
+          drawPixel(x0 + x, y0 + y, color);
+      }
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,303 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Host stand-in for the parts of the Arduino core the firmware sources use,
+// so pure logic (parsers, caches, schedulers) builds in [env:native].
+// Time is a manual clock: millis() only moves with delay() or
+// ArduinoStub::advance(), which keeps timing tests deterministic.
+// FreeRTOS tasks are threads, their notifications a counting semaphore.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include <string>
+#include <strings.h>
+#include <thread>
+
+using std::max;
+using std::min;
+
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+namespace ArduinoStub {
+inline std::atomic<unsigned long> clockMs{0}; // Tasks read it too
+inline void advance(unsigned long ms) { clockMs += ms; }
+inline void reset(unsigned long ms = 0) { clockMs = ms; }
+} // namespace ArduinoStub
+
+inline unsigned long millis() { return ArduinoStub::clockMs; }
+inline unsigned long micros() { return ArduinoStub::clockMs * 1000UL; }
+inline void delay(unsigned long ms) { ArduinoStub::advance(ms); }
+inline void yield() {}
+
+inline long random(long howsmall, long howbig) {
+  if (howsmall >= howbig)
+    return howsmall;
+  return howsmall + rand() % (howbig - howsmall);
+}
+inline long random(long howbig) { return random(0, howbig); }
+inline void randomSeed(unsigned long seed) { srand(seed); }
+
+class String {
+public:
+  String() {}
+  String(const char *s) : _s(s ? s : "") {}
+  String(const char *s, size_t len) : _s(s, len) {}
+  String(const std::string &s) : _s(s) {}
+  String(char c) : _s(1, c) {}
+  String(int v) : _s(std::to_string(v)) {}
+  String(unsigned int v) : _s(std::to_string(v)) {}
+  String(long v) : _s(std::to_string(v)) {}
+  String(unsigned long v) : _s(std::to_string(v)) {}
+  String(float v, unsigned int decimals = 2) { setFloat(v, decimals); }
+  String(double v, unsigned int decimals = 2) { setFloat(v, decimals); }
+
+  const char *c_str() const { return _s.c_str(); }
+  unsigned int length() const { return _s.length(); }
+  bool isEmpty() const { return _s.empty(); }
+  void reserve(unsigned int size) { _s.reserve(size); }
+
+  char operator[](unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+  char &operator[](unsigned int i) { return _s[i]; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+
+  bool concat(const char *s) {
+    _s += s ? s : "";
+    return true;
+  }
+  bool concat(const char *s, unsigned int len) {
+    _s.append(s, len);
+    return true;
+  }
+  bool concat(const String &s) { return concat(s.c_str(), s.length()); }
+  bool concat(char c) {
+    _s += c;
+    return true;
+  }
+  String &operator+=(const String &s) {
+    concat(s);
+    return *this;
+  }
+  String &operator+=(const char *s) {
+    concat(s);
+    return *this;
+  }
+  String &operator+=(char c) {
+    concat(c);
+    return *this;
+  }
+
+  bool equals(const char *s) const { return _s == (s ? s : ""); }
+  bool operator==(const String &o) const { return _s == o._s; }
+  bool operator==(const char *s) const { return equals(s); }
+  bool operator!=(const String &o) const { return !(*this == o); }
+  bool operator!=(const char *s) const { return !equals(s); }
+  bool operator<(const String &o) const { return _s < o._s; }
+
+  bool startsWith(const String &prefix) const {
+    return _s.compare(0, prefix.length(), prefix._s) == 0;
+  }
+  bool endsWith(const String &suffix) const {
+    return _s.size() >= suffix.length() &&
+           _s.compare(_s.size() - suffix.length(), suffix.length(),
+                      suffix._s) == 0;
+  }
+  int indexOf(char c, unsigned int from = 0) const {
+    size_t i = _s.find(c, from);
+    return i == std::string::npos ? -1 : (int)i;
+  }
+  int indexOf(const String &s, unsigned int from = 0) const {
+    size_t i = _s.find(s._s, from);
+    return i == std::string::npos ? -1 : (int)i;
+  }
+  String substring(unsigned int from) const {
+    return from < _s.size() ? String(_s.substr(from)) : String();
+  }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to)
+      std::swap(from, to);
+    return from < _s.size() ? String(_s.substr(from, to - from)) : String();
+  }
+  void trim() {
+    size_t b = _s.find_first_not_of(" \t\r\n");
+    size_t e = _s.find_last_not_of(" \t\r\n");
+    _s = b == std::string::npos ? "" : _s.substr(b, e - b + 1);
+  }
+  void toLowerCase() {
+    for (char &c : _s)
+      c = tolower((unsigned char)c);
+  }
+  long toInt() const { return atol(_s.c_str()); }
+  float toFloat() const { return atof(_s.c_str()); }
+
+  friend String operator+(const String &a, const String &b) {
+    String r(a);
+    r += b;
+    return r;
+  }
+  friend String operator+(const String &a, const char *b) {
+    String r(a);
+    r += b;
+    return r;
+  }
+  friend String operator+(const char *a, const String &b) {
+    String r(a);
+    r += b;
+    return r;
+  }
+
+private:
+  std::string _s;
+
+  void setFloat(double v, unsigned int decimals) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    _s = buf;
+  }
+};
+
+// Type of `"a" + String(...)` in the Arduino core, referenced by ArduinoJson
+class StringSumHelper : public String {
+public:
+  using String::String;
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size-- && write(*buffer++))
+      n++;
+    return n;
+  }
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const String &s) { return write(s.c_str()); }
+  size_t println(const char *s = "") { return print(s) + print("\n"); }
+  size_t println(const String &s) { return println(s.c_str()); }
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[512];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    return n > 0 ? write(buf) : 0;
+  }
+};
+
+// Reads go through read() and readBytes(char *, size_t); the default
+// readBytes() reads byte by byte until length or end of stream.
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  size_t write(uint8_t) override { return 0; }
+  using Print::write;
+
+  virtual size_t readBytes(char *buffer, size_t length) {
+    size_t n = 0;
+    while (n < length) {
+      int c = read();
+      if (c < 0)
+        break;
+      buffer[n++] = (char)c;
+    }
+    return n;
+  }
+  size_t readBytes(uint8_t *buffer, size_t length) {
+    return readBytes((char *)buffer, length);
+  }
+  void setTimeout(unsigned long) {}
+};
+
+// Log output; quiet unless ARDUINO_STUB_VERBOSE is set in the environment
+class HardwareSerial : public Print {
+public:
+  size_t write(uint8_t c) override {
+    if (verbose())
+      fputc(c, stderr);
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    if (verbose())
+      fwrite(buffer, 1, size, stderr);
+    return size;
+  }
+  using Print::write;
+  void begin(unsigned long) {}
+
+private:
+  static bool verbose() {
+    static const bool on = getenv("ARDUINO_STUB_VERBOSE") != nullptr;
+    return on;
+  }
+};
+
+inline HardwareSerial Serial;
+
+// FreeRTOS: ticks are milliseconds (real time, not the manual clock)
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+#define pdPASS 1
+#define pdTRUE 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+struct NativeTask {
+  std::mutex lock;
+  std::condition_variable wake;
+  uint32_t notified = 0;
+};
+typedef NativeTask *TaskHandle_t;
+
+namespace ArduinoStub {
+inline thread_local NativeTask *currentTask = nullptr;
+} // namespace ArduinoStub
+
+// Tasks never return; the thread and its handle live until exit
+inline BaseType_t xTaskCreate(void (*entry)(void *), const char *, uint32_t,
+                              void *arg, UBaseType_t, TaskHandle_t *handle) {
+  NativeTask *task = new NativeTask;
+  *handle = task;
+  std::thread([=] {
+    ArduinoStub::currentTask = task;
+    entry(arg);
+  }).detach();
+  return pdPASS;
+}
+
+inline void xTaskNotifyGive(TaskHandle_t task) {
+  std::lock_guard<std::mutex> guard(task->lock);
+  task->notified++;
+  task->wake.notify_one();
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  NativeTask *task = ArduinoStub::currentTask;
+  std::unique_lock<std::mutex> guard(task->lock);
+  task->wake.wait_for(guard, std::chrono::milliseconds(ticks),
+                      [task] { return task->notified > 0; });
+  uint32_t count = task->notified;
+  if (count > 0)
+    task->notified = clearOnExit ? 0 : count - 1;
+  return count;
+}
+
+inline void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+#endif
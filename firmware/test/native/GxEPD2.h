@@ -0,0 +1,9 @@
+#ifndef NATIVE_GXEPD2_H
+#define NATIVE_GXEPD2_H
+
+// Host stand-in for GxEPD2: only the color values the views draw with
+#define GxEPD_BLACK 0x0000
+#define GxEPD_WHITE 0xFFFF
+#define GxEPD_RED 0xF800
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef NATIVE_HTTP_CLIENT_H
+#define NATIVE_HTTP_CLIENT_H
+
+// Minimal HTTP/1.0 client with the ESP32 HTTPClient interface the firmware
+// uses: plain http:// only, the body is left on the socket for streaming.
+
+#include <WiFi.h>
+#include <vector>
+
+enum {
+  HTTPC_ERROR_CONNECTION_REFUSED = -1,
+  HTTPC_ERROR_SEND_HEADER_FAILED = -2,
+  HTTPC_ERROR_READ_TIMEOUT = -11,
+  HTTP_CODE_OK = 200,
+  HTTP_CODE_NOT_MODIFIED = 304,
+  HTTP_CODE_NOT_FOUND = 404,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500
+};
+
+class HTTPClient {
+public:
+  bool begin(WiFiClient &client, const String &url) {
+    _client = &client;
+    _headers = "";
+    _collected.clear();
+    if (!url.startsWith("http://"))
+      return false;
+    String rest = url.substring(7);
+    int slash = rest.indexOf('/');
+    String hostPort = slash < 0 ? rest : rest.substring(0, slash);
+    _path = slash < 0 ? String("/") : rest.substring(slash);
+    int colon = hostPort.indexOf(':');
+    _host = colon < 0 ? hostPort : hostPort.substring(0, colon);
+    _port = colon < 0 ? 80 : hostPort.substring(colon + 1).toInt();
+    return !_host.isEmpty();
+  }
+
+  void setTimeout(uint16_t ms) { _timeoutMs = ms; }
+  void useHTTP10(bool) {} // Always HTTP/1.0
+
+  void collectHeaders(const char *keys[], size_t count) {
+    _collected.clear();
+    for (size_t i = 0; i < count; i++)
+      _collected.push_back({keys[i], String()});
+  }
+
+  void addHeader(const String &name, const String &value) {
+    _headers += name + ": " + value + "\r\n";
+  }
+
+  int GET() {
+    if (!_client)
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    _client->setTimeout(_timeoutMs);
+    if (!_client->connect(_host.c_str(), _port))
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    String request = "GET " + _path + " HTTP/1.0\r\nHost: " + _host +
+                     "\r\n" + _headers + "\r\n";
+    if (_client->write(request.c_str()) != request.length())
+      return HTTPC_ERROR_SEND_HEADER_FAILED;
+
+    String status;
+    if (!readLine(status) || !status.startsWith("HTTP/"))
+      return HTTPC_ERROR_READ_TIMEOUT;
+    int code = status.substring(status.indexOf(' ') + 1).toInt();
+
+    String line;
+    while (readLine(line) && !line.isEmpty()) {
+      int colon = line.indexOf(':');
+      if (colon < 0)
+        continue;
+      String name = line.substring(0, colon);
+      String value = line.substring(colon + 1);
+      value.trim();
+      for (Header &h : _collected) {
+        if (strcasecmp(h.name.c_str(), name.c_str()) == 0)
+          h.value = value;
+      }
+    }
+    return code;
+  }
+
+  String header(const char *name) const {
+    for (const Header &h : _collected) {
+      if (strcasecmp(h.name.c_str(), name) == 0)
+        return h.value;
+    }
+    return String();
+  }
+
+  WiFiClient &getStream() { return *_client; }
+
+  String getString() {
+    String body;
+    char buf[256];
+    size_t n;
+    while ((n = _client->readBytes(buf, sizeof(buf))) > 0)
+      body.concat(buf, n);
+    return body;
+  }
+
+  void end() {
+    if (_client)
+      _client->stop();
+  }
+
+private:
+  struct Header {
+    String name;
+    String value;
+  };
+
+  WiFiClient *_client = nullptr;
+  String _host;
+  uint16_t _port = 80;
+  String _path;
+  String _headers;
+  std::vector<Header> _collected;
+  uint16_t _timeoutMs = 5000;
+
+  bool readLine(String &out) {
+    out = "";
+    for (;;) {
+      int c = _client->read();
+      if (c < 0)
+        return !out.isEmpty();
+      if (c == '\n')
+        break;
+      if (c != '\r')
+        out += (char)c;
+    }
+    return true;
+  }
+};
+
+#endif
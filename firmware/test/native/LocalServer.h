@@ -0,0 +1,134 @@
+#ifndef NATIVE_LOCAL_SERVER_H
+#define NATIVE_LOCAL_SERVER_H
+
+// One-thread HTTP/1.0 server on 127.0.0.1 for host tests. Each request is
+// answered by the handler and the connection closed, which is all the
+// firmware's HTTP/1.0 fetches expect.
+
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <functional>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+class LocalServer {
+public:
+  struct Request {
+    std::string path;
+    std::string headers; // Raw header block, lower-cased names
+
+    // Value of a request header, empty when absent
+    std::string header(const char *name) const {
+      std::string key = std::string("\n") + name + ":";
+      for (char &c : key)
+        c = tolower((unsigned char)c);
+      size_t at = headers.find(key);
+      if (at == std::string::npos)
+        return "";
+      size_t start = headers.find_first_not_of(' ', at + key.size());
+      size_t end = headers.find('\r', start);
+      return headers.substr(start, end - start);
+    }
+  };
+
+  struct Response {
+    int code = 200;
+    std::string headers; // Extra header lines, each ending in \r\n
+    std::string body;
+  };
+
+  using Handler = std::function<Response(const Request &)>;
+
+  explicit LocalServer(Handler handler) : _handler(handler) {
+    _fd = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0; // Any free port
+    bind(_fd, (sockaddr *)&addr, sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(_fd, (sockaddr *)&addr, &len);
+    _port = ntohs(addr.sin_port);
+    listen(_fd, 8);
+    _thread = std::thread([this] { run(); });
+  }
+
+  ~LocalServer() {
+    _stop = true;
+    _thread.join();
+    close(_fd);
+  }
+
+  String url(const char *path) const {
+    return String("http://127.0.0.1:") + String((int)_port) + path;
+  }
+  int requests() const { return _requests; }
+
+private:
+  Handler _handler;
+  int _fd;
+  uint16_t _port;
+  std::atomic<bool> _stop{false};
+  std::atomic<int> _requests{0};
+  std::thread _thread;
+
+  void run() {
+    while (!_stop) {
+      pollfd p = {_fd, POLLIN, 0};
+      if (poll(&p, 1, 20) <= 0)
+        continue;
+      int client = accept(_fd, nullptr, nullptr);
+      if (client >= 0) {
+        serve(client);
+        close(client);
+      }
+    }
+  }
+
+  void serve(int client) {
+    std::string raw;
+    char buf[512];
+    while (raw.find("\r\n\r\n") == std::string::npos) {
+      ssize_t n = recv(client, buf, sizeof(buf), 0);
+      if (n <= 0)
+        return;
+      raw.append(buf, n);
+    }
+
+    Request request;
+    size_t sp = raw.find(' ');
+    request.path = raw.substr(sp + 1, raw.find(' ', sp + 1) - sp - 1);
+    request.headers = raw.substr(raw.find('\n'));
+    for (size_t i = 0; i < request.headers.size(); i++) {
+      if (request.headers[i] == ':')
+        while (i < request.headers.size() && request.headers[i] != '\n')
+          i++;
+      else
+        request.headers[i] = tolower((unsigned char)request.headers[i]);
+    }
+    _requests++;
+
+    Response response = _handler(request);
+    std::string out = "HTTP/1.0 " + std::to_string(response.code) +
+                      " X\r\n" + response.headers + "Content-Length: " +
+                      std::to_string(response.body.size()) +
+                      "\r\nConnection: close\r\n\r\n" + response.body;
+    size_t sent = 0;
+    while (sent < out.size()) {
+      ssize_t n = send(client, out.data() + sent, out.size() - sent,
+                       MSG_NOSIGNAL);
+      if (n <= 0)
+        break;
+      sent += n;
+    }
+  }
+};
+
+#endif
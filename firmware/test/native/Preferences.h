@@ -0,0 +1,77 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+// In-memory NVS: namespaces survive Preferences objects (like flash does)
+// until a test calls Preferences::eraseAll(). Tests set failWrites to make
+// every write fail, as a full or worn partition would.
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+  using Namespace = std::map<std::string, std::vector<uint8_t>>;
+
+  static std::map<std::string, Namespace> &flash() {
+    static std::map<std::string, Namespace> storage;
+    return storage;
+  }
+  static void eraseAll() { flash().clear(); }
+  static bool &failWrites() {
+    static bool fail = false;
+    return fail;
+  }
+
+  bool begin(const char *name, bool readOnly = false) {
+    if (readOnly && !flash().count(name))
+      return false;
+    _ns = &flash()[name];
+    _readOnly = readOnly;
+    return true;
+  }
+  void end() { _ns = nullptr; }
+
+  bool isKey(const char *key) const { return _ns && _ns->count(key); }
+  bool remove(const char *key) { return writable() && _ns->erase(key); }
+  bool clear() {
+    if (!writable())
+      return false;
+    _ns->clear();
+    return true;
+  }
+
+  size_t getBytesLength(const char *key) const {
+    return isKey(key) ? _ns->at(key).size() : 0;
+  }
+  size_t getBytes(const char *key, void *buf, size_t len) const {
+    size_t n = getBytesLength(key);
+    if (n == 0 || n > len)
+      return 0;
+    memcpy(buf, _ns->at(key).data(), n);
+    return n;
+  }
+  size_t putBytes(const char *key, const void *value, size_t len) {
+    if (!writable() || len == 0 || failWrites())
+      return 0;
+    const uint8_t *p = (const uint8_t *)value;
+    (*_ns)[key].assign(p, p + len);
+    return len;
+  }
+
+  uint8_t getUChar(const char *key, uint8_t defaultValue = 0) const {
+    return getBytesLength(key) == 1 ? _ns->at(key)[0] : defaultValue;
+  }
+  size_t putUChar(const char *key, uint8_t value) {
+    return putBytes(key, &value, 1);
+  }
+
+private:
+  Namespace *_ns = nullptr;
+  bool _readOnly = false;
+
+  bool writable() const { return _ns && !_readOnly; }
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef NATIVE_U8G2_FOR_ADAFRUIT_GFX_H
+#define NATIVE_U8G2_FOR_ADAFRUIT_GFX_H
+
+// Host stand-in for U8g2_for_Adafruit_GFX. Fonts are placeholders whose
+// first byte is the glyph height; glyphs are drawn as filled boxes of
+// fixed width, which is enough for layout and redraw tests.
+
+#include <Adafruit_GFX.h>
+
+#define NATIVE_U8G2_FONT(name, height) \
+  inline const uint8_t name[1] = {height};
+
+NATIVE_U8G2_FONT(u8g2_font_helvB08_tf, 8)
+NATIVE_U8G2_FONT(u8g2_font_helvB10_tf, 10)
+NATIVE_U8G2_FONT(u8g2_font_helvB12_tf, 12)
+NATIVE_U8G2_FONT(u8g2_font_helvB14_tf, 14)
+NATIVE_U8G2_FONT(u8g2_font_helvB18_tf, 18)
+NATIVE_U8G2_FONT(u8g2_font_helvB24_tf, 24)
+NATIVE_U8G2_FONT(u8g2_font_helvR08_tf, 8)
+NATIVE_U8G2_FONT(u8g2_font_helvR10_tf, 10)
+NATIVE_U8G2_FONT(u8g2_font_helvR12_tf, 12)
+NATIVE_U8G2_FONT(u8g2_font_logisoso24_tn, 24)
+NATIVE_U8G2_FONT(u8g2_font_logisoso28_tn, 28)
+NATIVE_U8G2_FONT(u8g2_font_logisoso50_tn, 50)
+
+class U8G2_FOR_ADAFRUIT_GFX {
+public:
+  void begin(Adafruit_GFX &gfx) { _gfx = &gfx; }
+  void setFont(const uint8_t *font) { _height = font[0]; }
+  void setFontMode(uint8_t mode) { _transparent = mode != 0; }
+  void setForegroundColor(uint16_t color) { _fg = color; }
+  void setBackgroundColor(uint16_t color) { _bg = color; }
+  void setCursor(int16_t x, int16_t y) {
+    _x = x;
+    _y = y;
+  }
+
+  int8_t getFontAscent() const { return _height; }
+  int8_t getFontDescent() const { return -(_height / 4); }
+  int16_t getUTF8Width(const char *text) const {
+    return glyphs(text) * advance();
+  }
+
+  size_t print(const char *text) {
+    size_t n = glyphs(text);
+    for (size_t i = 0; i < n; i++) {
+      if (!_transparent)
+        _gfx->fillRect(_x, _y - _height, advance(), _height, _bg);
+      _gfx->fillRect(_x + 1, _y - _height + 1, advance() - 2, _height - 2,
+                     _fg);
+      _x += advance();
+    }
+    return n;
+  }
+  size_t print(const String &text) { return print(text.c_str()); }
+
+private:
+  Adafruit_GFX *_gfx = nullptr;
+  uint8_t _height = 8;
+  bool _transparent = false;
+  uint16_t _fg = 0, _bg = 0xFFFF;
+  int16_t _x = 0, _y = 0;
+
+  int16_t advance() const { return _height * 3 / 5 + 1; }
+  // UTF-8 characters, continuation bytes do not count
+  static size_t glyphs(const char *text) {
+    size_t n = 0;
+    for (; text && *text; text++)
+      n += ((uint8_t)*text & 0xC0) != 0x80;
+    return n;
+  }
+};
+
+#endif
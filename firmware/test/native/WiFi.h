@@ -0,0 +1,138 @@
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+// Host WiFi: connected until something turns the radio off, WiFiClient is
+// a plain TCP socket, so the fetch code can talk to a local test server
+// (see LocalServer.h).
+
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+enum wl_status_t { WL_IDLE_STATUS = 0, WL_CONNECTED = 3, WL_DISCONNECTED = 6 };
+enum wifi_mode_t { WIFI_OFF = 0, WIFI_STA = 1 };
+
+class WiFiClass {
+public:
+  wl_status_t status() const { return _status; }
+  void setStatus(wl_status_t status) { _status = status; }
+
+  bool disconnect(bool = false) {
+    _status = WL_DISCONNECTED;
+    return true;
+  }
+  bool mode(wifi_mode_t mode) {
+    _mode = mode;
+    return true;
+  }
+  wifi_mode_t getMode() const { return _mode; }
+
+private:
+  wl_status_t _status = WL_CONNECTED;
+  wifi_mode_t _mode = WIFI_STA;
+};
+
+inline WiFiClass WiFi;
+
+class WiFiClient : public Stream {
+public:
+  ~WiFiClient() { stop(); }
+
+  int connect(const char *host, uint16_t port) {
+    stop();
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *res;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(host, service, &hints, &res) != 0)
+      return 0;
+    _fd = socket(res->ai_family, res->ai_socktype, 0);
+    if (_fd >= 0 && ::connect(_fd, res->ai_addr, res->ai_addrlen) != 0)
+      stop();
+    freeaddrinfo(res);
+    return _fd >= 0;
+  }
+
+  void stop() {
+    if (_fd >= 0)
+      close(_fd);
+    _fd = -1;
+    _peeked = -1;
+  }
+  bool connected() const { return _fd >= 0; }
+  void setTimeout(unsigned long ms) { _timeoutMs = ms; }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    size_t sent = 0;
+    while (_fd >= 0 && sent < size) {
+      ssize_t n = send(_fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+      if (n <= 0)
+        break;
+      sent += n;
+    }
+    return sent;
+  }
+  using Print::write;
+
+  int available() override {
+    int n = 0;
+    if (_fd >= 0)
+      ioctl(_fd, FIONREAD, &n);
+    return n + (_peeked >= 0);
+  }
+
+  int read() override {
+    int c = peek();
+    _peeked = -1;
+    return c;
+  }
+
+  int peek() override {
+    if (_peeked < 0) {
+      uint8_t c;
+      if (recvWait(&c, 1) == 1)
+        _peeked = c;
+    }
+    return _peeked;
+  }
+
+  // Blocks until length bytes, end of stream or the timeout, like the core
+  size_t readBytes(char *buffer, size_t length) override {
+    size_t n = 0;
+    if (length > 0 && _peeked >= 0) {
+      buffer[n++] = (char)_peeked;
+      _peeked = -1;
+    }
+    while (n < length) {
+      ssize_t got = recvWait(buffer + n, length - n);
+      if (got <= 0)
+        break;
+      n += got;
+    }
+    return n;
+  }
+  using Stream::readBytes;
+
+private:
+  int _fd = -1;
+  int _peeked = -1;
+  unsigned long _timeoutMs = 5000;
+
+  ssize_t recvWait(void *buffer, size_t length) {
+    if (_fd < 0)
+      return -1;
+    pollfd p = {_fd, POLLIN, 0};
+    if (poll(&p, 1, (int)_timeoutMs) <= 0)
+      return -1;
+    return recv(_fd, buffer, length, 0);
+  }
+};
+
+#endif
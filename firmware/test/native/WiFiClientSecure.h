@@ -0,0 +1,12 @@
+#ifndef NATIVE_WIFI_CLIENT_SECURE_H
+#define NATIVE_WIFI_CLIENT_SECURE_H
+
+// No TLS on the host: tests only use http:// endpoints
+#include <WiFi.h>
+
+class WiFiClientSecure : public WiFiClient {
+public:
+  void setInsecure() {}
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef NATIVE_ESP_IOT_UTILS_H
+#define NATIVE_ESP_IOT_UTILS_H
+
+// Host stand-in for esp-iot-utils: ConfigHelper, the legacy per-key store
+// ConfigStore migrates from, backed by a map of strings, the language part
+// of TimeHelper the views read, a WiFiHelper tests can make fail and a
+// UrlHelper without date placeholders.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <WiFi.h>
+#include <map>
+#include <string>
+#include <time.h>
+
+class ConfigHelper {
+public:
+  String get(const char *key, const String &defaultValue) {
+    return has(key) ? String(_values[key]) : defaultValue;
+  }
+  long get(const char *key, long defaultValue) {
+    return has(key) ? atol(_values[key].c_str()) : defaultValue;
+  }
+  int get(const char *key, int defaultValue) {
+    return has(key) ? atoi(_values[key].c_str()) : defaultValue;
+  }
+  bool get(const char *key, JsonDocument &doc) {
+    return has(key) && !deserializeJson(doc, _values[key].c_str());
+  }
+
+  void set(const char *key, const String &value) {
+    _values[key] = value.c_str();
+  }
+  void set(const char *key, const char *value) { _values[key] = value; }
+  void set(const char *key, long value) {
+    _values[key] = std::to_string(value);
+  }
+  void set(const char *key, int value) {
+    _values[key] = std::to_string(value);
+  }
+
+  bool has(const char *key) const { return _values.count(key) != 0; }
+  void clear() { _values.clear(); }
+
+private:
+  std::map<std::string, std::string> _values;
+};
+
+class TimeHelper {
+public:
+  static void setLanguage(const String &language) { lang() = language; }
+  static String getLanguage() { return lang(); }
+  // No wall clock on the host
+  static bool getLocalTime(struct tm *) { return false; }
+
+private:
+  static String &lang() {
+    static String language = "en";
+    return language;
+  }
+};
+
+class WiFiHelper {
+public:
+  // Brings the host WiFi up unless fails() is set; attempts() counts calls
+  static bool connect(const String &, const String &, const String &,
+                      const String &, const String &) {
+    attempts()++;
+    if (fails())
+      return false;
+    WiFi.setStatus(WL_CONNECTED);
+    WiFi.mode(WIFI_STA);
+    return true;
+  }
+
+  static int &attempts() {
+    static int count = 0;
+    return count;
+  }
+  static bool &fails() {
+    static bool fail = false;
+    return fail;
+  }
+};
+
+class UrlHelper {
+public:
+  static String replaceDatePlaceholders(const String &url) { return url; }
+};
+
+#endif
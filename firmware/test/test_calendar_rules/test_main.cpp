@@ -0,0 +1,194 @@
+// Calendar rules over whole simulated years: weekly and biweekly streams,
+// holiday shifts, Feb 29 birthdays, year-end wrap and date validation
+#include "../../src/SolarCalculator.h"
+#include "../../src/config/CalendarRules.h"
+#include <set>
+#include <unity.h>
+
+static CalendarRules rules;
+
+static long day(int year, int month, int mday) {
+  return SolarCalculator::daysFromCivil(year, month, mday);
+}
+
+static int weekday(long d) { return (d % 7 + 11) % 7; } // 0 = Sunday
+
+static void compile(const char *text) {
+  int line;
+  TEST_ASSERT_TRUE_MESSAGE(rules.compile(text, line), text);
+}
+
+// Brute-force reference: every collection of the rule between from and to,
+// moved past holidays one day at a time
+static std::set<long> collections(long anchor, int weeks, long from, long to,
+                                  const std::set<long> &holidays) {
+  std::set<long> out;
+  for (long d = anchor; d <= to; d += 7 * weeks) {
+    long moved = d;
+    while (holidays.count(moved))
+      moved++;
+    if (moved >= from)
+      out.insert(moved);
+  }
+  return out;
+}
+
+// Walks every day of year and checks nextCollection() against reference
+static void checkYear(CalendarRules::Stream stream, int year,
+                      const std::set<long> &expected) {
+  for (long today = day(year, 1, 1); today < day(year + 1, 1, 1); today++) {
+    long next = *expected.lower_bound(today);
+    if (rules.nextCollection(stream, today) != next - today) {
+      int y, m, d;
+      SolarCalculator::civilFromDays(today, y, m, d);
+      char message[48];
+      snprintf(message, sizeof(message),
+               "Wrong next collection on %d-%02d-%02d", y, m, d);
+      TEST_FAIL_MESSAGE(message);
+    }
+  }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_weekly_over_a_year() {
+  compile("black weekly mon");
+  std::set<long> expected =
+      collections(day(2025, 12, 29), 1, day(2026, 1, 1), day(2027, 1, 31), {});
+  checkYear(CalendarRules::BLACK, 2026, expected);
+
+  int collected = 0;
+  for (long d = day(2026, 1, 1); d < day(2027, 1, 1); d++) {
+    if (rules.nextCollection(CalendarRules::BLACK, d) == 0) {
+      TEST_ASSERT_EQUAL(1, weekday(d));
+      collected++;
+    }
+  }
+  TEST_ASSERT_EQUAL(52, collected);
+  TEST_ASSERT_EQUAL(-1, rules.nextCollection(CalendarRules::YELLOW, 0));
+}
+
+void test_biweekly_over_a_year() {
+  compile("yellow biweekly 2026-01-08");
+  std::set<long> expected =
+      collections(day(2026, 1, 8), 2, day(2025, 12, 1), day(2027, 1, 31), {});
+  checkYear(CalendarRules::YELLOW, 2026, expected);
+  // Before the anchor the same fortnightly phase applies
+  TEST_ASSERT_EQUAL(7, rules.nextCollection(CalendarRules::YELLOW,
+                                            day(2026, 1, 1)));
+  TEST_ASSERT_EQUAL(0, rules.nextCollection(CalendarRules::YELLOW,
+                                            day(2026, 12, 24)));
+  TEST_ASSERT_EQUAL(7, rules.nextCollection(CalendarRules::YELLOW,
+                                            day(2026, 12, 31)));
+}
+
+// Christmas 2026 and New Year 2027 fall on Fridays; May 1 and 2 2026 are a
+// Friday and a Saturday, so that collection moves by two days
+void test_holiday_shift_over_a_year() {
+  compile("black weekly fri\n"
+          "holiday 12-25\n"
+          "holiday 01-01\n"
+          "holiday 2026-05-01; holiday 2026-05-02\n"
+          "holiday 2026-07-14 # Tuesday: no collection to move");
+  std::set<long> holidays = {day(2026, 1, 1),  day(2026, 5, 1),
+                             day(2026, 5, 2),  day(2026, 7, 14),
+                             day(2026, 12, 25), day(2027, 1, 1)};
+  std::set<long> expected = collections(day(2025, 12, 26), 1, day(2026, 1, 1),
+                                        day(2027, 1, 31), holidays);
+  checkYear(CalendarRules::BLACK, 2026, expected);
+
+  TEST_ASSERT_EQUAL(2, rules.nextCollection(CalendarRules::BLACK,
+                                            day(2026, 5, 1)));
+  // The shifted collection is still today, not next week's
+  TEST_ASSERT_EQUAL(0, rules.nextCollection(CalendarRules::BLACK,
+                                            day(2026, 12, 26)));
+  TEST_ASSERT_TRUE(rules.isHoliday(day(2030, 12, 25)));
+  TEST_ASSERT_FALSE(rules.isHoliday(day(2027, 5, 1)));
+}
+
+// A Thursday collection on 2026-01-01 moves into the new year's second day;
+// seen from the last days of 2025 it is still the next one
+void test_wrap_at_year_end() {
+  compile("black weekly thu; holiday 01-01");
+  TEST_ASSERT_EQUAL(4, rules.nextCollection(CalendarRules::BLACK,
+                                            day(2025, 12, 29)));
+  TEST_ASSERT_EQUAL(1, rules.nextCollection(CalendarRules::BLACK,
+                                            day(2026, 1, 1)));
+  TEST_ASSERT_EQUAL(0, rules.nextCollection(CalendarRules::BLACK,
+                                            day(2026, 12, 31)));
+  TEST_ASSERT_EQUAL(6, rules.nextCollection(CalendarRules::BLACK,
+                                            day(2027, 1, 1)));
+}
+
+void test_birthdays_wrap_at_year_end() {
+  compile("birthday 01-02 Bob\nbirthday 12-30 Carol\nbirthday 06-01 Dan");
+  CalendarRules::Upcoming out[4];
+  int n = rules.upcoming(day(2026, 12, 29), 7, out, 4);
+  TEST_ASSERT_EQUAL(2, n);
+  TEST_ASSERT_EQUAL_STRING("Carol", out[0].name);
+  TEST_ASSERT_EQUAL(1, out[0].daysUntil);
+  TEST_ASSERT_EQUAL_STRING("Bob", out[1].name);
+  TEST_ASSERT_EQUAL(4, out[1].daysUntil);
+}
+
+// Celebrated on Feb 28 in common years, shown with its real date
+void test_feb_29_birthday_over_two_years() {
+  compile("birthday 02-29 Leap\nbirthday 02-28 Eve");
+  CalendarRules::Upcoming out[2];
+  for (long today = day(2027, 1, 1); today < day(2029, 1, 1); today++) {
+    int n = rules.upcoming(today, 0, out, 2);
+    int y, m, d;
+    SolarCalculator::civilFromDays(today, y, m, d);
+    bool leapDay = m == 2 && d == (y == 2028 ? 29 : 28);
+    bool eveDay = m == 2 && d == 28;
+    TEST_ASSERT_EQUAL(leapDay + eveDay, n);
+  }
+
+  int n = rules.upcoming(day(2027, 2, 20), 30, out, 2);
+  TEST_ASSERT_EQUAL(2, n);
+  TEST_ASSERT_EQUAL_STRING("Leap", out[1].name);
+  TEST_ASSERT_EQUAL(8, out[1].daysUntil);
+  TEST_ASSERT_EQUAL(29, out[1].day);
+
+  n = rules.upcoming(day(2027, 3, 1), 366, out, 2);
+  TEST_ASSERT_EQUAL_STRING("Leap", out[1].name);
+  TEST_ASSERT_EQUAL(day(2028, 2, 29) - day(2027, 3, 1), out[1].daysUntil);
+}
+
+void test_dates_are_checked_against_month_length() {
+  const char *bad[] = {"holiday 02-30",      "holiday 04-31",
+                       "holiday 06-31",      "holiday 2026-02-29",
+                       "birthday 09-31 Ann", "yellow biweekly 2026-11-31"};
+  int line;
+  for (const char *text : bad)
+    TEST_ASSERT_FALSE_MESSAGE(rules.compile(text, line), text);
+
+  compile("holiday 2028-02-29\nholiday 02-29\nholiday 01-31\n"
+          "holiday 04-30\nbirthday 02-29 Leap");
+  TEST_ASSERT_TRUE(rules.isHoliday(day(2028, 2, 29)));
+}
+
+void test_bad_line_is_reported_and_the_rest_applies() {
+  int line;
+  TEST_ASSERT_FALSE(rules.compile(
+      "# collections\nblack weekly tue\nholiday 04-31\nyellow weekly wed",
+      line));
+  TEST_ASSERT_EQUAL(3, line);
+  TEST_ASSERT_EQUAL(0, rules.nextCollection(CalendarRules::YELLOW,
+                                            day(2026, 10, 21)));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_weekly_over_a_year);
+  RUN_TEST(test_biweekly_over_a_year);
+  RUN_TEST(test_holiday_shift_over_a_year);
+  RUN_TEST(test_wrap_at_year_end);
+  RUN_TEST(test_birthdays_wrap_at_year_end);
+  RUN_TEST(test_feb_29_birthday_over_two_years);
+  RUN_TEST(test_dates_are_checked_against_month_length);
+  RUN_TEST(test_bad_line_is_reported_and_the_rest_applies);
+  return UNITY_END();
+}
@@ -0,0 +1,216 @@
+// Packed config record: round trip, first-boot migration, damaged records
+#include "../../src/config/ConfigRecord.h"
+#include <Preferences.h>
+#include <unity.h>
+
+static ConfigHelper legacy;
+
+static void seedLegacy() {
+  legacy.set("ssid", "old-network");
+  legacy.set("ntp_gmt", 7200L);
+  legacy.set("sensorInterval", 120);
+  legacy.set("sensor_0", "{\"label\":\"Power\",\"url\":\"http://p/q\","
+                         "\"enabled\":true,\"decimals\":2}");
+}
+
+static ConfigSnapshot sample() {
+  ConfigSnapshot snap;
+  snap.system.ssid = "home";
+  snap.system.password = "secret";
+  snap.system.gmtOffset = -18000;
+  snap.system.latitude = 48.85f;
+  snap.system.longitude = 2.35f;
+  snap.system.calendar = "black weekly mon";
+  snap.system.icsUrl = "https://example.com/a.ics";
+  snap.sensors[3].label = "Temp";
+  snap.sensors[3].url = "http://h/api";
+  snap.sensors[3].type = "json";
+  snap.sensors[3].jsonPath = "data.values[0]";
+  snap.sensors[3].enabled = true;
+  snap.sensors[3].interval = 86400;
+  snap.sensors[3].deadbandMode = "rel";
+  snap.sensors[7].label = "Temp"; // Interned once
+  return snap;
+}
+
+// Flips one byte of the stored record
+static void damageRecord() {
+  Preferences prefs;
+  prefs.begin("cfgrec");
+  std::vector<uint8_t> buf(prefs.getBytesLength("record"));
+  prefs.getBytes("record", buf.data(), buf.size());
+  buf[buf.size() / 2] ^= 0x5A;
+  prefs.putBytes("record", buf.data(), buf.size());
+  prefs.end();
+}
+
+void setUp() {
+  Preferences::eraseAll();
+  legacy.clear();
+}
+
+void tearDown() {}
+
+void test_encode_decode_round_trip() {
+  ConfigSnapshot in = sample();
+  std::vector<uint8_t> buf;
+  ConfigRecord::encode(in, buf);
+
+  ConfigSnapshot out;
+  TEST_ASSERT_TRUE(ConfigRecord::decode(buf.data(), buf.size(), out));
+  TEST_ASSERT_EQUAL(0, ConfigStore::diff(in, out).size());
+
+  buf[buf.size() - 2] ^= 1; // CRC covers the string area
+  TEST_ASSERT_FALSE(ConfigRecord::decode(buf.data(), buf.size(), out));
+}
+
+void test_first_boot_migrates_legacy_keys_once() {
+  seedLegacy();
+  ConfigStore store(legacy);
+  store.load();
+
+  const ConfigSnapshot &snap = store.current();
+  TEST_ASSERT_EQUAL_STRING("old-network", snap.system.ssid.c_str());
+  TEST_ASSERT_EQUAL(7200, snap.system.gmtOffset);
+  TEST_ASSERT_EQUAL(120, snap.system.sensorInterval);
+  TEST_ASSERT_EQUAL_STRING("Power", snap.sensors[0].label.c_str());
+  TEST_ASSERT_TRUE(snap.sensors[0].enabled);
+  TEST_ASSERT_EQUAL(0, snap.system.netTolerance); // Newer than the record
+  TEST_ASSERT_GREATER_THAN(0, store.recordSize());
+
+  // Later boots read the record, even if the legacy keys change
+  legacy.set("ssid", "stale");
+  ConfigStore again(legacy);
+  again.load();
+  TEST_ASSERT_EQUAL_STRING("old-network",
+                           again.current().system.ssid.c_str());
+}
+
+void test_damaged_record_falls_back_to_defaults() {
+  seedLegacy();
+  ConfigStore first(legacy);
+  first.load(); // Migrates and writes the record
+  damageRecord();
+
+  ConfigSnapshot snap;
+  size_t size;
+  TEST_ASSERT_EQUAL(ConfigRecord::Status::CORRUPT,
+                    ConfigRecord::load(snap, size));
+
+  ConfigStore store(legacy);
+  store.load();
+  TEST_ASSERT_EQUAL_STRING("", store.current().system.ssid.c_str());
+  TEST_ASSERT_EQUAL(3600, store.current().system.gmtOffset);
+  TEST_ASSERT_FALSE(store.current().sensors[0].enabled);
+}
+
+void test_lost_record_is_not_migrated_again() {
+  seedLegacy();
+  ConfigStore first(legacy);
+  first.load();
+
+  Preferences prefs;
+  prefs.begin("cfgrec");
+  prefs.remove("record");
+  prefs.end();
+
+  ConfigStore store(legacy);
+  store.load();
+  TEST_ASSERT_EQUAL_STRING("", store.current().system.ssid.c_str());
+}
+
+void test_commit_writes_only_on_change() {
+  ConfigStore store(legacy);
+  store.load();
+  uint32_t written = store.bytesWritten();
+
+  std::vector<String> changed;
+  store.stage();
+  TEST_ASSERT_TRUE(store.commit(changed));
+  TEST_ASSERT_EQUAL(0, changed.size());
+  TEST_ASSERT_EQUAL_UINT32(written, store.bytesWritten());
+
+  store.stage()->sensors[2].label = "Hum";
+  TEST_ASSERT_TRUE(store.commit(changed));
+  TEST_ASSERT_EQUAL(1, changed.size());
+  TEST_ASSERT_GREATER_THAN(written, store.bytesWritten());
+  TEST_ASSERT_EQUAL(2, store.generation());
+
+  ConfigSnapshot reloaded;
+  size_t size;
+  TEST_ASSERT_EQUAL(ConfigRecord::Status::OK,
+                    ConfigRecord::load(reloaded, size));
+  TEST_ASSERT_EQUAL_STRING("Hum", reloaded.sensors[2].label.c_str());
+}
+
+void test_stage_waits_for_quiesce() {
+  ConfigStore store(legacy);
+  store.load();
+
+  std::vector<String> changed;
+  store.stage()->sensors[2].label = "Hum";
+  TEST_ASSERT_TRUE(store.commit(changed));
+
+  // The main loop may still read the buffer the next stage() would reuse
+  TEST_ASSERT_NULL(store.stage());
+  store.quiesce();
+  ConfigSnapshot *next = store.stage();
+  TEST_ASSERT_NOT_NULL(next);
+  TEST_ASSERT_EQUAL_STRING("Hum", next->sensors[2].label.c_str());
+}
+
+void test_failed_write_is_not_published() {
+  ConfigStore store(legacy);
+  store.load();
+  store.takeChanges();
+  uint32_t written = store.bytesWritten();
+
+  std::vector<String> changed;
+  store.stage()->sensors[2].label = "Hum";
+  Preferences::failWrites() = true;
+  bool ok = store.commit(changed);
+  Preferences::failWrites() = false;
+
+  TEST_ASSERT_FALSE(ok);
+  TEST_ASSERT_EQUAL_UINT32(written, store.bytesWritten());
+  TEST_ASSERT_EQUAL(1, store.generation());
+  TEST_ASSERT_EQUAL_STRING("", store.current().sensors[2].label.c_str());
+  TEST_ASSERT_TRUE(store.takeChanges().empty());
+}
+
+void test_system_from_json_applies_zero_values() {
+  SystemConfig system;
+  system.gmtOffset = 3600;
+  system.dstOffset = 3600;
+  system.bleTimeout = 15;
+  system.sensorStyle = 2;
+  system.moduleMap = "clock";
+
+  JsonDocument doc;
+  doc["gmt"] = 0;
+  doc["dst"] = 0;
+  doc["bleTimeout"] = 0;
+  doc["style"] = 0;
+  doc["module_map"] = "";
+  SystemConfigHelper::fromJson(doc.as<JsonObjectConst>(), system);
+
+  TEST_ASSERT_EQUAL(0, system.gmtOffset);
+  TEST_ASSERT_EQUAL(0, system.dstOffset);
+  TEST_ASSERT_EQUAL(0, system.bleTimeout);
+  TEST_ASSERT_EQUAL(0, system.sensorStyle);
+  TEST_ASSERT_EQUAL_STRING("", system.moduleMap.c_str());
+  TEST_ASSERT_EQUAL(60, system.sensorInterval); // Absent, left alone
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_encode_decode_round_trip);
+  RUN_TEST(test_first_boot_migrates_legacy_keys_once);
+  RUN_TEST(test_damaged_record_falls_back_to_defaults);
+  RUN_TEST(test_lost_record_is_not_migrated_again);
+  RUN_TEST(test_commit_writes_only_on_change);
+  RUN_TEST(test_stage_waits_for_quiesce);
+  RUN_TEST(test_failed_write_is_not_published);
+  RUN_TEST(test_system_from_json_applies_zero_values);
+  return UNITY_END();
+}
@@ -0,0 +1,155 @@
+// Incremental sync protocol: manifest diff, section requests, MessagePack
+#include "../../src/config/ConfigSync.h"
+#include <unity.h>
+
+static ConfigSnapshot sample() {
+  ConfigSnapshot snap;
+  snap.generation = 4;
+  snap.system.ssid = "home";
+  snap.system.password = "secret";
+  snap.system.language = "fr";
+  snap.sensors[3].label = "Temp";
+  snap.sensors[3].url = "http://h/api";
+  snap.sensors[3].type = "json";
+  snap.sensors[3].jsonPath = "data.values[0]";
+  snap.sensors[3].divisor = 10;
+  snap.sensors[3].enabled = true;
+  snap.sensors[5].label = "Power";
+  snap.sensors[5].unit = "kW";
+  return snap;
+}
+
+// Slots whose hash differs between two manifests, as a bit mask
+static uint32_t changedSlots(JsonVariantConst a, JsonVariantConst b) {
+  uint32_t mask = 0;
+  for (int i = 0; i < SENSOR_SLOTS; i++) {
+    if (a["sensors"][i].as<uint32_t>() != b["sensors"][i].as<uint32_t>())
+      mask |= 1u << i;
+  }
+  return mask;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_manifest_lists_every_section() {
+  JsonDocument doc;
+  ConfigSync::writeManifest(sample(), doc.to<JsonVariant>());
+
+  TEST_ASSERT_EQUAL(ConfigSync::PROTOCOL_VERSION, doc["v"].as<int>());
+  TEST_ASSERT_EQUAL(4, doc["generation"].as<int>());
+  TEST_ASSERT_TRUE(doc["system"].is<uint32_t>());
+  TEST_ASSERT_EQUAL(SENSOR_SLOTS, doc["sensors"].size());
+  // Untouched slots hash alike, edited ones apart
+  TEST_ASSERT_EQUAL_UINT32(doc["sensors"][0].as<uint32_t>(),
+                           doc["sensors"][1].as<uint32_t>());
+  TEST_ASSERT_NOT_EQUAL(doc["sensors"][0].as<uint32_t>(),
+                        doc["sensors"][3].as<uint32_t>());
+}
+
+void test_manifest_diff_names_only_edited_sections() {
+  ConfigSnapshot before = sample();
+  ConfigSnapshot after = before;
+  after.sensors[5].divisor = 1000;
+  after.sensors[9].enabled = true;
+
+  JsonDocument a, b;
+  ConfigSync::writeManifest(before, a.to<JsonVariant>());
+  ConfigSync::writeManifest(after, b.to<JsonVariant>());
+
+  TEST_ASSERT_EQUAL_UINT32((1u << 5) | (1u << 9), changedSlots(a, b));
+  TEST_ASSERT_EQUAL_UINT32(a["system"].as<uint32_t>(),
+                           b["system"].as<uint32_t>());
+}
+
+void test_password_does_not_change_the_system_hash() {
+  ConfigSnapshot snap = sample();
+  uint32_t hash = ConfigSync::hashSystem(snap.system);
+  snap.system.password = "changed";
+  TEST_ASSERT_EQUAL_UINT32(hash, ConfigSync::hashSystem(snap.system));
+  snap.system.language = "de";
+  TEST_ASSERT_NOT_EQUAL(hash, ConfigSync::hashSystem(snap.system));
+}
+
+void test_sections_carry_only_what_was_asked() {
+  JsonDocument request;
+  deserializeJson(request, "{\"system\":false,\"sensors\":[3,99,-1]}");
+
+  JsonDocument doc;
+  ConfigSync::writeSections(sample(), request.as<JsonVariantConst>(),
+                            doc.to<JsonVariant>());
+
+  TEST_ASSERT_EQUAL(4, doc["generation"].as<int>());
+  TEST_ASSERT_TRUE(doc["system"].isNull());
+  TEST_ASSERT_EQUAL(1, doc["sensors"].size());
+  TEST_ASSERT_EQUAL_STRING("Temp",
+                           doc["sensors"]["3"]["label"].as<const char *>());
+}
+
+void test_apply_index_map_leaves_other_slots() {
+  ConfigSnapshot snap = sample();
+  JsonDocument doc;
+  deserializeJson(doc, "{\"5\":{\"label\":\"Grid\",\"enabled\":true},"
+                       "\"16\":{\"label\":\"x\"},\"a\":{}}");
+
+  ConfigSync::applySensors(doc.as<JsonVariantConst>(), snap);
+
+  TEST_ASSERT_EQUAL_STRING("Grid", snap.sensors[5].label.c_str());
+  TEST_ASSERT_EQUAL_STRING("", snap.sensors[5].unit.c_str()); // Replaced
+  TEST_ASSERT_TRUE(snap.sensors[3] == sample().sensors[3]);
+}
+
+void test_apply_full_array_replaces_leading_slots() {
+  ConfigSnapshot snap = sample();
+  JsonDocument doc;
+  deserializeJson(doc, "[{\"label\":\"A\"},{\"label\":\"B\"}]");
+
+  ConfigSync::applySensors(doc.as<JsonVariantConst>(), snap);
+
+  TEST_ASSERT_EQUAL_STRING("A", snap.sensors[0].label.c_str());
+  TEST_ASSERT_EQUAL_STRING("B", snap.sensors[1].label.c_str());
+  TEST_ASSERT_TRUE(snap.sensors[3] == sample().sensors[3]);
+}
+
+// The app pulls the changed sections as MessagePack, edits them and pushes
+// them back: the device must end up with identical hashes
+void test_msgpack_round_trip_keeps_hashes() {
+  ConfigSnapshot device = sample();
+
+  JsonDocument request;
+  deserializeJson(request, "{\"system\":true,\"sensors\":[3,5]}");
+  JsonDocument sections;
+  ConfigSync::writeSections(device, request.as<JsonVariantConst>(),
+                            sections.to<JsonVariant>());
+
+  std::vector<uint8_t> wire(measureMsgPack(sections));
+  serializeMsgPack(sections, wire.data(), wire.size());
+  JsonDocument received;
+  TEST_ASSERT_FALSE(deserializeMsgPack(received, wire.data(), wire.size()));
+
+  ConfigSnapshot copy;
+  SystemConfigHelper::fromJson(received["system"].as<JsonObjectConst>(),
+                               copy.system);
+  ConfigSync::applySensors(received["sensors"].as<JsonVariantConst>(), copy);
+
+  TEST_ASSERT_EQUAL_UINT32(ConfigSync::hashSystem(device.system),
+                           ConfigSync::hashSystem(copy.system));
+  for (int i : {3, 5}) {
+    TEST_ASSERT_TRUE(copy.sensors[i] == device.sensors[i]);
+    TEST_ASSERT_EQUAL_UINT32(ConfigSync::hashSensor(device.sensors[i]),
+                             ConfigSync::hashSensor(copy.sensors[i]));
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_manifest_lists_every_section);
+  RUN_TEST(test_manifest_diff_names_only_edited_sections);
+  RUN_TEST(test_password_does_not_change_the_system_hash);
+  RUN_TEST(test_sections_carry_only_what_was_asked);
+  RUN_TEST(test_apply_index_map_leaves_other_slots);
+  RUN_TEST(test_apply_full_array_replaces_leading_slots);
+  RUN_TEST(test_msgpack_round_trip_keeps_hashes);
+  return UNITY_END();
+}
@@ -0,0 +1,292 @@
+// iCalendar pull parser on fixture feeds: folding, RRULE expansion, EXDATE,
+// RECURRENCE-ID overrides on either side of their series, cancelled
+// instances and a multi-megabyte feed
+#include "../../src/SolarCalculator.h"
+#include "../../src/network/IcsParser.h"
+#include <string>
+#include <unity.h>
+
+// Socket stand-in handing the feed out a few bytes at a time
+class FeedStream : public Stream {
+public:
+  explicit FeedStream(const std::string &body) : _body(body) {}
+
+  int available() override {
+    return (int)std::min<size_t>(_body.size() - _pos, 11);
+  }
+  int read() override {
+    return _pos < _body.size() ? (uint8_t)_body[_pos++] : -1;
+  }
+  int peek() override {
+    return _pos < _body.size() ? (uint8_t)_body[_pos] : -1;
+  }
+
+private:
+  const std::string &_body;
+  size_t _pos = 0;
+};
+
+static IcsParser::Occurrence found[IcsParser::MAX_EVENTS];
+
+static time_t utc(int year, int month, int mday, int hour = 0,
+                  int minute = 0) {
+  return (time_t)SolarCalculator::daysFromCivil(year, month, mday) * 86400 +
+         hour * 3600 + minute * 60;
+}
+
+// Events of body starting in [from, to), CRLF line ends as served
+static int parse(const std::string &events, time_t from, time_t to,
+                 int max = IcsParser::MAX_EVENTS) {
+  std::string body = "BEGIN:VCALENDAR\nVERSION:2.0\nPRODID:-//test//EN\n" +
+                     events + "END:VCALENDAR\n";
+  std::string crlf;
+  for (char c : body)
+    crlf += c == '\n' ? std::string("\r\n") : std::string(1, c);
+  FeedStream stream(crlf);
+  return IcsParser::upcoming(stream, from, to, found, max);
+}
+
+static const time_t FROM = utc(2026, 10, 19);
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_folded_lines_are_joined() {
+  int n = parse("BEGIN:VEVENT\n"
+                "UID:fold@test\n"
+                "SUMMARY:Team re\n"
+                " view\\, budget\n"
+                "DTSTART:2026102\n"
+                "\t0T093000Z\n"
+                "END:VEVENT\n",
+                FROM, FROM + 30 * 86400);
+  TEST_ASSERT_EQUAL(1, n);
+  TEST_ASSERT_EQUAL_STRING("Team review, budget", found[0].summary);
+  TEST_ASSERT_EQUAL(utc(2026, 10, 20, 9, 30), found[0].start);
+}
+
+void test_long_summary_keeps_whole_characters() {
+  // 21 ASCII bytes then a 3-byte character that would straddle the limit
+  int n = parse("BEGIN:VEVENT\nUID:utf8@test\n"
+                "SUMMARY:Reunion d'equipe Q42 \xE2\x82\xAC budget\n"
+                "DTSTART;VALUE=DATE:20261021\nEND:VEVENT\n",
+                FROM, FROM + 30 * 86400);
+  TEST_ASSERT_EQUAL(1, n);
+  TEST_ASSERT_EQUAL_STRING("Reunion d'equipe Q42 ", found[0].summary);
+  TEST_ASSERT_TRUE(found[0].allDay);
+}
+
+void test_weekly_byday() {
+  int n = parse("BEGIN:VEVENT\nUID:gym@test\nSUMMARY:Gym\n"
+                "DTSTART:20260105T180000Z\n"
+                "RRULE:FREQ=WEEKLY;BYDAY=MO,WE,FR\nEND:VEVENT\n",
+                FROM, utc(2026, 11, 1));
+  const time_t expected[] = {utc(2026, 10, 19, 18), utc(2026, 10, 21, 18),
+                             utc(2026, 10, 23, 18), utc(2026, 10, 26, 18),
+                             utc(2026, 10, 28, 18), utc(2026, 10, 30, 18)};
+  TEST_ASSERT_EQUAL(6, n);
+  for (int i = 0; i < n; i++)
+    TEST_ASSERT_EQUAL(expected[i], found[i].start);
+}
+
+void test_weekly_interval_two() {
+  int n = parse("BEGIN:VEVENT\nUID:bin@test\nSUMMARY:Bins\n"
+                "DTSTART;VALUE=DATE:20260108\n"
+                "RRULE:FREQ=WEEKLY;INTERVAL=2\nEND:VEVENT\n",
+                FROM, utc(2026, 12, 1));
+  TEST_ASSERT_EQUAL(3, n); // Oct 29, Nov 12, Nov 26
+  TEST_ASSERT_EQUAL(utc(2026, 10, 29), found[0].start);
+  TEST_ASSERT_EQUAL(utc(2026, 11, 26), found[2].start);
+}
+
+void test_monthly_last_friday() {
+  int n = parse("BEGIN:VEVENT\nUID:drinks@test\nSUMMARY:Drinks\n"
+                "DTSTART:20260130T170000Z\n"
+                "RRULE:FREQ=MONTHLY;BYDAY=-1FR\nEND:VEVENT\n",
+                utc(2026, 10, 1), utc(2027, 2, 1));
+  const time_t expected[] = {utc(2026, 10, 30, 17), utc(2026, 11, 27, 17),
+                             utc(2026, 12, 25, 17), utc(2027, 1, 29, 17)};
+  TEST_ASSERT_EQUAL(4, n);
+  for (int i = 0; i < n; i++)
+    TEST_ASSERT_EQUAL(expected[i], found[i].start);
+}
+
+// COUNT is counted from DTSTART, also across instances before the window
+void test_count_and_until() {
+  int n = parse("BEGIN:VEVENT\nUID:course@test\nSUMMARY:Course\n"
+                "DTSTART:20261006T080000Z\n"
+                "RRULE:FREQ=WEEKLY;BYDAY=TU,TH;COUNT=6\nEND:VEVENT\n"
+                "BEGIN:VEVENT\nUID:daily@test\nSUMMARY:Daily\n"
+                "DTSTART:20261017T120000Z\n"
+                "RRULE:FREQ=DAILY;COUNT=5\nEND:VEVENT\n",
+                FROM, utc(2026, 12, 1));
+  const time_t expected[] = {utc(2026, 10, 19, 12), utc(2026, 10, 20, 8),
+                             utc(2026, 10, 20, 12), utc(2026, 10, 21, 12),
+                             utc(2026, 10, 22, 8)};
+  TEST_ASSERT_EQUAL(5, n);
+  for (int i = 0; i < n; i++)
+    TEST_ASSERT_EQUAL(expected[i], found[i].start);
+
+  // UNTIL as a UTC time and as a date (inclusive)
+  n = parse("BEGIN:VEVENT\nUID:u1@test\nSUMMARY:Until\n"
+            "DTSTART:20261007T090000Z\n"
+            "RRULE:FREQ=WEEKLY;UNTIL=20261028T090000Z\nEND:VEVENT\n"
+            "BEGIN:VEVENT\nUID:u2@test\nSUMMARY:Until date\n"
+            "DTSTART;VALUE=DATE:20261001\n"
+            "RRULE:FREQ=DAILY;INTERVAL=10;UNTIL=20261031\nEND:VEVENT\n",
+            FROM, utc(2026, 12, 1));
+  TEST_ASSERT_EQUAL(4, n); // Oct 21 and 31, Oct 21 and 28 09:00
+  TEST_ASSERT_EQUAL(utc(2026, 10, 21), found[0].start);
+  TEST_ASSERT_EQUAL(utc(2026, 10, 21, 9), found[1].start);
+  TEST_ASSERT_EQUAL(utc(2026, 10, 28, 9), found[2].start);
+  TEST_ASSERT_EQUAL(utc(2026, 10, 31), found[3].start);
+}
+
+void test_exdate_drops_instances() {
+  int n = parse("BEGIN:VEVENT\nUID:standup@test\nSUMMARY:Standup\n"
+                "DTSTART:20260105T090000Z\n"
+                "RRULE:FREQ=WEEKLY;BYDAY=MO\n"
+                "EXDATE:20261026T090000Z,20261109T090000Z\n"
+                "END:VEVENT\n"
+                "BEGIN:VEVENT\nUID:day@test\nSUMMARY:Day off\n"
+                "DTSTART;VALUE=DATE:20261019\n"
+                "RRULE:FREQ=DAILY;COUNT=4\n"
+                "EXDATE;VALUE=DATE:20261020\nEXDATE;VALUE=DATE:20261021\n"
+                "END:VEVENT\n",
+                FROM, utc(2026, 11, 17));
+  const time_t expected[] = {utc(2026, 10, 19), utc(2026, 10, 19, 9),
+                             utc(2026, 10, 22), utc(2026, 11, 2, 9),
+                             utc(2026, 11, 16, 9)};
+  TEST_ASSERT_EQUAL(5, n);
+  for (int i = 0; i < n; i++)
+    TEST_ASSERT_EQUAL(expected[i], found[i].start);
+}
+
+static const char *SERIES = "BEGIN:VEVENT\nUID:sync@test\nSUMMARY:Sync\n"
+                            "DTSTART:20260105T090000Z\n"
+                            "RRULE:FREQ=WEEKLY;BYDAY=MO\nEND:VEVENT\n";
+static const char *MOVED = "BEGIN:VEVENT\nUID:sync@test\nSUMMARY:Sync moved\n"
+                           "RECURRENCE-ID:20261026T090000Z\n"
+                           "DTSTART:20261027T140000Z\nEND:VEVENT\n";
+
+static void checkMoved(int n) {
+  TEST_ASSERT_EQUAL(3, n);
+  TEST_ASSERT_EQUAL(utc(2026, 10, 19, 9), found[0].start);
+  TEST_ASSERT_EQUAL(utc(2026, 10, 27, 14), found[1].start);
+  TEST_ASSERT_EQUAL_STRING("Sync moved", found[1].summary);
+  TEST_ASSERT_EQUAL(found[0].uid, found[1].uid);
+  TEST_ASSERT_EQUAL(utc(2026, 11, 2, 9), found[2].start);
+}
+
+void test_override_after_the_series() {
+  checkMoved(parse(std::string(SERIES) + MOVED, FROM, utc(2026, 11, 3)));
+}
+
+void test_override_before_the_series() {
+  checkMoved(parse(std::string(MOVED) + SERIES, FROM, utc(2026, 11, 3)));
+}
+
+void test_cancelled_instance_and_event() {
+  const char *cancelled = "BEGIN:VEVENT\nUID:sync@test\nSUMMARY:Sync\n"
+                          "RECURRENCE-ID:20261026T090000Z\n"
+                          "DTSTART:20261026T090000Z\n"
+                          "STATUS:CANCELLED\nEND:VEVENT\n"
+                          "BEGIN:VEVENT\nUID:party@test\nSUMMARY:Party\n"
+                          "DTSTART:20261024T200000Z\n"
+                          "STATUS:CANCELLED\nEND:VEVENT\n";
+  for (int order = 0; order < 2; order++) {
+    std::string feed = order ? std::string(cancelled) + SERIES
+                             : std::string(SERIES) + cancelled;
+    int n = parse(feed, FROM, utc(2026, 11, 3));
+    TEST_ASSERT_EQUAL(2, n);
+    TEST_ASSERT_EQUAL(utc(2026, 10, 19, 9), found[0].start);
+    TEST_ASSERT_EQUAL(utc(2026, 11, 2, 9), found[1].start);
+  }
+}
+
+void test_alarm_properties_stay_out_of_the_event() {
+  int n = parse("BEGIN:VEVENT\nUID:alarm@test\nSUMMARY:Dentist\n"
+                "DTSTART:20261022T083000Z\n"
+                "BEGIN:VALARM\nACTION:DISPLAY\nSUMMARY:Reminder\n"
+                "DTSTART:20261001T000000Z\nEND:VALARM\nEND:VEVENT\n",
+                FROM, utc(2026, 11, 1));
+  TEST_ASSERT_EQUAL(1, n);
+  TEST_ASSERT_EQUAL_STRING("Dentist", found[0].summary);
+  TEST_ASSERT_EQUAL(utc(2026, 10, 22, 8, 30), found[0].start);
+}
+
+// Years of history with long folded descriptions and alarms, a series and
+// a handful of upcoming events at the very end: only the soonest are kept
+void test_multi_megabyte_feed() {
+  std::string events;
+  std::string description = "DESCRIPTION:";
+  for (int i = 0; i < 20; i++)
+    description += "Lorem ipsum dolor sit amet, consectetur adipiscing\n ";
+  description += "elit.\n";
+  char line[96];
+  for (int i = 0; i < 12000; i++) {
+    long day = SolarCalculator::daysFromCivil(2018, 1, 1) + i / 5;
+    int y, m, d;
+    SolarCalculator::civilFromDays(day, y, m, d);
+    snprintf(line, sizeof(line),
+             "BEGIN:VEVENT\nUID:past-%d@test\nSUMMARY:Past %d\n"
+             "DTSTART:%04d%02d%02dT%02d0000Z\n",
+             i, i, y, m, d, 8 + i % 5);
+    events += line;
+    events += description;
+    events += "BEGIN:VALARM\nTRIGGER:-PT15M\nACTION:DISPLAY\nEND:VALARM\n"
+              "END:VEVENT\n";
+  }
+  events += SERIES;
+  for (int i = 0; i < 20; i++) {
+    snprintf(line, sizeof(line),
+             "BEGIN:VEVENT\nUID:soon-%d@test\nSUMMARY:Soon %d\n"
+             "DTSTART:202610%02dT150000Z\nEND:VEVENT\n",
+             i, i, 30 - i);
+    events += line;
+  }
+  TEST_ASSERT_GREATER_THAN(4 * 1024 * 1024, events.size());
+
+  int n = parse(events, FROM, utc(2026, 12, 1), 6);
+  TEST_ASSERT_EQUAL(6, n);
+  TEST_ASSERT_EQUAL(utc(2026, 10, 19, 9), found[0].start); // Series
+  TEST_ASSERT_EQUAL_STRING("Sync", found[0].summary);
+  TEST_ASSERT_EQUAL_STRING("Soon 11", found[1].summary); // Oct 19 15:00
+  for (int i = 1; i < n; i++)
+    TEST_ASSERT_LESS_OR_EQUAL(found[i].start, found[i - 1].start);
+  TEST_ASSERT_EQUAL(utc(2026, 10, 23, 15), found[5].start);
+}
+
+void test_not_a_calendar() {
+  std::string html = "<html><body>404 Not Found</body></html>\r\n";
+  FeedStream stream(html);
+  TEST_ASSERT_EQUAL(-1, IcsParser::upcoming(stream, FROM, FROM + 86400,
+                                            found, IcsParser::MAX_EVENTS));
+  std::string empty;
+  FeedStream none(empty);
+  TEST_ASSERT_EQUAL(-1, IcsParser::upcoming(none, FROM, FROM + 86400, found,
+                                            IcsParser::MAX_EVENTS));
+}
+
+int main() {
+  // Floating and TZID times are device local time: make that UTC here
+  setenv("TZ", "UTC0", 1);
+  tzset();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_folded_lines_are_joined);
+  RUN_TEST(test_long_summary_keeps_whole_characters);
+  RUN_TEST(test_weekly_byday);
+  RUN_TEST(test_weekly_interval_two);
+  RUN_TEST(test_monthly_last_friday);
+  RUN_TEST(test_count_and_until);
+  RUN_TEST(test_exdate_drops_instances);
+  RUN_TEST(test_override_after_the_series);
+  RUN_TEST(test_override_before_the_series);
+  RUN_TEST(test_cancelled_instance_and_event);
+  RUN_TEST(test_alarm_properties_stay_out_of_the_event);
+  RUN_TEST(test_multi_megabyte_feed);
+  RUN_TEST(test_not_a_calendar);
+  return UNITY_END();
+}
@@ -0,0 +1,166 @@
+// JsonArena: in-place reallocate, newest-block release, rewind, overflow,
+// and a soak of document-like lifetimes checking for overlap and leaks
+#include "../../src/JsonArena.h"
+#include <unity.h>
+#include <vector>
+
+static const size_t CAPACITY = 4096;
+static JsonArena *arena;
+
+static bool inArena(const void *p, const void *start) {
+  return p >= start && (const uint8_t *)p < (const uint8_t *)start + CAPACITY;
+}
+
+void setUp() { arena = new JsonArena("test", CAPACITY); }
+
+void tearDown() { delete arena; }
+
+void test_blocks_are_aligned_and_consecutive() {
+  uint8_t *a = (uint8_t *)arena->allocate(3);
+  uint8_t *b = (uint8_t *)arena->allocate(17);
+  uint8_t *c = (uint8_t *)arena->allocate(8);
+  TEST_ASSERT_EQUAL(0, (uintptr_t)a % 8);
+  TEST_ASSERT_EQUAL(0, (uintptr_t)b % 8);
+  TEST_ASSERT_EQUAL(8 + 8, b - a);  // Header + 3 rounded up
+  TEST_ASSERT_EQUAL(8 + 24, c - b); // Header + 17 rounded up
+  TEST_ASSERT_EQUAL(8 + 8 + 8 + 24 + 8 + 8, arena->highWater());
+}
+
+void test_newest_block_grows_in_place() {
+  arena->allocate(16);
+  char *s = (char *)arena->allocate(4);
+  memcpy(s, "abc", 4);
+  char *grown = (char *)arena->reallocate(s, 200);
+  TEST_ASSERT_EQUAL_PTR(s, grown);
+  TEST_ASSERT_EQUAL_STRING("abc", grown);
+  // The next block starts after the grown size
+  uint8_t *next = (uint8_t *)arena->allocate(1);
+  TEST_ASSERT_EQUAL(8 + 200, next - (uint8_t *)grown);
+  TEST_ASSERT_EQUAL(0, arena->overflows());
+}
+
+void test_newest_block_shrinks_in_place() {
+  uint8_t *pool = (uint8_t *)arena->allocate(1024);
+  uint8_t *shrunk = (uint8_t *)arena->reallocate(pool, 40);
+  TEST_ASSERT_EQUAL_PTR(pool, shrunk);
+  // The freed tail is reused by the next block
+  uint8_t *next = (uint8_t *)arena->allocate(1);
+  TEST_ASSERT_EQUAL(8 + 40, next - shrunk);
+}
+
+void test_older_block_moves_and_keeps_its_content() {
+  char *a = (char *)arena->allocate(8);
+  memcpy(a, "payload", 8);
+  arena->allocate(8);
+  char *moved = (char *)arena->reallocate(a, 64);
+  TEST_ASSERT_TRUE(moved != a);
+  TEST_ASSERT_EQUAL_STRING("payload", moved);
+  // Shrinking an older block keeps it where it is
+  char *b = (char *)arena->allocate(8);
+  arena->allocate(8);
+  TEST_ASSERT_EQUAL_PTR(b, arena->reallocate(b, 4));
+}
+
+void test_releasing_the_newest_block_gives_its_space_back() {
+  arena->allocate(32);
+  void *b = arena->allocate(100);
+  arena->deallocate(b);
+  TEST_ASSERT_EQUAL_PTR(b, arena->allocate(50));
+}
+
+void test_releasing_the_last_block_rewinds() {
+  void *a = arena->allocate(32);
+  void *b = arena->allocate(32);
+  void *c = arena->allocate(32);
+  arena->deallocate(a); // Not the newest: the space stays taken
+  TEST_ASSERT_TRUE(arena->allocate(8) > c);
+  arena->deallocate(c);
+  arena->deallocate(b);
+  TEST_ASSERT_TRUE(arena->allocate(8) > a); // One block still live
+}
+
+void test_all_released_rewinds_to_the_start() {
+  void *a = arena->allocate(32);
+  void *b = arena->allocate(32);
+  arena->deallocate(a);
+  arena->deallocate(b);
+  TEST_ASSERT_EQUAL_PTR(a, arena->allocate(500));
+}
+
+void test_overflow_falls_back_to_the_heap() {
+  void *start = arena->allocate(8);
+  void *big = arena->allocate(CAPACITY);
+  TEST_ASSERT_NOT_NULL(big);
+  TEST_ASSERT_FALSE(inArena(big, start));
+  TEST_ASSERT_EQUAL(1, arena->overflows());
+  // Growing past the end also leaves the arena
+  void *grown = arena->reallocate(start, CAPACITY);
+  TEST_ASSERT_FALSE(inArena(grown, start));
+  TEST_ASSERT_EQUAL(2, arena->overflows());
+  arena->deallocate(big);
+  arena->deallocate(grown);
+  TEST_ASSERT_EQUAL_PTR(start, arena->allocate(8)); // Rewound
+}
+
+// Documents come and go in bursts: a pool and a few strings that grow and
+// shrink, then everything is released. Every block is filled with its own
+// pattern and checked before release, so overlapping blocks would show.
+void test_soak_has_no_overlap_and_no_fragmentation() {
+  struct Block {
+    uint8_t *ptr;
+    size_t size;
+    uint8_t tag;
+  };
+  void *start = arena->allocate(1);
+  arena->deallocate(start);
+
+  srand(42);
+  uint8_t tag = 0;
+  for (int cycle = 0; cycle < 20000; cycle++) {
+    std::vector<Block> blocks;
+    int count = 1 + rand() % 12;
+    for (int i = 0; i < count; i++) {
+      size_t size = 1 + rand() % 200;
+      Block b = {(uint8_t *)arena->allocate(size), size, ++tag};
+      memset(b.ptr, b.tag, b.size);
+      if (rand() % 3 == 0) {
+        size_t newSize = 1 + rand() % 300;
+        b.ptr = (uint8_t *)arena->reallocate(b.ptr, newSize);
+        if (newSize > b.size)
+          memset(b.ptr + b.size, b.tag, newSize - b.size);
+        b.size = newSize;
+      }
+      blocks.push_back(b);
+    }
+    while (!blocks.empty()) {
+      size_t i = rand() % blocks.size();
+      for (size_t j = 0; j < blocks[i].size; j++) {
+        if (blocks[i].ptr[j] != blocks[i].tag)
+          TEST_FAIL_MESSAGE("Block overwritten by another block");
+      }
+      arena->deallocate(blocks[i].ptr);
+      blocks.erase(blocks.begin() + i);
+    }
+    // Every cycle starts from an empty arena again
+    void *first = arena->allocate(1);
+    if (first != start)
+      TEST_FAIL_MESSAGE("Arena did not rewind after a cycle");
+    arena->deallocate(first);
+  }
+  TEST_ASSERT_EQUAL(0, arena->overflows());
+  TEST_ASSERT_LESS_OR_EQUAL(CAPACITY, arena->highWater());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_blocks_are_aligned_and_consecutive);
+  RUN_TEST(test_newest_block_grows_in_place);
+  RUN_TEST(test_newest_block_shrinks_in_place);
+  RUN_TEST(test_older_block_moves_and_keeps_its_content);
+  RUN_TEST(test_releasing_the_newest_block_gives_its_space_back);
+  RUN_TEST(test_releasing_the_last_block_rewinds);
+  RUN_TEST(test_all_released_rewinds_to_the_start);
+  RUN_TEST(test_overflow_falls_back_to_the_heap);
+  RUN_TEST(test_soak_has_no_overlap_and_no_fragmentation);
+  return UNITY_END();
+}
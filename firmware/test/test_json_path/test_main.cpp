@@ -0,0 +1,195 @@
+// JsonPath: compile failures, resolution, and timings of the filtered
+// fetch path on payloads recorded from the APIs users point sensors at
+#include "../../src/config/JsonPath.h"
+#include <chrono>
+#include <string>
+#include <unity.h>
+
+// Home Assistant GET /api/states/sensor.living_room_temperature
+static const char *HOME_ASSISTANT =
+    R"({"entity_id":"sensor.living_room_temperature","state":"21.4","attribut)"
+    R"(es":{"state_class":"measurement","unit_of_measurement":"°C","device_cl)"
+    R"(ass":"temperature","friendly_name":"Living room Temperature"},"last_ch)"
+    R"(anged":"2026-10-19T05:12:44.318716+00:00","last_reported":"2026-10-19T)"
+    R"(05:12:44.318716+00:00","last_updated":"2026-10-19T05:12:44.318716+00:0)"
+    R"(0","context":{"id":"01JAJ8ZQ3M6V0Y7T2K9W5XRB1C","parent_id":null,"user)"
+    R"(_id":null}})";
+
+// Shelly Plus 1PM GET /rpc/Shelly.GetStatus
+static const char *SHELLY =
+    R"({"ble":{},"cloud":{"connected":true},"input:0":{"id":0,"state":false},)"
+    R"("mqtt":{"connected":false},"switch:0":{"id":0,"source":"HTTP_in","outp)"
+    R"(ut":true,"apower":1843.2,"voltage":231.7,"current":8.012,"aenergy":{"t)"
+    R"(otal":581234.117,"by_minute":[30571.301,30702.199,30688.412],"minute_t)"
+    R"(s":1760850600},"temperature":{"tC":48.3,"tF":118.9}},"sys":{"mac":"A80)"
+    R"(32ABE54DC","restart_required":false,"time":"07:10","unixtime":17608506)"
+    R"(12,"uptime":932113,"ram_size":246220,"ram_free":141432,"fs_size":45875)"
+    R"(2,"fs_free":139264,"cfg_rev":21,"kvs_rev":3,"schedule_rev":0,"webhook_)"
+    R"(rev":0,"available_updates":{"stable":{"version":"1.4.4"}}},"wifi":{"st)"
+    R"(a_ip":"192.168.1.42","status":"got ip","ssid":"home","rssi":-61},"ws":)"
+    R"({"connected":false}})";
+
+// Open-Meteo /v1/forecast?current=...&hourly=temperature_2m, 48 hours
+static std::string openMeteo() {
+  std::string body =
+      R"({"latitude":48.86,"longitude":2.3399997,"generationtime_ms":0.047683)"
+      R"(7158203125,"utc_offset_seconds":7200,"timezone":"Europe/Paris","time)"
+      R"(zone_abbreviation":"CEST","elevation":43.0,"current_units":{"time":")"
+      R"(iso8601","interval":"seconds","temperature_2m":"°C","wind_speed_10m")"
+      R"(:"km/h"},"current":{"time":"2026-10-19T07:00","interval":900,"temper)"
+      R"(ature_2m":11.8,"wind_speed_10m":9.4},"hourly_units":{"time":"iso8601)"
+      R"(","temperature_2m":"°C"},"hourly":{"time":[)";
+  for (int h = 0; h < 48; h++) {
+    char stamp[32];
+    snprintf(stamp, sizeof(stamp), "%s\"2026-10-%02dT%02d:00\"",
+             h ? "," : "", 19 + h / 24, h % 24);
+    body += stamp;
+  }
+  body += R"(],"temperature_2m":[)";
+  for (int h = 0; h < 48; h++) {
+    char temp[16];
+    snprintf(temp, sizeof(temp), "%s%.1f", h ? "," : "",
+             9.0 + 5.0 * sin(h * M_PI / 12));
+    body += temp;
+  }
+  return body + "]}}";
+}
+
+static float resolveIn(const char *path, const char *body) {
+  JsonPath compiled;
+  TEST_ASSERT_TRUE_MESSAGE(compiled.compile(path), path);
+  JsonDocument filter;
+  compiled.buildFilter(filter);
+  JsonDocument doc;
+  TEST_ASSERT_FALSE(
+      deserializeJson(doc, body, DeserializationOption::Filter(filter)));
+  JsonVariantConst v = compiled.resolve(doc.as<JsonVariantConst>());
+  TEST_ASSERT_FALSE_MESSAGE(v.isNull(), path);
+  return v.as<float>();
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_compile_failures() {
+  const char *bad[] = {
+      "",                      // Whole document: would read as 0
+      ".",                     // Same, spelled differently
+      "a[",                    // Unterminated index
+      "a[1",                   // Unterminated index
+      "[-1]",                  // Negative index
+      "[]",                    // Empty index, strtol would read 0
+      "a[x]",                  // Not a number
+      "a[ 1]",                 // Blank before the number
+      "a[70000]",              // Beyond uint16_t
+      "a.b.c.d.e.f.g.h.i.j.k", // MAX_TOKENS + 1
+  };
+  JsonPath path;
+  for (const char *p : bad) {
+    TEST_ASSERT_FALSE_MESSAGE(path.compile(p), p);
+    TEST_ASSERT_FALSE_MESSAGE(path.valid(), p);
+  }
+}
+
+void test_key_storage_overflow() {
+  JsonPath path;
+  String key;
+  for (int i = 0; i < 63; i++)
+    key += 'k';
+  TEST_ASSERT_TRUE(path.compile(key)); // 63 bytes and the NUL
+  TEST_ASSERT_FALSE(path.compile(key + "k"));
+  TEST_ASSERT_FALSE(path.compile("abcdefghijklmnopqrstuvwxyz.abcdefghijklmn"
+                                 "opqrstuvwxyz.abcdefghijklm"));
+}
+
+void test_failed_compile_invalidates_the_previous_path() {
+  JsonPath path;
+  TEST_ASSERT_TRUE(path.compile("data.temp"));
+  TEST_ASSERT_FALSE(path.compile(""));
+  TEST_ASSERT_FALSE(path.valid());
+}
+
+void test_resolves_recorded_payloads() {
+  TEST_ASSERT_EQUAL_FLOAT(21.4f, resolveIn("state", HOME_ASSISTANT));
+  TEST_ASSERT_EQUAL_FLOAT(1843.2f, resolveIn("switch:0.apower", SHELLY));
+  TEST_ASSERT_EQUAL_FLOAT(30702.199f,
+                          resolveIn("switch:0.aenergy.by_minute[1]", SHELLY));
+  TEST_ASSERT_EQUAL_FLOAT(-61.0f, resolveIn("wifi.rssi", SHELLY));
+  std::string meteo = openMeteo();
+  TEST_ASSERT_EQUAL_FLOAT(11.8f,
+                          resolveIn("current.temperature_2m", meteo.c_str()));
+  TEST_ASSERT_EQUAL_FLOAT(
+      14.0f, resolveIn("hourly.temperature_2m[6]", meteo.c_str()));
+}
+
+void test_missing_branch_is_null() {
+  JsonPath path;
+  TEST_ASSERT_TRUE(path.compile("switch:0.aenergy.by_minute[9]"));
+  JsonDocument doc;
+  deserializeJson(doc, SHELLY);
+  TEST_ASSERT_TRUE(path.resolve(doc.as<JsonVariantConst>()).isNull());
+  TEST_ASSERT_TRUE(path.compile("sys.mac.oui"));
+  TEST_ASSERT_TRUE(path.resolve(doc.as<JsonVariantConst>()).isNull());
+}
+
+// Not a pass/fail gate: prints per-fetch costs so a change to the filter or
+// the token program shows up next to the numbers it is meant to improve
+static void bench(const char *name, const char *path, const char *body) {
+  using Clock = std::chrono::steady_clock;
+  const int runs = 2000;
+  JsonPath compiled;
+  float sink = 0;
+
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < runs; i++)
+    compiled.compile(path);
+  double compileUs =
+      std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+  JsonDocument filter;
+  compiled.buildFilter(filter);
+  start = Clock::now();
+  for (int i = 0; i < runs; i++) {
+    JsonDocument doc;
+    deserializeJson(doc, body, DeserializationOption::Filter(filter));
+    sink += compiled.resolve(doc.as<JsonVariantConst>()).as<float>();
+  }
+  double filteredUs =
+      std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+  start = Clock::now();
+  for (int i = 0; i < runs; i++) {
+    JsonDocument doc;
+    deserializeJson(doc, body);
+    sink += compiled.resolve(doc.as<JsonVariantConst>()).as<float>();
+  }
+  double fullUs =
+      std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+  char line[128];
+  snprintf(line, sizeof(line),
+           "%-14s %5u B  compile %.2f us  filtered %.1f us  full %.1f us",
+           name, (unsigned)strlen(body), compileUs / runs, filteredUs / runs,
+           fullUs / runs);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_TRUE(sink != 0);
+}
+
+void test_benchmark_recorded_payloads() {
+  std::string meteo = openMeteo();
+  bench("home-assistant", "state", HOME_ASSISTANT);
+  bench("shelly", "switch:0.aenergy.by_minute[1]", SHELLY);
+  bench("open-meteo", "hourly.temperature_2m[6]", meteo.c_str());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_compile_failures);
+  RUN_TEST(test_key_storage_overflow);
+  RUN_TEST(test_failed_compile_invalidates_the_previous_path);
+  RUN_TEST(test_resolves_recorded_payloads);
+  RUN_TEST(test_missing_branch_is_null);
+  RUN_TEST(test_benchmark_recorded_payloads);
+  return UNITY_END();
+}
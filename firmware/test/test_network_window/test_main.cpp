@@ -0,0 +1,242 @@
+// Network bursts on the stub clock: admission within the tolerance, one
+// early run per burst, holds, idle close, planning off, radio-on accounting
+#include "../../src/network/NetworkWindow.h"
+#include <Preferences.h>
+#include <WiFi.h>
+#include <esp-iot-utils.h>
+#include <unity.h>
+
+static const unsigned long TOLERANCE_MS = 60000;
+static const unsigned long MINUTE_MS = 60000;
+
+static ConfigHelper legacy;
+
+static void setTolerance(ConfigStore &store, int seconds) {
+  std::vector<String> changed;
+  store.stage()->system.netTolerance = seconds;
+  store.commit(changed);
+  store.quiesce();
+}
+
+// A window whose boot connection already went idle and closed
+static void startClosed(NetworkWindow &window, ConfigStore &store) {
+  window.begin(store, true);
+  ArduinoStub::advance(NetworkWindow::IDLE_MS);
+  window.loop();
+  TEST_ASSERT_FALSE(window.open());
+}
+
+void setUp() {
+  ArduinoStub::reset(1000);
+  randomSeed(7);
+  Preferences::eraseAll();
+  WiFi.setStatus(WL_CONNECTED);
+  WiFi.mode(WIFI_STA);
+  WiFiHelper::attempts() = 0;
+  WiFiHelper::fails() = false;
+}
+
+void tearDown() {}
+
+void test_zero_tolerance_runs_work_exactly_when_due() {
+  ConfigStore store(legacy);
+  store.load();
+  NetworkWindow window;
+  window.begin(store, true);
+  uint32_t burst = 0;
+
+  TEST_ASSERT_FALSE(window.admit(millis() + 1, burst));
+  TEST_ASSERT_TRUE(window.admit(millis(), burst));
+  TEST_ASSERT_TRUE(window.admit(0, burst));
+
+  // The radio is never switched off
+  ArduinoStub::advance(10 * MINUTE_MS);
+  window.loop();
+  TEST_ASSERT_TRUE(window.open());
+  TEST_ASSERT_EQUAL(WL_CONNECTED, WiFi.status());
+  TEST_ASSERT_EQUAL(0, WiFiHelper::attempts());
+}
+
+void test_closed_window_waits_for_the_tolerance() {
+  ConfigStore store(legacy);
+  store.load();
+  setTolerance(store, TOLERANCE_MS / 1000);
+  NetworkWindow window;
+  startClosed(window, store);
+  uint32_t burst = 0;
+
+  // Late, but less than the tolerance: waits for more work to join
+  unsigned long due = millis() - (TOLERANCE_MS - 1);
+  TEST_ASSERT_FALSE(window.admit(due, burst));
+  TEST_ASSERT_EQUAL(0, WiFiHelper::attempts());
+
+  ArduinoStub::advance(1);
+  TEST_ASSERT_TRUE(window.admit(due, burst));
+  TEST_ASSERT_TRUE(window.open());
+  TEST_ASSERT_EQUAL(1, WiFiHelper::attempts());
+  TEST_ASSERT_EQUAL(2, window.bursts()); // The boot connection was 1
+  TEST_ASSERT_EQUAL(2, burst);
+}
+
+void test_open_window_admits_work_due_within_the_tolerance() {
+  ConfigStore store(legacy);
+  store.load();
+  setTolerance(store, TOLERANCE_MS / 1000);
+  NetworkWindow window;
+  window.begin(store, true);
+  unsigned long opened = millis();
+  uint32_t a = 0, b = 0, c = 0;
+
+  TEST_ASSERT_TRUE(window.admit(opened + TOLERANCE_MS, a));
+  TEST_ASSERT_FALSE(window.admit(opened + TOLERANCE_MS + 1, b));
+  TEST_ASSERT_TRUE(window.admit(0, c)); // Urgent work always runs
+
+  // Bounded by the burst start, not by now
+  ArduinoStub::advance(30000);
+  TEST_ASSERT_FALSE(window.admit(opened + TOLERANCE_MS + 1, b));
+  TEST_ASSERT_EQUAL(0, WiFiHelper::attempts());
+}
+
+void test_work_runs_early_once_per_burst() {
+  ConfigStore store(legacy);
+  store.load();
+  setTolerance(store, TOLERANCE_MS / 1000);
+  NetworkWindow window;
+  window.begin(store, true);
+  uint32_t burst = 0;
+
+  TEST_ASSERT_TRUE(window.admit(millis() + 20000, burst));
+  // Rescheduled within the tolerance: not again in this burst...
+  TEST_ASSERT_FALSE(window.admit(millis() + 40000, burst));
+  // ...unless it is actually due, or urgent
+  TEST_ASSERT_TRUE(window.admit(millis(), burst));
+  TEST_ASSERT_TRUE(window.admit(0, burst));
+}
+
+void test_idle_window_closes_the_radio() {
+  ConfigStore store(legacy);
+  store.load();
+  setTolerance(store, TOLERANCE_MS / 1000);
+  NetworkWindow window;
+  window.begin(store, true);
+  uint32_t burst = 0;
+  TEST_ASSERT_TRUE(window.admit(millis(), burst));
+
+  ArduinoStub::advance(NetworkWindow::IDLE_MS - 1);
+  window.loop();
+  TEST_ASSERT_TRUE(window.open());
+
+  ArduinoStub::advance(1);
+  window.loop();
+  TEST_ASSERT_FALSE(window.open());
+  TEST_ASSERT_EQUAL(WL_DISCONNECTED, WiFi.status());
+  TEST_ASSERT_EQUAL(WIFI_OFF, WiFi.getMode());
+}
+
+void test_hold_keeps_the_burst_open() {
+  ConfigStore store(legacy);
+  store.load();
+  setTolerance(store, TOLERANCE_MS / 1000);
+  NetworkWindow window;
+  window.begin(store, true);
+  uint32_t burst = 0;
+  TEST_ASSERT_TRUE(window.admit(millis(), burst));
+
+  // Two fetches in flight on the fetch task
+  window.hold();
+  window.hold();
+  ArduinoStub::advance(10 * NetworkWindow::IDLE_MS);
+  window.loop();
+  TEST_ASSERT_TRUE(window.open());
+
+  window.release();
+  window.loop();
+  TEST_ASSERT_TRUE(window.open());
+
+  window.release();
+  window.release(); // Unbalanced releases are ignored
+  window.loop();
+  TEST_ASSERT_FALSE(window.open());
+}
+
+void test_failed_connect_backs_off() {
+  ConfigStore store(legacy);
+  store.load();
+  setTolerance(store, TOLERANCE_MS / 1000);
+  NetworkWindow window;
+  startClosed(window, store);
+  uint32_t burst = 0;
+
+  WiFiHelper::fails() = true;
+  TEST_ASSERT_FALSE(window.admit(0, burst));
+  TEST_ASSERT_EQUAL(1, window.connectFailures());
+  TEST_ASSERT_EQUAL(WIFI_OFF, WiFi.getMode());
+
+  // No new attempt before the retry delay (10 s +/-20% after one failure)
+  WiFiHelper::fails() = false;
+  ArduinoStub::advance(7000);
+  TEST_ASSERT_FALSE(window.admit(0, burst));
+  TEST_ASSERT_EQUAL(1, WiFiHelper::attempts());
+
+  ArduinoStub::advance(6000);
+  TEST_ASSERT_TRUE(window.admit(0, burst));
+  TEST_ASSERT_EQUAL(2, WiFiHelper::attempts());
+}
+
+void test_radio_on_time_is_accounted_per_hour() {
+  ConfigStore store(legacy);
+  store.load();
+  setTolerance(store, TOLERANCE_MS / 1000);
+  NetworkWindow window;
+  startClosed(window, store); // Boot connection: IDLE_MS on
+  TEST_ASSERT_EQUAL_UINT32(NetworkWindow::IDLE_MS, window.radioOnThisHourMs());
+
+  // A burst at 30 minutes, kept open 5 s by a fetch
+  ArduinoStub::advance(30 * MINUTE_MS);
+  uint32_t burst = 0;
+  TEST_ASSERT_TRUE(window.admit(0, burst));
+  window.hold();
+  ArduinoStub::advance(5000);
+  TEST_ASSERT_EQUAL_UINT32(NetworkWindow::IDLE_MS + 5000,
+                           window.radioOnThisHourMs()); // Still open
+  window.release();
+  window.loop();
+  TEST_ASSERT_FALSE(window.open());
+  TEST_ASSERT_EQUAL_UINT32(NetworkWindow::IDLE_MS + 5000,
+                           window.radioOnThisHourMs());
+
+  // The hour rolls over: the total moves to the last hour
+  ArduinoStub::advance(30 * MINUTE_MS);
+  window.loop();
+  TEST_ASSERT_EQUAL_UINT32(NetworkWindow::IDLE_MS + 5000,
+                           window.radioOnLastHourMs());
+  TEST_ASSERT_EQUAL_UINT32(0, window.radioOnThisHourMs());
+}
+
+void test_planning_off_brings_the_radio_back() {
+  ConfigStore store(legacy);
+  store.load();
+  setTolerance(store, TOLERANCE_MS / 1000);
+  NetworkWindow window;
+  startClosed(window, store);
+
+  setTolerance(store, 0);
+  window.loop();
+  TEST_ASSERT_TRUE(window.open());
+  TEST_ASSERT_EQUAL(WL_CONNECTED, WiFi.status());
+  TEST_ASSERT_EQUAL(0, window.tolerance());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_zero_tolerance_runs_work_exactly_when_due);
+  RUN_TEST(test_closed_window_waits_for_the_tolerance);
+  RUN_TEST(test_open_window_admits_work_due_within_the_tolerance);
+  RUN_TEST(test_work_runs_early_once_per_burst);
+  RUN_TEST(test_idle_window_closes_the_radio);
+  RUN_TEST(test_hold_keeps_the_burst_open);
+  RUN_TEST(test_failed_connect_backs_off);
+  RUN_TEST(test_radio_on_time_is_accounted_per_hour);
+  RUN_TEST(test_planning_off_brings_the_radio_back);
+  return UNITY_END();
+}
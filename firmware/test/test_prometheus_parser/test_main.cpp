@@ -0,0 +1,177 @@
+// Prometheus pull parser: result shapes, key order, early stop, large,
+// truncated, deeply nested and non-JSON bodies
+#include "../../src/network/PrometheusParser.h"
+#include <string>
+#include <unity.h>
+
+// Socket stand-in: hands the body out a few bytes at a time, like a TCP
+// stream, and counts what the parser actually consumed
+class BodyStream : public Stream {
+public:
+  explicit BodyStream(const std::string &body) : _body(body) {}
+
+  int available() override {
+    return (int)std::min<size_t>(_body.size() - _pos, 7);
+  }
+  int read() override {
+    return _pos < _body.size() ? (uint8_t)_body[_pos++] : -1;
+  }
+  int peek() override {
+    return _pos < _body.size() ? (uint8_t)_body[_pos] : -1;
+  }
+  size_t consumed() const { return _pos; }
+
+private:
+  std::string _body;
+  size_t _pos = 0;
+};
+
+static float value;
+
+static PrometheusParser::Result parse(const std::string &body) {
+  BodyStream stream(body);
+  value = NAN;
+  return PrometheusParser::firstSample(stream, value);
+}
+
+static std::string series(int i) {
+  return "{\"metric\":{\"__name__\":\"up\",\"instance\":\"host" +
+         std::to_string(i) + ":9100\"},\"value\":[1718000000.123,\"" +
+         std::to_string(i) + ".5\"]}";
+}
+
+static std::string vectorBody(int count, bool statusFirst) {
+  std::string result = "[";
+  for (int i = 0; i < count; i++)
+    result += (i ? "," : "") + series(i);
+  result += "]";
+  std::string data =
+      "\"data\":{\"resultType\":\"vector\",\"result\":" + result + "}";
+  return statusFirst ? "{\"status\":\"success\"," + data + "}"
+                     : "{" + data + ",\"status\":\"success\"}";
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_vector_takes_the_first_series() {
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::OK, parse(vectorBody(3, true)));
+  TEST_ASSERT_EQUAL_FLOAT(0.5f, value);
+}
+
+void test_scalar_result() {
+  const char *body = "{\"status\":\"success\",\"data\":{\"resultType\":"
+                     "\"scalar\",\"result\":[1718000000.5,\"-12.25\"]}}";
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::OK, parse(body));
+  TEST_ASSERT_EQUAL_FLOAT(-12.25f, value);
+}
+
+void test_status_after_data() {
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::OK, parse(vectorBody(3, false)));
+  TEST_ASSERT_EQUAL_FLOAT(0.5f, value);
+
+  std::string failed = "{\"data\":{\"result\":[" + series(1) +
+                       "]},\"status\":\"error\"}";
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::NOT_SUCCESS, parse(failed));
+}
+
+void test_error_and_empty_responses() {
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::NOT_SUCCESS,
+                    parse("{\"status\":\"error\",\"errorType\":\"bad_data\","
+                          "\"error\":\"parse error at char 4\"}"));
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::NOT_SUCCESS,
+                    parse("{\"data\":{}}"));
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::NO_SAMPLE,
+                    parse(vectorBody(0, true)));
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::NO_SAMPLE,
+                    parse("{\"status\":\"success\",\"data\":{\"result\":[{"
+                          "\"metric\":{},\"value\":[1,\"\"]}]}}"));
+}
+
+// Status first: reading stops right after the first sample
+void test_ten_thousand_series_status_first() {
+  std::string body = vectorBody(10000, true);
+  BodyStream stream(body);
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::OK,
+                    PrometheusParser::firstSample(stream, value));
+  TEST_ASSERT_EQUAL_FLOAT(0.5f, value);
+  TEST_ASSERT_LESS_THAN(300, stream.consumed());
+}
+
+// Status last: every other series is skipped to reach it
+void test_ten_thousand_series_status_last() {
+  std::string body = vectorBody(10000, false);
+  BodyStream stream(body);
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::OK,
+                    PrometheusParser::firstSample(stream, value));
+  TEST_ASSERT_EQUAL_FLOAT(0.5f, value);
+  TEST_ASSERT_EQUAL(body.size() - 1, stream.consumed()); // Not the last }
+}
+
+// Cut anywhere before the parser has both the status and the sample, the
+// body is rejected; cut after that point, the rest is never needed
+static void checkTruncations(const std::string &body, size_t complete) {
+  for (size_t n = 0; n < body.size(); n++) {
+    PrometheusParser::Result expected = PrometheusParser::Result::OK;
+    if (n < complete)
+      expected = PrometheusParser::Result::MALFORMED;
+    if (parse(body.substr(0, n)) != expected) {
+      char message[48];
+      snprintf(message, sizeof(message), "Wrong result for a %u byte prefix",
+               (unsigned)n);
+      TEST_FAIL_MESSAGE(message);
+    }
+  }
+}
+
+void test_truncated_bodies() {
+  std::string last = vectorBody(2, false);
+  checkTruncations(last, last.find("\"success\"") + 9);
+  std::string first = vectorBody(2, true);
+  checkTruncations(first, first.find("\"0.5\"") + 5);
+}
+
+static std::string nested(int depth) {
+  return "{\"extra\":" + std::string(depth, '[') + std::string(depth, ']') +
+         ",\"status\":\"success\",\"data\":{\"result\":[" + series(7) +
+         "]}}";
+}
+
+void test_nesting_beyond_max_depth() {
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::OK, parse(nested(32)));
+  TEST_ASSERT_EQUAL_FLOAT(7.5f, value);
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::MALFORMED, parse(nested(33)));
+  TEST_ASSERT_EQUAL(PrometheusParser::Result::MALFORMED, parse(nested(5000)));
+}
+
+void test_non_json_input() {
+  const char *bodies[] = {
+      "",
+      "<html><body>502 Bad Gateway</body></html>",
+      "up{instance=\"host:9100\"} 1",
+      "null",
+      "[\"status\",\"success\"]",
+      "{\"status\" \"success\"}",
+      "{\"status\":success}",
+      "{\"status\":\"success\",\"data\":{\"result\":[1 \"2\"]}}",
+  };
+  for (const char *body : bodies) {
+    TEST_ASSERT_EQUAL_MESSAGE(PrometheusParser::Result::MALFORMED,
+                              parse(body), body);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_vector_takes_the_first_series);
+  RUN_TEST(test_scalar_result);
+  RUN_TEST(test_status_after_data);
+  RUN_TEST(test_error_and_empty_responses);
+  RUN_TEST(test_ten_thousand_series_status_first);
+  RUN_TEST(test_ten_thousand_series_status_last);
+  RUN_TEST(test_truncated_bodies);
+  RUN_TEST(test_nesting_beyond_max_depth);
+  RUN_TEST(test_non_json_input);
+  return UNITY_END();
+}
@@ -0,0 +1,265 @@
+// Eight-panel simulator: every panel write goes through the scheduler, one
+// refresh per main loop pass, separated by the refresh gaps
+#include "../../src/displays/RefreshScheduler.h"
+#include <unity.h>
+#include <vector>
+
+static const int PANELS = 8;
+static const unsigned long LOOP_MS = 100; // delay() at the end of loop()
+static const unsigned long FULL_MS = 3000;
+static const unsigned long PARTIAL_MS = 400;
+
+struct Write {
+  int panel;
+  char kind; // 'F' full, 'P' partial, 'W' partial window, 'C' clear
+  unsigned long start;
+  unsigned long end;
+};
+static std::vector<Write> writes;
+
+class Canvas : public Adafruit_GFX {
+public:
+  Canvas() : Adafruit_GFX(400, 300) {}
+  void drawPixel(int16_t, int16_t, uint16_t) override {}
+};
+
+// Records each write to the controller and takes as long as a real one
+class SimPanel : public Panel {
+public:
+  bool fast = true; // false: GDEY042Z98-like, full refresh only
+
+  explicit SimPanel(int index) : _index(index) {}
+
+  PanelFormat format() const override {
+    return fast ? PanelFormat::MONO : PanelFormat::TRI_COLOR;
+  }
+  bool fastPartialRefresh() const override { return fast; }
+  void init() override {}
+  void clear() override { record('C', FULL_MS); }
+  Adafruit_GFX &canvas() override { return _canvas; }
+  void present(bool fullRefresh, int16_t, int16_t, int16_t w,
+               int16_t) override {
+    if (fullRefresh)
+      record('F', FULL_MS);
+    else
+      record(w > 0 ? 'W' : 'P', PARTIAL_MS);
+  }
+
+private:
+  int _index;
+  Canvas _canvas;
+
+  void record(char kind, unsigned long ms) {
+    unsigned long start = millis();
+    ArduinoStub::advance(ms);
+    writes.push_back({_index, kind, start, millis()});
+  }
+};
+
+// Minimal view: a frame, a cell grid of one window per mask and the badge
+class SimView : public BaseDisplay {
+public:
+  uint8_t lastCells = 0;
+  String lastBadge; // Age drawn with the last frame
+
+  void update(bool fullRefresh) override {
+    if (!beginFrame())
+      return;
+    lastBadge = staleAge().c_str();
+    _gfx->fillScreen(GxEPD_WHITE);
+    drawStaleBadge();
+    present(fullRefresh);
+  }
+  void updateCells(uint8_t cells) override {
+    if (!beginFrame())
+      return;
+    lastCells = cells;
+    _panel->present(false, 0, 0, 8 * cells, 8);
+  }
+};
+
+static SimPanel *panels[PANELS];
+static SimView views[PANELS];
+
+// Main loop passes until the queue drains
+static void runLoop() {
+  for (int pass = 0; pass < 1000 && refreshScheduler.pending() > 0; pass++) {
+    size_t before = writes.size();
+    refreshScheduler.loop();
+    TEST_ASSERT_LESS_OR_EQUAL(before + 1, writes.size());
+    ArduinoStub::advance(LOOP_MS);
+  }
+  // Let the last gap run out so tests start from an idle scheduler
+  ArduinoStub::advance(RefreshScheduler::FULL_GAP_MS);
+  refreshScheduler.loop();
+}
+
+void setUp() {
+  ArduinoStub::reset(10000);
+  for (int i = 0; i < PANELS; i++) {
+    panels[i] = new SimPanel(i);
+    views[i].setPanel(panels[i]);
+    views[i].setStaleAge("");
+    views[i].lastCells = 0;
+    views[i].lastBadge = "";
+  }
+  runLoop();
+  writes.clear();
+}
+
+void tearDown() {
+  for (int i = 0; i < PANELS; i++) {
+    views[i].setPanel(nullptr);
+    delete panels[i];
+  }
+}
+
+void test_requests_never_touch_a_panel() {
+  for (int i = 0; i < PANELS; i++) {
+    switch (i % 5) {
+    case 0:
+      refreshScheduler.request("m", &views[i], true);
+      break;
+    case 1:
+      refreshScheduler.requestCells("m", &views[i], 0x03);
+      break;
+    case 2:
+      refreshScheduler.requestBadge("m", &views[i]);
+      break;
+    case 3:
+      refreshScheduler.requestError("m", &views[i], "Fetch Failed");
+      break;
+    case 4:
+      refreshScheduler.requestClear("None", panels[i]);
+      break;
+    }
+  }
+  TEST_ASSERT_EQUAL(0, writes.size());
+  TEST_ASSERT_EQUAL(PANELS, refreshScheduler.pending());
+
+  runLoop();
+  TEST_ASSERT_EQUAL(PANELS, writes.size());
+  const char kinds[] = {'F', 'W', 'W', 'F', 'C'};
+  for (int i = 0; i < PANELS; i++) {
+    TEST_ASSERT_EQUAL(i, writes[i].panel);
+    TEST_ASSERT_EQUAL(kinds[i % 5], writes[i].kind);
+  }
+}
+
+void test_eight_full_refreshes_are_spaced_by_the_gap() {
+  for (int i = 0; i < PANELS; i++)
+    refreshScheduler.request("m", &views[i], true);
+  runLoop();
+
+  TEST_ASSERT_EQUAL(PANELS, writes.size());
+  for (int i = 1; i < PANELS; i++) {
+    TEST_ASSERT_GREATER_OR_EQUAL(writes[i - 1].end +
+                                     RefreshScheduler::FULL_GAP_MS,
+                                 writes[i].start);
+    // No panel waits more than one loop pass past its gap
+    TEST_ASSERT_LESS_THAN(writes[i - 1].end + RefreshScheduler::FULL_GAP_MS +
+                              LOOP_MS + 1,
+                          writes[i].start);
+  }
+}
+
+void test_partial_refreshes_use_the_short_gap() {
+  for (int i = 0; i < PANELS; i++)
+    refreshScheduler.requestCells("m", &views[i], 0x01);
+  runLoop();
+
+  TEST_ASSERT_EQUAL(PANELS, writes.size());
+  for (int i = 1; i < PANELS; i++) {
+    unsigned long gap = writes[i].start - writes[i - 1].end;
+    TEST_ASSERT_GREATER_OR_EQUAL(RefreshScheduler::PARTIAL_GAP_MS, gap);
+    TEST_ASSERT_LESS_THAN(RefreshScheduler::FULL_GAP_MS, gap);
+  }
+}
+
+void test_jobs_for_one_view_merge() {
+  refreshScheduler.requestCells("m", &views[0], 0x01);
+  refreshScheduler.requestCells("m", &views[0], 0x04);
+  refreshScheduler.request("m", &views[1], false);
+  refreshScheduler.request("m", &views[1], true);
+  refreshScheduler.requestCells("m", &views[2], 0x02);
+  refreshScheduler.requestBadge("m", &views[2]);
+  refreshScheduler.requestError("m", &views[3], "Fetch Failed");
+  refreshScheduler.request("m", &views[3], false);
+  refreshScheduler.request("m", &views[4], false);
+  refreshScheduler.requestError("m", &views[4], "Fetch Failed");
+  TEST_ASSERT_EQUAL(5, refreshScheduler.pending());
+
+  runLoop();
+  TEST_ASSERT_EQUAL(5, writes.size());
+  TEST_ASSERT_EQUAL('W', writes[0].kind);
+  TEST_ASSERT_EQUAL_HEX8(0x05, views[0].lastCells);
+  TEST_ASSERT_EQUAL('F', writes[1].kind); // Full wins
+  TEST_ASSERT_EQUAL('P', writes[2].kind); // Cells + badge: one frame
+  TEST_ASSERT_EQUAL('P', writes[3].kind); // Content after the error
+  TEST_ASSERT_EQUAL('F', writes[4].kind); // Error after the content
+}
+
+void test_repeated_error_costs_no_refresh() {
+  refreshScheduler.requestError("m", &views[0], "Fetch Failed");
+  runLoop();
+  refreshScheduler.requestError("m", &views[0], "Fetch Failed");
+  refreshScheduler.request("m", &views[1], false);
+
+  // The no-op error leaves no gap: panel 1 refreshes on the next pass
+  unsigned long start = millis();
+  refreshScheduler.loop();
+  refreshScheduler.loop();
+  TEST_ASSERT_EQUAL(2, writes.size());
+  TEST_ASSERT_EQUAL(1, writes[1].panel);
+  TEST_ASSERT_EQUAL(start, writes[1].start);
+}
+
+void test_badge_only_sends_the_corner() {
+  views[5].setStaleAge("3h");
+  refreshScheduler.requestBadge("m", &views[5]);
+  runLoop();
+  TEST_ASSERT_EQUAL(1, writes.size());
+  TEST_ASSERT_EQUAL('W', writes[0].kind);
+}
+
+// A badge alone would cost a full refresh cycle on a 3-color panel: it waits
+// for the next frame the module renders anyway
+void test_badge_waits_for_the_next_frame_without_fast_partial() {
+  panels[6]->fast = false;
+  views[6].setStaleAge("3h");
+  refreshScheduler.requestBadge("m", &views[6]);
+  TEST_ASSERT_EQUAL(0, refreshScheduler.pending());
+  runLoop();
+  TEST_ASSERT_EQUAL(0, writes.size());
+
+  refreshScheduler.requestCells("m", &views[6], 0x01);
+  refreshScheduler.requestBadge("m", &views[6]);
+  refreshScheduler.request("m", &views[6], true);
+  runLoop();
+  TEST_ASSERT_EQUAL(1, writes.size());
+  TEST_ASSERT_EQUAL('F', writes[0].kind);
+  TEST_ASSERT_EQUAL_STRING("3h", views[6].lastBadge.c_str());
+}
+
+void test_detached_view_is_skipped() {
+  refreshScheduler.request("m", &views[2], true);
+  refreshScheduler.requestClear("None", panels[2]);
+  views[2].setPanel(nullptr);
+  runLoop();
+  TEST_ASSERT_EQUAL(1, writes.size());
+  TEST_ASSERT_EQUAL('C', writes[0].kind);
+  views[2].setPanel(panels[2]);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_requests_never_touch_a_panel);
+  RUN_TEST(test_eight_full_refreshes_are_spaced_by_the_gap);
+  RUN_TEST(test_partial_refreshes_use_the_short_gap);
+  RUN_TEST(test_jobs_for_one_view_merge);
+  RUN_TEST(test_repeated_error_costs_no_refresh);
+  RUN_TEST(test_badge_only_sends_the_corner);
+  RUN_TEST(test_badge_waits_for_the_next_frame_without_fast_partial);
+  RUN_TEST(test_detached_view_is_skipped);
+  return UNITY_END();
+}
@@ -0,0 +1,214 @@
+// Render path allocations: once warmed up, filling the cells and drawing
+// the sensor frame (setCell, FixedString::format, drawCell, sparklines)
+// must not touch the heap, nor must a whole SensorModule cycle on the main
+// loop (requests to the fetch task, results, frame). Only the test thread
+// is counted: the fetch task and the local server allocate freely.
+#include "../../src/SensorHistory.h"
+#include "../../src/displays/FrameBuffer.h"
+#include "../../src/displays/SensorDisplay.h"
+#include "../../src/modules/SensorModule.h"
+#include <LocalServer.h>
+#include <Preferences.h>
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#include <unity.h>
+
+static thread_local bool counting = false;
+static long allocations = 0;
+
+void *operator new(size_t size) {
+  if (counting)
+    allocations++;
+  void *p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+using Frame = FrameBuffer<PanelFormat::MONO, 400, 300>;
+
+// Panel whose canvas is the real frame buffer, without the controller
+class FramePanel : public Panel {
+public:
+  int presents = 0;
+
+  PanelFormat format() const override { return PanelFormat::MONO; }
+  void init() override {}
+  void clear() override {}
+  Adafruit_GFX &canvas() override {
+    Frame &frame = Frame::shared();
+    frame.setRotation(1);
+    return frame;
+  }
+  void present(bool, int16_t, int16_t, int16_t, int16_t) override {
+    presents++;
+  }
+};
+
+static FramePanel panel;
+static SensorDisplay display;
+
+// One main loop pass worth of cell updates, as SensorModule::update does
+static void fillCells(int pass) {
+  SensorDisplay::Value value;
+  for (int slot = 0; slot < 8; slot++) {
+    value.format(pass * 1.25f + slot, slot % 3);
+    display.setCell(slot, "Température salon", value.c_str(), "kWh");
+    display.setSparkline(slot, slot);
+    display.setCellStaleAge(slot, slot == 3 ? "45m" : "");
+  }
+  display.setLastUpdate("12:34");
+}
+
+void setUp() {
+  for (int slot = 0; slot < 8; slot++) {
+    sensorHistory.clear(slot);
+    for (int i = 0; i < SensorHistory::DEPTH; i++)
+      sensorHistory.push(slot, 20 + (i * 7 + slot) % 13 * 0.5f, 1);
+  }
+  display.setPanel(&panel);
+  display.setStyle(0);
+  // Warm-up: first use of the shared frame and of any lazy statics
+  fillCells(0);
+  display.update(true);
+  allocations = 0;
+}
+
+void tearDown() { counting = false; }
+
+void test_counter_sees_allocations() {
+  counting = true;
+  String s("a string long enough to leave the small buffer");
+  counting = false;
+  TEST_ASSERT_GREATER_THAN(0, allocations);
+}
+
+void test_filling_cells_does_not_allocate() {
+  counting = true;
+  for (int pass = 1; pass <= 500; pass++)
+    fillCells(pass);
+  counting = false;
+  TEST_ASSERT_EQUAL(0, allocations);
+}
+
+void test_grid_frame_does_not_allocate() {
+  int before = panel.presents;
+  counting = true;
+  for (int pass = 1; pass <= 20; pass++) {
+    fillCells(pass);
+    display.update(pass % 5 == 0);
+  }
+  counting = false;
+  TEST_ASSERT_EQUAL(0, allocations);
+  TEST_ASSERT_EQUAL(before + 20, panel.presents);
+}
+
+void test_cell_window_does_not_allocate() {
+  counting = true;
+  for (int pass = 1; pass <= 20; pass++) {
+    fillCells(pass);
+    display.updateCells(1u << (pass % 8) | 0x01);
+  }
+  counting = false;
+  TEST_ASSERT_EQUAL(0, allocations);
+}
+
+void test_circle_style_does_not_allocate() {
+  display.setStyle(1);
+  display.update(false); // Warm-up for the other layout
+  counting = true;
+  for (int pass = 1; pass <= 10; pass++) {
+    fillCells(pass);
+    display.update(false);
+  }
+  counting = false;
+  TEST_ASSERT_EQUAL(0, allocations);
+}
+
+// Prometheus answer whose value moves on every request
+static std::atomic<int> served{0};
+static LocalServer::Response serve(const LocalServer::Request &) {
+  LocalServer::Response response;
+  response.body = "{\"status\":\"success\",\"data\":{\"resultType\":"
+                  "\"vector\",\"result\":[{\"metric\":{},\"value\":[1,\"" +
+                  std::to_string(1500 + served++) + "\"]}]}}";
+  return response;
+}
+
+// One main loop cycle: update() submits the due slots, their results come
+// back through onFetchResult(), the next update() queues the frame and the
+// scheduler draws it
+static bool runCycle(SensorModule &module, int slots) {
+  module.update();
+  FetchResult result;
+  for (int received = 0, waits = 0; received < slots;) {
+    if (fetchWorker.poll(result)) {
+      module.onFetchResult(result);
+      received++;
+    } else if (++waits > 5000) {
+      return false;
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  module.update();
+  refreshScheduler.loop();
+  ArduinoStub::advance(61000); // Every slot is due again
+  return true;
+}
+
+void test_sensor_module_cycle_does_not_allocate() {
+  LocalServer server(serve);
+  ConfigHelper legacy;
+  ConfigStore store(legacy);
+  store.load();
+  ConfigSnapshot *next = store.stage();
+  for (int slot = 0; slot < 2; slot++) {
+    SensorConfig &sensor = next->sensors[slot];
+    sensor.enabled = true;
+    sensor.label = "Consommation";
+    sensor.unit = "kWh";
+    sensor.url = server.url(slot ? "/api/v1/query?query=sum(power)"
+                                 : "/api/v1/query?query=sum(energy)");
+  }
+  std::vector<String> changed;
+  store.commit(changed);
+  store.quiesce();
+
+  SensorModule module("Sensors", 0);
+  module.setConfig(&store);
+  module.assignScreen(0, &panel);
+  fetchWorker.begin();
+
+  // Warm-up: expanded URLs, scheduler queue, history buffers
+  TEST_ASSERT_TRUE(runCycle(module, 2));
+  TEST_ASSERT_TRUE(runCycle(module, 2));
+
+  int before = panel.presents;
+  counting = true;
+  bool ok = true;
+  for (int cycle = 0; cycle < 5 && ok; cycle++)
+    ok = runCycle(module, 2);
+  counting = false;
+  TEST_ASSERT_TRUE(ok);
+  TEST_ASSERT_EQUAL(0, allocations);
+  TEST_ASSERT_EQUAL(before + 5, panel.presents); // A new value every cycle
+  module.assignScreen(0, nullptr);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_counter_sees_allocations);
+  RUN_TEST(test_filling_cells_does_not_allocate);
+  RUN_TEST(test_grid_frame_does_not_allocate);
+  RUN_TEST(test_cell_window_does_not_allocate);
+  RUN_TEST(test_circle_style_does_not_allocate);
+  RUN_TEST(test_sensor_module_cycle_does_not_allocate);
+  return UNITY_END();
+}
@@ -0,0 +1,126 @@
+// Retry backoff on the stub clock: bounds, no wrap with long bases, and a
+// poller retrying a local server that fails a few times before recovering
+#include "../../src/network/RetryPolicy.h"
+#include "../../src/network/SensorFetcher.h"
+#include <LocalServer.h>
+#include <climits>
+#include <unity.h>
+#include <vector>
+
+static const unsigned long BASE_MS = 1000;
+static const unsigned long CAP_MS = 60000;
+
+// Jittered delay must stay within +/-20% of the capped exponential
+static void assertJittered(unsigned long expected, unsigned long delayMs) {
+  TEST_ASSERT_GREATER_OR_EQUAL(expected / 100 * 80, delayMs);
+  TEST_ASSERT_LESS_OR_EQUAL(expected / 100 * 120, delayMs);
+}
+
+void setUp() {
+  ArduinoStub::reset(1000);
+  randomSeed(7);
+}
+
+void tearDown() {}
+
+void test_backoff_doubles_up_to_the_cap() {
+  for (uint8_t failures = 1; failures < 20; failures++) {
+    unsigned long expected =
+        min(BASE_MS << min<uint8_t>(failures, 8), CAP_MS);
+    for (int i = 0; i < 50; i++)
+      assertJittered(expected, RetryPolicy::backoff(BASE_MS, failures, CAP_MS));
+  }
+}
+
+// A one-day base shifted by 8 needs 35 bits: it used to wrap on the ESP32
+// and retry within seconds instead of waiting the cap
+void test_long_base_does_not_wrap() {
+  const unsigned long day = 24UL * 3600 * 1000;
+  for (uint8_t failures = 1; failures < 12; failures++)
+    assertJittered(2 * day, RetryPolicy::backoff(day, failures, 2 * day));
+
+  // Same overflow at this host's word size: base << 8 wraps to 256
+  unsigned long wide = (1UL << (sizeof(unsigned long) * 8 - 8)) + 1;
+  assertJittered(CAP_MS, RetryPolicy::backoff(wide, 8, CAP_MS));
+}
+
+void test_jitter_spreads_retries() {
+  unsigned long low = ULONG_MAX, high = 0;
+  for (int i = 0; i < 500; i++) {
+    unsigned long d = RetryPolicy::backoff(BASE_MS, 3, CAP_MS);
+    low = min(low, d);
+    high = max(high, d);
+  }
+  TEST_ASSERT_LESS_THAN(8000 * 0.9, low);
+  TEST_ASSERT_GREATER_THAN(8000 * 1.1, high);
+}
+
+void test_due_across_the_clock_wrap() {
+  RetryPolicy policy(BASE_MS, CAP_MS);
+  unsigned long now = ULONG_MAX - 500;
+  policy.failed(now);
+  TEST_ASSERT_TRUE(policy.retryAt() < now); // Wrapped past zero
+  TEST_ASSERT_FALSE(policy.due(now + 1000));
+  TEST_ASSERT_TRUE(policy.due(policy.retryAt()));
+}
+
+// Server answering 500 to the first FAILURES requests, then a value
+static const int FAILURES = 6;
+static std::vector<unsigned long> requestTimes;
+
+static LocalServer::Response flaky(const LocalServer::Request &) {
+  LocalServer::Response response;
+  requestTimes.push_back(millis()); // Stub clock, frozen during the fetch
+  if (requestTimes.size() <= FAILURES)
+    response.code = 500;
+  else
+    response.body = "{\"temp\":19.5}";
+  return response;
+}
+
+void test_poller_backs_off_from_a_failing_server() {
+  LocalServer server(flaky);
+  FetchSource source;
+  source.prometheus = false;
+  source.path.compile("temp");
+  RetryPolicy policy(BASE_MS, CAP_MS);
+  float value = 0;
+
+  // Main loop at 100 ms per pass: fetch now, then only when a retry is due
+  bool done = false;
+  for (int pass = 0; pass < 10000 && !done; pass++) {
+    if (pass == 0 || policy.due(millis())) {
+      FetchStatus status =
+          SensorFetcher::fetch(0, server.url("/v"), source, false, value);
+      if (status == FetchStatus::OK) {
+        policy.succeeded();
+        done = true;
+      } else {
+        policy.failed(millis());
+      }
+    }
+    ArduinoStub::advance(100);
+  }
+
+  TEST_ASSERT_TRUE(done);
+  TEST_ASSERT_FALSE(policy.failing());
+  TEST_ASSERT_EQUAL_FLOAT(19.5f, value);
+  TEST_ASSERT_EQUAL(FAILURES + 1, server.requests());
+  for (int i = 1; i <= FAILURES; i++) {
+    unsigned long gap = requestTimes[i] - requestTimes[i - 1];
+    unsigned long expected = min(BASE_MS << i, CAP_MS);
+    // Seen on the first loop pass at or after the retry time
+    TEST_ASSERT_GREATER_OR_EQUAL(expected / 100 * 80, gap);
+    TEST_ASSERT_LESS_OR_EQUAL(expected / 100 * 120 + 100, gap);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_backoff_doubles_up_to_the_cap);
+  RUN_TEST(test_long_base_does_not_wrap);
+  RUN_TEST(test_jitter_spreads_retries);
+  RUN_TEST(test_due_across_the_clock_wrap);
+  RUN_TEST(test_poller_backs_off_from_a_failing_server);
+  return UNITY_END();
+}
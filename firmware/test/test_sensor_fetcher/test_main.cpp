@@ -0,0 +1,170 @@
+// Conditional sensor fetches against a local server serving validators
+#include "../../src/network/SensorFetcher.h"
+#include <LocalServer.h>
+#include <mutex>
+#include <unity.h>
+
+static std::mutex seenLock;
+static std::string seenIfNoneMatch;
+static std::string seenIfModifiedSince;
+
+static void remember(const LocalServer::Request &request) {
+  std::lock_guard<std::mutex> guard(seenLock);
+  seenIfNoneMatch = request.header("If-None-Match");
+  seenIfModifiedSince = request.header("If-Modified-Since");
+}
+
+// JSON at /json (ETag), Prometheus at /prom (Last-Modified), 500 elsewhere
+static LocalServer::Response serve(const LocalServer::Request &request) {
+  remember(request);
+  LocalServer::Response response;
+  if (request.path == "/json") {
+    response.headers = "ETag: \"v1\"\r\n";
+    if (request.header("If-None-Match") == "\"v1\"")
+      response.code = 304;
+    else
+      response.body = "{\"data\":{\"temp\":21.5,\"hum\":\"48\"},\"pad\":[1,2]}";
+  } else if (request.path == "/prom") {
+    response.headers = "Last-Modified: Mon, 19 Oct 2026 04:00:00 GMT\r\n";
+    if (!request.header("If-Modified-Since").empty())
+      response.code = 304;
+    else
+      response.body = "{\"status\":\"success\",\"data\":{\"resultType\":"
+                      "\"vector\",\"result\":[{\"metric\":{},"
+                      "\"value\":[1,\"1500\"]}]}}";
+  } else {
+    response.code = 500;
+  }
+  return response;
+}
+
+static LocalServer *server;
+
+static SensorConfig jsonSensor(const char *path) {
+  SensorConfig config;
+  config.type = "json";
+  config.jsonPath = path;
+  config.enabled = true;
+  return config;
+}
+
+static FetchStatus fetch(int slot, const String &url,
+                         const SensorConfig &config, bool conditional,
+                         float &value) {
+  FetchSource source;
+  source.prometheus = config.type == "prometheus";
+  source.divisor = config.divisor;
+  source.path.compile(config.jsonPath);
+  return SensorFetcher::fetch(slot, url, source, conditional, value);
+}
+
+void setUp() {
+  for (int i = 0; i < ResponseCache::CAPACITY; i++)
+    SensorFetcher::cache().remove(i);
+}
+
+void tearDown() {}
+
+void test_cache_entries_belong_to_a_slot_and_url() {
+  ResponseCache cache;
+  cache.store(0, "http://a/x", "\"e\"", "");
+  TEST_ASSERT_NOT_NULL(cache.find(0, "http://a/x"));
+  TEST_ASSERT_NULL(cache.find(1, "http://a/x"));
+  TEST_ASSERT_NULL(cache.find(0, "http://a/y"));
+  TEST_ASSERT_EQUAL(1, cache.size());
+
+  cache.store(0, "http://a/x", "", ""); // No validators: forget the slot
+  TEST_ASSERT_NULL(cache.find(0, "http://a/x"));
+  cache.store(2, "http://a/x", "", "Mon");
+  cache.remove(2);
+  TEST_ASSERT_EQUAL(0, cache.size());
+}
+
+void test_unchanged_body_is_answered_with_304() {
+  String url = server->url("/json");
+  SensorConfig config = jsonSensor("data.temp");
+  uint32_t hits = SensorFetcher::cache().hits();
+  float value = 0;
+
+  TEST_ASSERT_EQUAL(FetchStatus::OK, fetch(0, url, config, false, value));
+  TEST_ASSERT_EQUAL_FLOAT(21.5f, value);
+  TEST_ASSERT_EQUAL_STRING("", seenIfNoneMatch.c_str());
+
+  value = 0;
+  TEST_ASSERT_EQUAL(FetchStatus::NOT_MODIFIED,
+                    fetch(0, url, config, true, value));
+  TEST_ASSERT_EQUAL_STRING("\"v1\"", seenIfNoneMatch.c_str());
+  TEST_ASSERT_EQUAL_FLOAT(0, value); // Left untouched on a 304
+  TEST_ASSERT_EQUAL_UINT32(hits + 1, SensorFetcher::cache().hits());
+}
+
+void test_slots_sharing_a_url_keep_their_own_validators() {
+  String url = server->url("/json");
+  float temp = 0, hum = 0;
+
+  TEST_ASSERT_EQUAL(FetchStatus::OK,
+                    fetch(0, url, jsonSensor("data.temp"), false, temp));
+  // Slot 1 has no value yet: slot 0's ETag must not earn it a 304
+  TEST_ASSERT_EQUAL(FetchStatus::OK,
+                    fetch(1, url, jsonSensor("data.hum"), true, hum));
+  TEST_ASSERT_EQUAL_STRING("", seenIfNoneMatch.c_str());
+  TEST_ASSERT_EQUAL_FLOAT(21.5f, temp);
+  TEST_ASSERT_EQUAL_FLOAT(48, hum);
+
+  TEST_ASSERT_EQUAL(FetchStatus::NOT_MODIFIED,
+                    fetch(1, url, jsonSensor("data.hum"), true, hum));
+}
+
+void test_unconditional_fetch_drops_validators() {
+  String url = server->url("/json");
+  float value = 0;
+  fetch(0, url, jsonSensor("data.temp"), false, value);
+
+  // Path changed on the same URL (a refetch): the new path is parsed
+  SensorConfig config = jsonSensor("data.hum");
+  config.divisor = 4;
+  TEST_ASSERT_EQUAL(FetchStatus::OK, fetch(0, url, config, false, value));
+  TEST_ASSERT_EQUAL_STRING("", seenIfNoneMatch.c_str());
+  TEST_ASSERT_EQUAL_FLOAT(12, value);
+}
+
+void test_last_modified_is_sent_back() {
+  String url = server->url("/prom");
+  SensorConfig config;
+  config.type = "prometheus";
+  config.divisor = 1000;
+  float value = 0;
+
+  TEST_ASSERT_EQUAL(FetchStatus::OK, fetch(3, url, config, true, value));
+  TEST_ASSERT_EQUAL_FLOAT(1.5f, value);
+  TEST_ASSERT_EQUAL(FetchStatus::NOT_MODIFIED,
+                    fetch(3, url, config, true, value));
+  TEST_ASSERT_EQUAL_STRING("Mon, 19 Oct 2026 04:00:00 GMT",
+                           seenIfModifiedSince.c_str());
+}
+
+void test_failures_store_no_validators() {
+  float value = 0;
+  TEST_ASSERT_EQUAL(FetchStatus::FAILED, fetch(4, server->url("/down"),
+                                               jsonSensor("a"), true, value));
+
+  // 200 with validators, but the path is missing from the body
+  String url = server->url("/json");
+  TEST_ASSERT_EQUAL(FetchStatus::FAILED,
+                    fetch(4, url, jsonSensor("data.missing"), true, value));
+  TEST_ASSERT_NULL(SensorFetcher::cache().find(4, url));
+}
+
+int main() {
+  LocalServer local(serve);
+  server = &local;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_cache_entries_belong_to_a_slot_and_url);
+  RUN_TEST(test_unchanged_body_is_answered_with_304);
+  RUN_TEST(test_slots_sharing_a_url_keep_their_own_validators);
+  RUN_TEST(test_unconditional_fetch_drops_validators);
+  RUN_TEST(test_last_modified_is_sent_back);
+  RUN_TEST(test_failures_store_no_validators);
+  return UNITY_END();
+}
@@ -0,0 +1,193 @@
+// Sensor history: int16 deltas in display steps, rebasing and coarsening on
+// overflow, clearing on a source change, min/max column downsampling
+#include "../../src/SensorHistory.h"
+#include "../../src/modules/SensorModule.h"
+#include <Preferences.h>
+#include <unity.h>
+
+static SensorHistory history;
+static int16_t lo[SensorHistory::DEPTH];
+static int16_t hi[SensorHistory::DEPTH];
+
+// One column per sample, so lo == hi is the stored delta
+static int deltas(int slot) {
+  int n = history.downsample(slot, SensorHistory::DEPTH, lo, hi);
+  for (int c = 0; c < n; c++)
+    TEST_ASSERT_EQUAL(lo[c], hi[c]);
+  return n;
+}
+
+void setUp() {
+  for (int slot = 0; slot < SENSOR_SLOTS; slot++)
+    history.clear(slot);
+}
+
+void tearDown() {}
+
+void test_samples_are_steps_of_the_display_precision() {
+  history.push(0, 20.0f, 1);
+  history.push(0, 20.1f, 1);
+  history.push(0, 20.3f, 1);
+  history.push(0, 19.5f, 1);
+
+  TEST_ASSERT_EQUAL(4, deltas(0));
+  TEST_ASSERT_EQUAL(0, lo[0]);
+  TEST_ASSERT_EQUAL(1, lo[1]);
+  TEST_ASSERT_EQUAL(3, lo[2]);
+  TEST_ASSERT_EQUAL(-5, lo[3]);
+}
+
+void test_invalid_samples_are_ignored() {
+  history.push(0, NAN, 1);
+  history.push(0, INFINITY, 1);
+  history.push(-1, 1.0f, 1);
+  history.push(SENSOR_SLOTS, 1.0f, 1);
+  TEST_ASSERT_EQUAL(0, history.count(0));
+}
+
+void test_overflow_rebases_around_the_window() {
+  // 5000 is 50000 steps of 0.1 away: re-centered, the span still fits
+  history.push(0, 0.0f, 1);
+  history.push(0, 5000.0f, 1);
+
+  TEST_ASSERT_EQUAL(2, deltas(0));
+  TEST_ASSERT_EQUAL(-25000, lo[0]);
+  TEST_ASSERT_EQUAL(25000, lo[1]);
+
+  // Same precision as before the rebase
+  history.push(0, 2500.1f, 1);
+  TEST_ASSERT_EQUAL(3, deltas(0));
+  TEST_ASSERT_EQUAL(1, lo[2]);
+}
+
+void test_overflow_coarsens_the_step_until_the_span_fits() {
+  // 100000 steps of 0.1 do not fit even centered: the step doubles to 0.2
+  history.push(0, 0.0f, 1);
+  history.push(0, 10000.0f, 1);
+
+  TEST_ASSERT_EQUAL(2, deltas(0));
+  TEST_ASSERT_EQUAL(-25000, lo[0]);
+  TEST_ASSERT_EQUAL(25000, lo[1]);
+
+  history.push(0, 5001.0f, 1);
+  TEST_ASSERT_EQUAL(3, deltas(0));
+  TEST_ASSERT_EQUAL(5, lo[2]); // 1.0 in steps of 0.2
+}
+
+void test_rebase_keeps_order_after_wrapping() {
+  int extra = 10;
+  for (int i = 0; i < SensorHistory::DEPTH + extra; i++)
+    history.push(0, (float)i, 0);
+  history.push(0, 40000.0f, 0); // Rebase with a wrapped ring
+
+  // Re-encoded oldest first: consecutive values stay one step apart
+  int n = deltas(0);
+  TEST_ASSERT_EQUAL(SensorHistory::DEPTH, n);
+  for (int c = 1; c < n - 1; c++)
+    TEST_ASSERT_EQUAL(lo[c - 1] + 1, lo[c]);
+  TEST_ASSERT_EQUAL(40000 - (extra + 1), lo[n - 1] - lo[0]);
+}
+
+void test_ring_keeps_the_newest_samples() {
+  for (int i = 0; i < SensorHistory::DEPTH + 5; i++)
+    history.push(0, (float)i, 0);
+
+  TEST_ASSERT_EQUAL(SensorHistory::DEPTH, history.count(0));
+  TEST_ASSERT_EQUAL(SensorHistory::DEPTH, deltas(0));
+  TEST_ASSERT_EQUAL(5, lo[0]); // Samples 0..4 were overwritten
+  TEST_ASSERT_EQUAL(SensorHistory::DEPTH + 4, lo[SensorHistory::DEPTH - 1]);
+}
+
+void test_clear_restarts_the_slot_with_its_new_precision() {
+  history.push(2, 1.5f, 1);
+  history.push(2, 1.7f, 1);
+  history.push(3, 8.0f, 0);
+
+  history.clear(2);
+  TEST_ASSERT_EQUAL(0, history.count(2));
+  TEST_ASSERT_EQUAL(0, history.downsample(2, 10, lo, hi));
+  TEST_ASSERT_EQUAL(1, history.count(3)); // Other slots untouched
+
+  history.push(2, 300.0f, 0);
+  history.push(2, 302.0f, 0);
+  TEST_ASSERT_EQUAL(2, deltas(2));
+  TEST_ASSERT_EQUAL(0, lo[0]); // New base
+  TEST_ASSERT_EQUAL(2, lo[1]); // Steps of 1
+}
+
+void test_source_change_clears_the_slot_history() {
+  ConfigHelper legacy;
+  ConfigStore store(legacy);
+  Preferences::eraseAll();
+  store.load();
+  SensorModule module("Sensors", 8);
+  module.setConfig(&store);
+
+  for (int slot = 8; slot < 11; slot++) {
+    sensorHistory.clear(slot);
+    sensorHistory.push(slot, 1.0f, 1);
+    sensorHistory.push(slot, 2.0f, 1);
+  }
+
+  ConfigChange change;
+  change.refetch = 1u << 9;  // New URL for slot 9
+  change.relabel = 1u << 10; // Only a new label for slot 10
+  module.onConfigChange(change);
+
+  TEST_ASSERT_EQUAL(2, sensorHistory.count(8));
+  TEST_ASSERT_EQUAL(0, sensorHistory.count(9));
+  TEST_ASSERT_EQUAL(2, sensorHistory.count(10));
+}
+
+void test_downsample_keeps_min_and_max_per_column() {
+  for (int i = 0; i < SensorHistory::DEPTH; i++)
+    history.push(0, (float)(i % 2 ? i : -i), 0);
+
+  int width = SensorHistory::DEPTH / 2;
+  TEST_ASSERT_EQUAL(width, history.downsample(0, width, lo, hi));
+  for (int c = 0; c < width; c++) {
+    TEST_ASSERT_EQUAL(-2 * c, lo[c]);
+    TEST_ASSERT_EQUAL(2 * c + 1, hi[c]);
+  }
+}
+
+void test_downsample_covers_every_sample_in_order() {
+  for (int i = 0; i < SensorHistory::DEPTH; i++)
+    history.push(0, (float)i, 0);
+
+  // Columns of uneven size: every sample lands in exactly one, in order
+  int width = 40;
+  TEST_ASSERT_EQUAL(width, history.downsample(0, width, lo, hi));
+  TEST_ASSERT_EQUAL(0, lo[0]);
+  TEST_ASSERT_EQUAL(SensorHistory::DEPTH - 1, hi[width - 1]);
+  for (int c = 1; c < width; c++) {
+    TEST_ASSERT_TRUE(lo[c] <= hi[c]);
+    TEST_ASSERT_EQUAL(hi[c - 1] + 1, lo[c]);
+  }
+}
+
+void test_downsample_uses_one_column_per_sample_when_short() {
+  for (int i = 0; i < 10; i++)
+    history.push(0, (float)i, 0);
+
+  TEST_ASSERT_EQUAL(10, history.downsample(0, 48, lo, hi));
+  TEST_ASSERT_EQUAL(9, hi[9]);
+  TEST_ASSERT_EQUAL(0, history.downsample(1, 48, lo, hi)); // Empty slot
+  TEST_ASSERT_EQUAL(0, history.downsample(0, 0, lo, hi));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_samples_are_steps_of_the_display_precision);
+  RUN_TEST(test_invalid_samples_are_ignored);
+  RUN_TEST(test_overflow_rebases_around_the_window);
+  RUN_TEST(test_overflow_coarsens_the_step_until_the_span_fits);
+  RUN_TEST(test_rebase_keeps_order_after_wrapping);
+  RUN_TEST(test_ring_keeps_the_newest_samples);
+  RUN_TEST(test_clear_restarts_the_slot_with_its_new_precision);
+  RUN_TEST(test_source_change_clears_the_slot_history);
+  RUN_TEST(test_downsample_keeps_min_and_max_per_column);
+  RUN_TEST(test_downsample_covers_every_sample_in_order);
+  RUN_TEST(test_downsample_uses_one_column_per_sample_when_short);
+  return UNITY_END();
+}
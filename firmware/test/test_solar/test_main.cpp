@@ -0,0 +1,142 @@
+// Solar ephemeris against published tables: sunrise and sunset in Paris,
+// Sydney and Tromso (polar day and night), USNO equinoxes and solstices
+#include "../../src/SolarCalculator.h"
+#include <unity.h>
+
+// Published times are rounded to the minute
+static const long EVENT_TOLERANCE_SEC = 120;
+
+static const double PARIS_LAT = 48.8566, PARIS_LON = 2.3522;
+static const double SYDNEY_LAT = -33.8688, SYDNEY_LON = 151.2093;
+static const double TROMSO_LAT = 69.6492, TROMSO_LON = 18.9553;
+
+static time_t utc(int year, int month, int mday, int hour, int minute) {
+  return (time_t)SolarCalculator::daysFromCivil(year, month, mday) * 86400 +
+         hour * 3600 + minute * 60;
+}
+
+static void assertNear(time_t expected, time_t actual, long toleranceSec) {
+  TEST_ASSERT_INT_WITHIN(toleranceSec, (long)expected, (long)actual);
+}
+
+static void assertSunEvents(SolarCalculator::Day day, time_t rise,
+                            time_t set) {
+  TEST_ASSERT_TRUE(day.rises);
+  assertNear(rise, day.sunrise, EVENT_TOLERANCE_SEC);
+  assertNear(set, day.sunset, EVENT_TOLERANCE_SEC);
+  TEST_ASSERT_EQUAL(day.sunset - day.sunrise, day.lengthSec);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+// 05:47 / 21:58 CEST and 08:41 / 16:56 CET
+void test_paris_solstices() {
+  assertSunEvents(SolarCalculator::day(2024, 6, 21, PARIS_LAT, PARIS_LON),
+                  utc(2024, 6, 21, 3, 47), utc(2024, 6, 21, 19, 58));
+  assertSunEvents(SolarCalculator::day(2024, 12, 21, PARIS_LAT, PARIS_LON),
+                  utc(2024, 12, 21, 7, 41), utc(2024, 12, 21, 15, 56));
+}
+
+// Events belong to the local date: the sunrise is still the previous day
+// in UTC. 05:41 / 20:05 AEDT and 07:00 / 16:54 AEST.
+void test_sydney_solstices() {
+  assertSunEvents(SolarCalculator::day(2024, 12, 21, SYDNEY_LAT, SYDNEY_LON),
+                  utc(2024, 12, 20, 18, 41), utc(2024, 12, 21, 9, 5));
+  assertSunEvents(SolarCalculator::day(2024, 6, 21, SYDNEY_LAT, SYDNEY_LON),
+                  utc(2024, 6, 20, 21, 0), utc(2024, 6, 21, 6, 54));
+}
+
+void test_tromso_polar_day_and_night() {
+  SolarCalculator::Day summer =
+      SolarCalculator::day(2024, 6, 21, TROMSO_LAT, TROMSO_LON);
+  TEST_ASSERT_FALSE(summer.rises);
+  TEST_ASSERT_TRUE(summer.polarDay);
+  TEST_ASSERT_EQUAL(86400, summer.lengthSec);
+
+  SolarCalculator::Day winter =
+      SolarCalculator::day(2024, 12, 21, TROMSO_LAT, TROMSO_LON);
+  TEST_ASSERT_FALSE(winter.rises);
+  TEST_ASSERT_FALSE(winter.polarDay);
+  TEST_ASSERT_EQUAL(0, winter.lengthSec);
+
+  // Refraction makes the equinox day a little longer than 12 h up there
+  SolarCalculator::Day equinox =
+      SolarCalculator::day(2024, 3, 20, TROMSO_LAT, TROMSO_LON);
+  TEST_ASSERT_TRUE(equinox.rises);
+  TEST_ASSERT_GREATER_THAN(12 * 3600, equinox.lengthSec);
+  TEST_ASSERT_LESS_THAN(12 * 3600 + 30 * 60, equinox.lengthSec);
+}
+
+enum State { RISES, POLAR_DAY, POLAR_NIGHT };
+
+static State stateOn(long days) {
+  SolarCalculator::Day day = SolarCalculator::day(days, TROMSO_LAT, TROMSO_LON);
+  if (day.rises)
+    return RISES;
+  return day.polarDay ? POLAR_DAY : POLAR_NIGHT;
+}
+
+// Tromso's published season edges, within a day: the sun returns on
+// Jan 15, the midnight sun runs May 17 - Jul 26, polar night from Nov 27
+void test_tromso_season_edges() {
+  struct Edge {
+    int month, mday;
+    State from, to;
+  };
+  const Edge edges[] = {{1, 15, POLAR_NIGHT, RISES},
+                        {5, 17, RISES, POLAR_DAY},
+                        {7, 26, POLAR_DAY, RISES},
+                        {11, 27, RISES, POLAR_NIGHT}};
+
+  for (const Edge &edge : edges) {
+    long days = SolarCalculator::daysFromCivil(2024, edge.month, edge.mday);
+    bool found = false;
+    for (long d = days - 1; d <= days + 1 && !found; d++)
+      found = stateOn(d - 1) == edge.from && stateOn(d) == edge.to;
+    TEST_ASSERT_TRUE_MESSAGE(found, "Season edge more than a day off");
+  }
+}
+
+// USNO "Earth's Seasons" table, UTC, rounded to the minute
+void test_equinoxes_and_solstices_match_usno() {
+  struct Instant {
+    int year;
+    SolarCalculator::Boundary which;
+    time_t expected;
+  };
+  const Instant table[] = {
+      {2024, SolarCalculator::MARCH_EQUINOX, utc(2024, 3, 20, 3, 6)},
+      {2024, SolarCalculator::JUNE_SOLSTICE, utc(2024, 6, 20, 20, 51)},
+      {2024, SolarCalculator::SEPTEMBER_EQUINOX, utc(2024, 9, 22, 12, 44)},
+      {2024, SolarCalculator::DECEMBER_SOLSTICE, utc(2024, 12, 21, 9, 20)},
+      {2025, SolarCalculator::MARCH_EQUINOX, utc(2025, 3, 20, 9, 1)},
+      {2025, SolarCalculator::JUNE_SOLSTICE, utc(2025, 6, 21, 2, 42)},
+      {2025, SolarCalculator::SEPTEMBER_EQUINOX, utc(2025, 9, 22, 18, 19)},
+      {2025, SolarCalculator::DECEMBER_SOLSTICE, utc(2025, 12, 21, 15, 3)},
+  };
+  for (const Instant &i : table)
+    assertNear(i.expected, SolarCalculator::boundary(i.year, i.which), 120);
+}
+
+void test_civil_days_round_trip() {
+  TEST_ASSERT_EQUAL(0, SolarCalculator::daysFromCivil(1970, 1, 1));
+  TEST_ASSERT_EQUAL(19783, SolarCalculator::daysFromCivil(2024, 3, 1));
+  for (long d = 19000; d < 21000; d++) {
+    int year, month, mday;
+    SolarCalculator::civilFromDays(d, year, month, mday);
+    TEST_ASSERT_EQUAL(d, SolarCalculator::daysFromCivil(year, month, mday));
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_paris_solstices);
+  RUN_TEST(test_sydney_solstices);
+  RUN_TEST(test_tromso_polar_day_and_night);
+  RUN_TEST(test_tromso_season_edges);
+  RUN_TEST(test_equinoxes_and_solstices_match_usno);
+  RUN_TEST(test_civil_days_round_trip);
+  return UNITY_END();
+}
@@ -0,0 +1,111 @@
+// SpscQueue: capacity, FIFO order, and ordering across two real threads
+#include "../../src/network/SpscQueue.h"
+#include <Arduino.h>
+#include <atomic>
+#include <thread>
+#include <unity.h>
+
+static const uint32_t ITEMS = 200000;
+
+struct Message {
+  uint32_t seq = 0;
+  String text; // Moved through the ring, like FetchRequest::url
+};
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_full_queue_rejects_and_keeps_the_item() {
+  SpscQueue<Message, 4> queue;
+  for (uint32_t i = 0; i < 4; i++) {
+    Message m;
+    m.seq = i;
+    TEST_ASSERT_TRUE(queue.push(m));
+  }
+  TEST_ASSERT_EQUAL(4, queue.size());
+
+  Message extra;
+  extra.seq = 99;
+  extra.text = "kept";
+  TEST_ASSERT_FALSE(queue.push(extra));
+  TEST_ASSERT_EQUAL_STRING("kept", extra.text.c_str());
+  TEST_ASSERT_EQUAL(4, queue.size());
+
+  Message out;
+  TEST_ASSERT_TRUE(queue.pop(out));
+  TEST_ASSERT_EQUAL(0, out.seq);
+  TEST_ASSERT_TRUE(queue.push(extra)); // One slot freed
+}
+
+void test_fifo_order_across_wraparound() {
+  SpscQueue<Message, 8> queue;
+  uint32_t next = 0, expected = 0;
+  // Keep the ring partly full while the indices go around many times
+  for (int round = 0; round < 1000; round++) {
+    for (int i = 0; i < 5; i++) {
+      Message m;
+      m.seq = next++;
+      TEST_ASSERT_TRUE(queue.push(m));
+    }
+    for (int i = 0; i < 5; i++) {
+      Message out;
+      TEST_ASSERT_TRUE(queue.pop(out));
+      TEST_ASSERT_EQUAL_UINT32(expected++, out.seq);
+    }
+  }
+  Message out;
+  TEST_ASSERT_FALSE(queue.pop(out));
+  TEST_ASSERT_TRUE(queue.empty());
+}
+
+// The fetch ring's use: one task produces, another consumes, both spin
+// when the ring is full or empty. Every item arrives once, in order, with
+// its payload intact, and the consumer never sees more than N queued.
+void test_two_threads_keep_order_and_capacity() {
+  static SpscQueue<Message, 8> queue;
+  std::atomic<bool> done{false};
+
+  std::thread producer([&] {
+    for (uint32_t i = 0; i < ITEMS; i++) {
+      Message m;
+      m.seq = i;
+      m.text = String((unsigned long)i);
+      while (!queue.push(m))
+        std::this_thread::yield();
+    }
+    done = true;
+  });
+
+  uint32_t expected = 0;
+  uint32_t outOfOrder = 0, badText = 0;
+  size_t maxSize = 0;
+  while (expected < ITEMS) {
+    maxSize = max(maxSize, queue.size());
+    Message out;
+    if (!queue.pop(out)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (out.seq != expected)
+      outOfOrder++;
+    if (out.text != String((unsigned long)expected))
+      badText++;
+    expected++;
+  }
+  producer.join();
+
+  TEST_ASSERT_TRUE(done);
+  TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+  TEST_ASSERT_EQUAL_UINT32(0, badText);
+  TEST_ASSERT_LESS_OR_EQUAL(8, maxSize);
+  TEST_ASSERT_TRUE(queue.empty());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_full_queue_rejects_and_keeps_the_item);
+  RUN_TEST(test_fifo_order_across_wraparound);
+  RUN_TEST(test_two_threads_keep_order_and_capacity);
+  return UNITY_END();
+}
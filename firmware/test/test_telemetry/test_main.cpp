@@ -0,0 +1,138 @@
+// Telemetry flush: sink called without the lock, busy links keep the state
+#include "../../src/telemetry.h"
+#include <unity.h>
+
+static Telemetry *t;
+static JsonDocument last;
+static int calls;
+static bool linkBusy;
+static std::function<void()> duringSend;
+
+static bool sink(const JsonDocument &doc) {
+  calls++;
+  if (duringSend)
+    duringSend(); // Another task publishing while the link is busy
+  if (linkBusy)
+    return false;
+  last = doc;
+  return true;
+}
+
+void setUp() {
+  ArduinoStub::reset(1000);
+  t = new Telemetry();
+  last.clear();
+  calls = 0;
+  linkBusy = false;
+  duringSend = nullptr;
+  t->subscribe(sink, Telemetry::MIN_INTERVAL);
+}
+
+void tearDown() { delete t; }
+
+void test_flushes_once_per_interval() {
+  t->publishValue(0, 1.5f);
+  t->loop();
+  TEST_ASSERT_EQUAL(1, calls);
+  TEST_ASSERT_EQUAL_FLOAT(1.5f, last["values"]["0"].as<float>());
+
+  t->publishValue(0, 2.5f);
+  t->loop();
+  TEST_ASSERT_EQUAL(1, calls);
+  ArduinoStub::advance(Telemetry::MIN_INTERVAL);
+  t->loop();
+  TEST_ASSERT_EQUAL(2, calls);
+  TEST_ASSERT_EQUAL_FLOAT(2.5f, last["values"]["0"].as<float>());
+  TEST_ASSERT_EQUAL(2, t->sent());
+}
+
+// Held the lock across the sink before, which deadlocked right here
+void test_sink_may_publish_while_sending() {
+  duringSend = [] { t->publishValue(4, 9.0f); };
+  t->publishValue(0, 1.0f);
+  t->loop();
+  TEST_ASSERT_TRUE(last["values"]["4"].isNull());
+
+  duringSend = nullptr;
+  ArduinoStub::advance(Telemetry::MIN_INTERVAL);
+  t->loop();
+  TEST_ASSERT_EQUAL_FLOAT(9.0f, last["values"]["4"].as<float>());
+  TEST_ASSERT_TRUE(last["values"]["0"].isNull());
+}
+
+void test_busy_link_keeps_pending_state() {
+  linkBusy = true;
+  t->publishValue(1, 3.0f);
+  t->publishRefresh("sensor", true, 1200);
+  t->loop();
+  TEST_ASSERT_EQUAL(0, t->sent());
+
+  linkBusy = false;
+  ArduinoStub::advance(Telemetry::MIN_INTERVAL);
+  t->loop();
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, last["values"]["1"].as<float>());
+  TEST_ASSERT_EQUAL_STRING("sensor",
+                           last["refresh"][0]["module"].as<const char *>());
+  TEST_ASSERT_EQUAL(1, t->sent());
+}
+
+void test_value_published_during_failed_send_wins() {
+  linkBusy = true;
+  duringSend = [] { t->publishValue(1, 7.0f); };
+  t->publishValue(1, 3.0f);
+  t->loop();
+
+  linkBusy = false;
+  duringSend = nullptr;
+  ArduinoStub::advance(Telemetry::MIN_INTERVAL);
+  t->loop();
+  TEST_ASSERT_EQUAL_FLOAT(7.0f, last["values"]["1"].as<float>());
+  TEST_ASSERT_EQUAL(1, t->dropped()); // The 3.0 was superseded
+}
+
+void test_merge_keeps_most_recent_refreshes() {
+  linkBusy = true;
+  for (int i = 0; i < 3; i++)
+    t->publishRefresh(("old" + String(i)).c_str(), false, i);
+  duringSend = [] {
+    for (int i = 0; i < 3; i++)
+      t->publishRefresh(("new" + String(i)).c_str(), false, i);
+  };
+  t->loop();
+
+  linkBusy = false;
+  duringSend = nullptr;
+  ArduinoStub::advance(Telemetry::MIN_INTERVAL);
+  t->loop();
+  JsonArrayConst refreshes = last["refresh"];
+  TEST_ASSERT_EQUAL(4, refreshes.size());
+  TEST_ASSERT_EQUAL_STRING("old2",
+                           refreshes[0]["module"].as<const char *>());
+  TEST_ASSERT_EQUAL_STRING("new2",
+                           refreshes[3]["module"].as<const char *>());
+  TEST_ASSERT_EQUAL(2, t->dropped());
+}
+
+void test_unsubscribe_during_send_drops_state() {
+  linkBusy = true;
+  duringSend = [] { t->unsubscribe(); };
+  t->publishValue(0, 1.0f);
+  t->loop();
+
+  linkBusy = false;
+  duringSend = nullptr;
+  t->subscribe(sink, Telemetry::MIN_INTERVAL);
+  t->loop();
+  TEST_ASSERT_EQUAL(1, calls);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_flushes_once_per_interval);
+  RUN_TEST(test_sink_may_publish_while_sending);
+  RUN_TEST(test_busy_link_keeps_pending_state);
+  RUN_TEST(test_value_published_during_failed_send_wins);
+  RUN_TEST(test_merge_keeps_most_recent_refreshes);
+  RUN_TEST(test_unsubscribe_during_send_drops_state);
+  return UNITY_END();
+}
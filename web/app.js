@@ -1,6 +1,16 @@
 // BLE Service and Characteristics UUIDs
 const SERVICE_UUID = "4fafc201-1fb5-459e-8fcc-c5c9c331914b";
 const CHAR_JSON_GATE_UUID = "a1b2c3d4-1234-5678-9abc-def012345685";
+// Optional sync channel (JSON or MessagePack frames, incremental config sync)
+const SYNC_SERVICE_UUID = "4fafc201-1fb5-459e-8fcc-c5c9c331914c";
+const CHAR_SYNC_UUID = "a1b2c3d4-1234-5678-9abc-def012345686";
+const FRAME_JSON = 0x00;
+const FRAME_MSGPACK = 0x01;
+const FRAME_ACK = 0x02;
+// Windowed writes on the sync channel (see firmware ble_channel.h)
+const OP_DATA = 0x10;
+const OP_END = 0x11;
+const ACK_OK = 0, ACK_RETRY = 1, ACK_BAD = 2, ACK_DONE = 3;
 
 // Register Service Worker for PWA
 if ('serviceWorker' in navigator) {
@@ -13,12 +23,17 @@ if ('serviceWorker' in navigator) {
 
 let device, server, service;
 let characteristics = {};
-let rxBuffer = new Uint8Array(0);
-let rxExpectedLen = 0;
-let rxExpectedType = 0;
-let rxState = 'HEADER';
 let sensorDataResolver = null;
 let configDataResolver = null;
+let pendingResponses = {}; // response cmd -> resolve
+let dirtySensors = new Set(); // Slots edited since the last save
+let syncLink = { mtu: 23, window: 1 }; // Read from the sync characteristic
+let syncTx = Promise.resolve(); // Serializes windowed transfers
+let ackWaiter = null;
+const TELEMETRY_INTERVAL_MS = 1000;
+const SAVE_RETRY_MS = 500; // The device answers "busy" until its loop catches up
+const SAVE_RETRIES = 10;
+let pendingSave = null; // { command, attempts } until save_ok or save_failed
 
 // DOM Elements
 let currentSelectedSlot = 0; // State tracking
@@ -122,23 +137,33 @@ window.showTab = function (tabId) {
 };
 
 // BLE Logic
-function prepareBleJson(obj) {
-    const json = JSON.stringify(obj);
-    const encoder = new TextEncoder();
-    const payload = encoder.encode(json);
-    const header = new Uint8Array([0x00, payload.length & 0xFF, (payload.length >> 8) & 0xFF]);
+function prepareBleFrame(type, payload) {
+    const header = new Uint8Array([type, payload.length & 0xFF, (payload.length >> 8) & 0xFF]);
     const bytes = new Uint8Array(header.length + payload.length);
     bytes.set(header);
     bytes.set(payload, header.length);
     return bytes;
 }
 
+function prepareBleJson(obj) {
+    return prepareBleFrame(FRAME_JSON, new TextEncoder().encode(JSON.stringify(obj)));
+}
+
 async function sendCommand(cmdObj) {
     if (!characteristics.gate) {
         console.error("Not connected");
         return;
     }
 
+    // Prefer the sync channel with MessagePack, fall back to the JSON gate
+    if (characteristics.sync) {
+        const frame = prepareBleFrame(FRAME_MSGPACK, MsgPack.encode(cmdObj));
+        console.log(`[BLE] Sending command: ${JSON.stringify(cmdObj)} (Total bytes: ${frame.length})`);
+        const sync = characteristics.sync;
+        syncTx = syncTx.catch(() => {}).then(() => sendWindowed(sync, frame));
+        return syncTx;
+    }
+
     const bytes = prepareBleJson(cmdObj);
     console.log(`[BLE] Sending command: ${JSON.stringify(cmdObj)} (Total bytes: ${bytes.length})`);
 
@@ -149,10 +174,169 @@ async function sendCommand(cmdObj) {
     }
 }
 
+function crc32(bytes) {
+    let crc = 0xFFFFFFFF;
+    for (const b of bytes) {
+        crc ^= b;
+        for (let k = 0; k < 8; k++) crc = (crc >>> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return (crc ^ 0xFFFFFFFF) >>> 0;
+}
+
+// Resolves with the first ack accepted by `filter`
+function waitAck(filter, timeoutMs = 2000) {
+    return new Promise((resolve, reject) => {
+        const timer = setTimeout(() => {
+            ackWaiter = null;
+            reject(new Error("Timeout waiting for ack"));
+        }, timeoutMs);
+        ackWaiter = (ack) => {
+            if (!filter(ack)) return;
+            clearTimeout(timer);
+            ackWaiter = null;
+            resolve(ack);
+        };
+    });
+}
+
+function handleAck(payload) {
+    const ack = { status: payload[0], seq: payload[1] | (payload[2] << 8) };
+    if (ackWaiter) ackWaiter(ack);
+}
+
+// Streams a frame with write-without-response packets, waiting for a
+// single ack per window instead of one round trip per chunk
+async function sendWindowed(characteristic, frame) {
+    const chunkSize = Math.max(syncLink.mtu - 3 - 3, 1); // ATT header + packet header
+    const total = Math.ceil(frame.length / chunkSize);
+    const crc = crc32(frame);
+    let next = 0;
+
+    for (let attempt = 0; attempt < 5;) {
+        const end = Math.min(next + syncLink.window, total);
+        const last = end === total;
+        // Windows count from `next`, the device acks after syncLink.window
+        // packets. Window acks are ignored on the last window, the END ack
+        // settles it.
+        const ackPromise = waitAck(ack => ack.status !== ACK_OK || (!last && ack.seq >= end));
+
+        for (let seq = next; seq < end; seq++) {
+            const data = frame.subarray(seq * chunkSize, (seq + 1) * chunkSize);
+            const packet = new Uint8Array(3 + data.length);
+            packet.set([OP_DATA, seq & 0xFF, seq >> 8]);
+            packet.set(data, 3);
+            await characteristic.writeValueWithoutResponse(packet);
+        }
+        if (last) {
+            await characteristic.writeValueWithoutResponse(new Uint8Array([
+                OP_END, total & 0xFF, total >> 8,
+                crc & 0xFF, (crc >>> 8) & 0xFF, (crc >>> 16) & 0xFF, crc >>> 24
+            ]));
+        }
+
+        let ack;
+        try {
+            ack = await ackPromise;
+        } catch (e) {
+            // Lost packet or ack: resend the window, the device answers
+            // RETRY with its position if it already has part of it
+            console.warn(`[BLE] No ack, resending from ${next}`);
+            attempt++;
+            continue;
+        }
+        if (ack.status === ACK_DONE) return;
+        if (ack.status === ACK_OK) {
+            next = ack.seq;
+            continue;
+        }
+        console.warn(`[BLE] Transfer ${ack.status === ACK_BAD ? "rejected" : "gap"}, resending from ${ack.status === ACK_BAD ? 0 : ack.seq}`);
+        next = ack.status === ACK_BAD ? 0 : ack.seq;
+        attempt++;
+    }
+    throw new Error("Transfer failed");
+}
+
+// Send a command and wait for the response carrying `responseCmd`
+function request(cmdObj, responseCmd, timeoutMs = 3000) {
+    return new Promise((resolve, reject) => {
+        const timer = setTimeout(() => {
+            delete pendingResponses[responseCmd];
+            reject(new Error(`Timeout waiting for ${responseCmd}`));
+        }, timeoutMs);
+        pendingResponses[responseCmd] = (data) => {
+            clearTimeout(timer);
+            resolve(data);
+        };
+        sendCommand(cmdObj).catch(reject);
+    });
+}
+
+// Incremental sync: pull only the sections whose hash changed since the
+// last session, using a per-device cache in localStorage.
+function syncCacheKey() {
+    return `syncCache:${device.id}`;
+}
+
+function loadSyncCache() {
+    try {
+        const cache = JSON.parse(localStorage.getItem(syncCacheKey()));
+        if (cache && cache.hashes && cache.data) return cache;
+    } catch (e) { /* corrupted cache, start over */ }
+    return { hashes: { system: null, sensors: [] }, data: { sensors: [] } };
+}
+
+async function syncConfig() {
+    const cache = loadSyncCache();
+    const manifest = await request({ cmd: "get_manifest" }, "manifest");
+
+    const wantSystem = manifest.system !== cache.hashes.system;
+    const wantSensors = manifest.sensors
+        .map((hash, i) => (hash !== cache.hashes.sensors[i] ? i : -1))
+        .filter(i => i >= 0);
+    console.log(`[SYNC] Generation ${manifest.generation}: system=${wantSystem}, sensors=[${wantSensors}]`);
+
+    if (wantSystem || wantSensors.length > 0) {
+        const sections = await request({ cmd: "get_sections", system: wantSystem, sensors: wantSensors }, "sections");
+        if (sections.system) Object.assign(cache.data, sections.system);
+        Object.entries(sections.sensors || {}).forEach(([i, s]) => { cache.data.sensors[i] = s; });
+    }
+
+    cache.hashes = { system: manifest.system, sensors: manifest.sensors };
+    localStorage.setItem(syncCacheKey(), JSON.stringify(cache));
+    handleIncomingJson({ ...cache.data, cmd: "config_data", generation: manifest.generation });
+}
+
+// Forget the hashes of sections the device reported as changed, so they
+// are pulled again (in their normalized form) on the next sync
+function invalidateSyncCache(changedKeys) {
+    if (!device) return;
+    const cache = loadSyncCache();
+    changedKeys.forEach(key => {
+        const m = /^sensor_(\d+)$/.exec(key);
+        if (m) cache.hashes.sensors[parseInt(m[1])] = null;
+        else cache.hashes.system = null;
+    });
+    localStorage.setItem(syncCacheKey(), JSON.stringify(cache));
+}
+
 let fullStore = {};
 
 function handleIncomingJson(data) {
     console.log("[BLE] Received JSON:", data);
+    if (pendingResponses[data.cmd]) {
+        const resolve = pendingResponses[data.cmd];
+        delete pendingResponses[data.cmd];
+        resolve(data);
+        return;
+    }
+
+    if (data.cmd === "telemetry") {
+        Object.entries(data.values || {}).forEach(([slot, value]) => updateLiveValue(parseInt(slot), value));
+        (data.refresh || []).forEach(r =>
+            console.log(`[TELEMETRY] ${r.module} ${r.full ? "full" : "partial"} refresh (${r.ms} ms)`));
+        return;
+    }
+
     if (data.cmd === "config_data") {
         fullStore = data;
 
@@ -170,6 +354,11 @@ function handleIncomingJson(data) {
         if (data.dnsSecondary !== undefined) document.getElementById('dnsSecondary').value = data.dnsSecondary;
         if (data.tempusUrl !== undefined) document.getElementById('tempusUrl').value = data.tempusUrl;
         if (data.bleTimeout !== undefined) document.getElementById('bleTimeout').value = data.bleTimeout;
+        if (data.netTolerance !== undefined) document.getElementById('netTolerance').value = data.netTolerance;
+        if (data.lat !== undefined) document.getElementById('latitude').value = data.lat;
+        if (data.lon !== undefined) document.getElementById('longitude').value = data.lon;
+        if (data.calendar !== undefined) document.getElementById('calendarRules').value = data.calendar;
+        if (data.icsUrl !== undefined) document.getElementById('icsUrl').value = data.icsUrl;
         if (data.sensorInterval !== undefined) document.getElementById('sensorInterval').value = data.sensorInterval;
         if (data.style !== undefined) document.getElementById('styleSelector').value = data.style;
         if (data.lang !== undefined) {
@@ -189,90 +378,116 @@ function handleIncomingJson(data) {
             configDataResolver.resolve();
             configDataResolver = null;
         }
+    } else if (data.cmd === "busy") {
+        if (pendingSave && pendingSave.attempts++ < SAVE_RETRIES) {
+            const command = pendingSave.command;
+            setTimeout(() => sendCommand(command).catch(e => console.error("[BLE] Retry failed:", e)), SAVE_RETRY_MS);
+        } else {
+            pendingSave = null;
+            showStatus(translations[currentLang].status_save_failed + "busy", true);
+        }
     } else if (data.cmd === "save_ok") {
+        pendingSave = null;
+        console.log("[BLE] Changed keys:", data.changed || []);
+        invalidateSyncCache(data.changed || []);
         showStatus(translations[currentLang].status_saved, false);
+    } else if (data.cmd === "save_failed") {
+        pendingSave = null;
+        // Nothing was applied: show the device's configuration again
+        showStatus(translations[currentLang].status_save_failed + data.error, true);
+        if (characteristics.sync) syncConfig().catch(e => console.error("[SYNC] Failed:", e));
+        else sendCommand({ cmd: "get_config" });
     }
 }
 
-function onNotification(event) {
-    // .slice() creates a COPY of the buffer. Without it, rapid
-    // indications can overwrite the buffer before JS processes the event.
-    const rawBuf = event.target.value;
-    const value = new Uint8Array(rawBuf.buffer.slice(rawBuf.byteOffset, rawBuf.byteOffset + rawBuf.byteLength));
-    if (value.length === 0) {
-        console.warn("[BLE] Skipping empty notification");
-        return;
-    }
-    console.log(`[BLE] Received chunk: ${value.length} bytes`);
-
-    // Append to rxBuffer
-    const nextBuffer = new Uint8Array(rxBuffer.length + value.length);
-    nextBuffer.set(rxBuffer);
-    nextBuffer.set(value, rxBuffer.length);
-    rxBuffer = nextBuffer;
-
-    while (rxBuffer.length > 0) {
-        if (rxState === 'HEADER') {
-            if (rxBuffer.length >= 3) {
-                const type = rxBuffer[0];
-                const len = rxBuffer[1] | (rxBuffer[2] << 8);
-
-                if (type !== 0x00 || len > 5000 || len === 0) {
-                    console.warn(`[BLE] Invalid header: Type=${type}, Len=${len}. Searching for next 0x00.`);
-                    // Search for next potential header (Type=0x00)
-                    let nextHeaderIdx = -1;
-                    for (let i = 1; i < rxBuffer.length; i++) {
-                        if (rxBuffer[i] === 0x00) {
-                            nextHeaderIdx = i;
+// Reassembles [type][len lo][len hi][payload] frames from notifications.
+// The JSON gate only carries JSON frames, the sync channel also MessagePack.
+function createFrameReader(acceptedTypes) {
+    let rxBuffer = new Uint8Array(0);
+    let rxExpectedLen = 0;
+    let rxExpectedType = 0;
+    let rxState = 'HEADER';
+
+    return function onNotification(event) {
+        // .slice() creates a COPY of the buffer. Without it, rapid
+        // indications can overwrite the buffer before JS processes the event.
+        const rawBuf = event.target.value;
+        const value = new Uint8Array(rawBuf.buffer.slice(rawBuf.byteOffset, rawBuf.byteOffset + rawBuf.byteLength));
+        if (value.length === 0) {
+            console.warn("[BLE] Skipping empty notification");
+            return;
+        }
+        console.log(`[BLE] Received chunk: ${value.length} bytes`);
+
+        // Append to rxBuffer
+        const nextBuffer = new Uint8Array(rxBuffer.length + value.length);
+        nextBuffer.set(rxBuffer);
+        nextBuffer.set(value, rxBuffer.length);
+        rxBuffer = nextBuffer;
+
+        while (rxBuffer.length > 0) {
+            if (rxState === 'HEADER') {
+                if (rxBuffer.length >= 3) {
+                    const type = rxBuffer[0];
+                    const len = rxBuffer[1] | (rxBuffer[2] << 8);
+
+                    if (!acceptedTypes.includes(type) || len === 0) {
+                        console.warn(`[BLE] Invalid header: Type=${type}, Len=${len}. Searching for next header.`);
+                        // Search for next potential header (valid type byte)
+                        let nextHeaderIdx = -1;
+                        for (let i = 1; i < rxBuffer.length; i++) {
+                            if (acceptedTypes.includes(rxBuffer[i])) {
+                                nextHeaderIdx = i;
+                                break;
+                            }
+                        }
+                        if (nextHeaderIdx !== -1) {
+                            rxBuffer = rxBuffer.slice(nextHeaderIdx);
+                            continue; // Retry header parsing
+                        } else {
+                            // No header found, keep last byte in case it's part of a header
+                            rxBuffer = rxBuffer.slice(rxBuffer.length - 1);
                             break;
                         }
                     }
-                    if (nextHeaderIdx !== -1) {
-                        rxBuffer = rxBuffer.slice(nextHeaderIdx);
-                        continue; // Retry header parsing
-                    } else {
-                        // No 0x00 found, keep last byte in case it's part of a header
-                        rxBuffer = rxBuffer.slice(rxBuffer.length - 1);
-                        break;
-                    }
-                }
 
-                rxExpectedType = type;
-                rxExpectedLen = len;
-                rxBuffer = rxBuffer.slice(3);
-                rxState = 'PAYLOAD';
-                console.log(`[BLE] Header valid: Type=${rxExpectedType}, Len=${rxExpectedLen}`);
-            } else {
-                break;
+                    rxExpectedType = type;
+                    rxExpectedLen = len;
+                    rxBuffer = rxBuffer.slice(3);
+                    rxState = 'PAYLOAD';
+                    console.log(`[BLE] Header valid: Type=${rxExpectedType}, Len=${rxExpectedLen}`);
+                } else {
+                    break;
+                }
             }
-        }
 
-        if (rxState === 'PAYLOAD') {
-            if (rxBuffer.length >= rxExpectedLen) {
-                const payload = rxBuffer.slice(0, rxExpectedLen);
-                rxBuffer = rxBuffer.slice(rxExpectedLen);
-                rxState = 'HEADER';
+            if (rxState === 'PAYLOAD') {
+                if (rxBuffer.length >= rxExpectedLen) {
+                    const payload = rxBuffer.slice(0, rxExpectedLen);
+                    rxBuffer = rxBuffer.slice(rxExpectedLen);
+                    rxState = 'HEADER';
 
-                if (rxExpectedType === 0x00) { // JSON Mode
                     try {
-                        const decoder = new TextDecoder();
-                        const jsonStr = decoder.decode(payload);
-                        console.log(`[BLE] Full JSON received: ${jsonStr}`);
-                        const data = JSON.parse(jsonStr);
-                        handleIncomingJson(data);
+                        if (rxExpectedType === FRAME_ACK) {
+                            handleAck(payload);
+                        } else if (rxExpectedType === FRAME_MSGPACK) {
+                            handleIncomingJson(MsgPack.decode(payload));
+                        } else {
+                            const jsonStr = new TextDecoder().decode(payload);
+                            console.log(`[BLE] Full JSON received: ${jsonStr}`);
+                            handleIncomingJson(JSON.parse(jsonStr));
+                        }
                     } catch (e) {
-                        console.error("[BLE] JSON Parse Error:", e);
+                        console.error("[BLE] Decode Error:", e);
                         console.error("[BLE] Raw Payload:", payload);
                     }
                 } else {
-                    console.log(`[BLE] Received Binary Type ${rxExpectedType}, len ${rxExpectedLen}`);
+                    console.log(`[BLE] Waiting for payload: ${rxBuffer.length}/${rxExpectedLen}`);
+                    break; // Need more bytes for payload
                 }
-            } else {
-                console.log(`[BLE] Waiting for payload: ${rxBuffer.length}/${rxExpectedLen}`);
-                break; // Need more bytes for payload
             }
         }
-    }
+    };
 }
 
 // Connection
@@ -285,19 +500,36 @@ connectBtn.addEventListener('click', async () => {
         showStatus(translations[currentLang].status_connecting, false);
 
         device = await navigator.bluetooth.requestDevice({
-            filters: [{ services: [SERVICE_UUID] }]
+            filters: [{ services: [SERVICE_UUID] }],
+            optionalServices: [SYNC_SERVICE_UUID]
         });
         device.addEventListener('gattserverdisconnected', onDisconnected);
         server = await device.gatt.connect();
         service = await server.getPrimaryService(SERVICE_UUID);
 
+        // RESET BLE STATE ON NEW CONNECTION (fresh frame readers)
         characteristics.gate = await service.getCharacteristic(CHAR_JSON_GATE_UUID);
         await characteristics.gate.startNotifications();
-        characteristics.gate.addEventListener('characteristicvaluechanged', onNotification);
-
-        // RESET BLE STATE ON NEW CONNECTION
-        rxBuffer = new Uint8Array(0);
-        rxState = 'HEADER';
+        characteristics.gate.addEventListener('characteristicvaluechanged', createFrameReader([FRAME_JSON]));
+
+        // Sync channel is optional (older firmware only has the JSON gate)
+        characteristics.sync = null;
+        try {
+            const syncService = await server.getPrimaryService(SYNC_SERVICE_UUID);
+            const sync = await syncService.getCharacteristic(CHAR_SYNC_UUID);
+            await sync.startNotifications();
+            sync.addEventListener('characteristicvaluechanged', createFrameReader([FRAME_JSON, FRAME_MSGPACK, FRAME_ACK]));
+            // Link info: [version][window][mtu lo][mtu hi]
+            const view = await sync.readValue();
+            const info = new Uint8Array(view.buffer, view.byteOffset, view.byteLength);
+            syncLink = { mtu: info[2] | (info[3] << 8), window: info[1] || 1 };
+            characteristics.sync = sync;
+            console.log(`[BLE] Sync channel available (MessagePack, MTU ${syncLink.mtu}, window ${syncLink.window})`);
+        } catch (e) {
+            console.log("[BLE] Sync channel not available, using JSON gate");
+        }
+        pendingResponses = {};
+        dirtySensors.clear();
         console.log("[BLE] State reset for new connection.");
 
         // ⏱️ CRITICAL: Wait for BLE stack to be ready before sending commands
@@ -315,7 +547,12 @@ connectBtn.addEventListener('click', async () => {
 
         // Load initial settings and WAIT for response
         console.log("[BLE] Loading initial config...");
-        await new Promise((resolve) => {
+        if (characteristics.sync) {
+            await syncConfig().catch(e => {
+                console.error("[SYNC] Failed, requesting full config:", e);
+                return sendCommand({ cmd: "get_config" });
+            });
+        } else await new Promise((resolve) => {
             configDataResolver = { resolve };
             sendCommand({ cmd: "get_config" }).catch(() => {
                 configDataResolver = null;
@@ -327,6 +564,10 @@ connectBtn.addEventListener('click', async () => {
 
         // Load all quick views AFTER config is done
         await loadAllSensorsQuickView();
+
+        // Live values and refresh events, coalesced by the device
+        sendCommand({ cmd: "telemetry", interval: TELEMETRY_INTERVAL_MS })
+            .catch(e => console.warn("[BLE] Telemetry unavailable:", e));
     } catch (error) {
         console.error('Connection failed:', error);
         showStatus((translations[currentLang].status_connection_failed) + error.message, true);
@@ -337,6 +578,7 @@ connectBtn.addEventListener('click', async () => {
 });
 
 function onDisconnected() {
+    characteristics.sync = null;
     connectionStatus.textContent = translations[currentLang].status_disconnected;
     connectionStatus.classList.add('disconnected');
     connectionStatus.classList.remove('connected');
@@ -362,12 +604,20 @@ async function saveFullConfig(partialUpdate = {}) {
         dnsSecondary: document.getElementById('dnsSecondary').value,
         tempusUrl: document.getElementById('tempusUrl').value,
         bleTimeout: parseInt(document.getElementById('bleTimeout').value),
+        netTolerance: parseInt(document.getElementById('netTolerance').value) || 0,
+        lat: parseFloat(document.getElementById('latitude').value) || 0,
+        lon: parseFloat(document.getElementById('longitude').value) || 0,
+        calendar: document.getElementById('calendarRules').value.trim(),
+        icsUrl: document.getElementById('icsUrl').value.trim(),
         sensorInterval: parseInt(document.getElementById('sensorInterval').value),
         style: parseInt(document.getElementById('styleSelector').value),
         lang: document.getElementById('languageSelector').value,
         module_map: fullStore.module_map || "",
-        // Sensors are kept from fullStore unless updated
-        sensors: fullStore.sensors || [],
+        // Sensors are kept from fullStore unless updated. With the sync
+        // channel only the edited slots are pushed ({ "<slot>": {...} }).
+        sensors: characteristics.sync
+            ? Object.fromEntries([...dirtySensors].map(i => [i, fullStore.sensors[i]]))
+            : (fullStore.sensors || []),
         ...partialUpdate
     };
 
@@ -376,9 +626,13 @@ async function saveFullConfig(partialUpdate = {}) {
     if (pass) config.password = pass;
 
     try {
-        await sendCommand({ cmd: "save_config", config });
+        pendingSave = { command: { cmd: "save_config", config }, attempts: 0 };
+        await sendCommand(pendingSave.command);
         // Update local store immediately for UI consistency
-        Object.assign(fullStore, config);
+        const { sensors, ...settings } = config;
+        Object.assign(fullStore, settings);
+        if (Array.isArray(sensors)) fullStore.sensors = sensors;
+        dirtySensors.clear();
     } catch (e) {
         showStatus(translations[currentLang].status_save_failed + e.message, true);
     }
@@ -389,11 +643,13 @@ document.getElementById('saveWifiBtn').addEventListener('click', () => saveFullC
 document.getElementById('saveDnsBtn').addEventListener('click', () => saveFullConfig());
 document.getElementById('saveNtpBtn').addEventListener('click', () => saveFullConfig());
 document.getElementById('saveTempusUrlBtn').addEventListener('click', () => saveFullConfig());
+document.getElementById('saveCalendarBtn').addEventListener('click', () => saveFullConfig());
 
 document.getElementById('saveSensorBtn').addEventListener('click', async () => {
     const slot = currentSelectedSlot;
     if (!fullStore.sensors) fullStore.sensors = Array(16).fill({});
 
+    dirtySensors.add(slot);
     fullStore.sensors[slot] = {
         label: document.getElementById('sensorLabel').value,
         url: document.getElementById('sensorUrl').value,
@@ -402,7 +658,12 @@ document.getElementById('saveSensorBtn').addEventListener('click', async () => {
         decimals: parseInt(document.getElementById('sensorDecimals').value),
         enabled: document.getElementById('sensorEnabled').checked,
         type: document.getElementById('sensorType').value,
-        jsonPath: document.getElementById('sensorJsonPath').value
+        jsonPath: document.getElementById('sensorJsonPath').value,
+        interval: parseInt(document.getElementById('sensorRefresh').value) || 0,
+        deadband: parseFloat(document.getElementById('sensorDeadband').value) || 0,
+        deadbandMode: document.getElementById('sensorDeadbandMode').value,
+        onChange: document.getElementById('sensorOnChange').checked,
+        sparkline: document.getElementById('sensorSparkline').checked
     };
 
     await saveFullConfig();
@@ -413,7 +674,8 @@ document.getElementById('clearSensorBtn').addEventListener('click', async () =>
     const slot = currentSelectedSlot;
     if (!fullStore.sensors) fullStore.sensors = Array(16).fill({});
 
-    fullStore.sensors[slot] = { label: "", url: "", unit: "", divisor: 1, decimals: 1, enabled: false, type: "prometheus", jsonPath: "" };
+    dirtySensors.add(slot);
+    fullStore.sensors[slot] = { label: "", url: "", unit: "", divisor: 1, decimals: 1, enabled: false, type: "prometheus", jsonPath: "", interval: 0, deadband: 0, deadbandMode: "abs", onChange: true, sparkline: false };
 
     await saveFullConfig();
     updateQuickView(slot, false, "", "");
@@ -436,6 +698,11 @@ async function syncUIWithSensor(slot) {
     document.getElementById('sensorEnabled').checked = s.enabled || false;
     document.getElementById('sensorType').value = s.type || "prometheus";
     document.getElementById('sensorJsonPath').value = s.jsonPath || "";
+    document.getElementById('sensorRefresh').value = s.interval || 0;
+    document.getElementById('sensorDeadband').value = s.deadband || 0;
+    document.getElementById('sensorDeadbandMode').value = s.deadbandMode || "abs";
+    document.getElementById('sensorOnChange').checked = s.onChange !== false;
+    document.getElementById('sensorSparkline').checked = s.sparkline === true;
     document.getElementById('sensorType').dispatchEvent(new Event('change'));
 }
 
@@ -461,6 +728,15 @@ function updateQuickView(slot, enabled, label, unit) {
     }
 }
 
+// Live value pushed by the telemetry stream
+function updateLiveValue(slot, value) {
+    const qv = document.getElementById(`qv${slot}`);
+    const sensor = (fullStore.sensors || [])[slot];
+    if (!qv || !sensor || !sensor.enabled) return;
+    const decimals = sensor.decimals !== undefined ? sensor.decimals : 1;
+    qv.textContent = `✓ ${sensor.label}: ${value.toFixed(decimals)} ${sensor.unit}`;
+}
+
 function showStatus(message, isError) {
     const el = document.getElementById('statusMessage');
     el.textContent = message;
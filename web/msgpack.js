@@ -0,0 +1,124 @@
+// Minimal MessagePack codec for the BLE sync channel.
+// Covers what ArduinoJson produces and accepts: nil, bool, int, float,
+// str, array and map.
+const MsgPack = (() => {
+    const textEncoder = new TextEncoder();
+    const textDecoder = new TextDecoder();
+
+    function encode(value) {
+        const bytes = [];
+        const view = new DataView(new ArrayBuffer(8));
+
+        function pushView(n) {
+            for (let i = 0; i < n; i++) bytes.push(view.getUint8(i));
+        }
+
+        function write(v) {
+            if (v === null || v === undefined) {
+                bytes.push(0xc0);
+            } else if (typeof v === 'boolean') {
+                bytes.push(v ? 0xc3 : 0xc2);
+            } else if (typeof v === 'number') {
+                if (Number.isInteger(v) && v >= 0 && v <= 0xffffffff) {
+                    if (v < 0x80) bytes.push(v);
+                    else if (v <= 0xff) bytes.push(0xcc, v);
+                    else if (v <= 0xffff) { bytes.push(0xcd); view.setUint16(0, v); pushView(2); }
+                    else { bytes.push(0xce); view.setUint32(0, v); pushView(4); }
+                } else if (Number.isInteger(v) && v < 0 && v >= -0x80000000) {
+                    if (v >= -32) bytes.push(v & 0xff);
+                    else if (v >= -0x80) { bytes.push(0xd0); view.setInt8(0, v); pushView(1); }
+                    else if (v >= -0x8000) { bytes.push(0xd1); view.setInt16(0, v); pushView(2); }
+                    else { bytes.push(0xd2); view.setInt32(0, v); pushView(4); }
+                } else {
+                    bytes.push(0xcb); view.setFloat64(0, v); pushView(8);
+                }
+            } else if (typeof v === 'string') {
+                const s = textEncoder.encode(v);
+                if (s.length < 32) bytes.push(0xa0 | s.length);
+                else if (s.length <= 0xff) bytes.push(0xd9, s.length);
+                else { bytes.push(0xda); view.setUint16(0, s.length); pushView(2); }
+                for (const b of s) bytes.push(b);
+            } else if (Array.isArray(v)) {
+                if (v.length < 16) bytes.push(0x90 | v.length);
+                else { bytes.push(0xdc); view.setUint16(0, v.length); pushView(2); }
+                v.forEach(write);
+            } else if (typeof v === 'object') {
+                const keys = Object.keys(v).filter(k => v[k] !== undefined);
+                if (keys.length < 16) bytes.push(0x80 | keys.length);
+                else { bytes.push(0xde); view.setUint16(0, keys.length); pushView(2); }
+                keys.forEach(k => { write(k); write(v[k]); });
+            } else {
+                throw new Error(`MsgPack: unsupported type ${typeof v}`);
+            }
+        }
+
+        write(value);
+        return new Uint8Array(bytes);
+    }
+
+    function decode(buf) {
+        const view = new DataView(buf.buffer, buf.byteOffset, buf.byteLength);
+        let pos = 0;
+
+        function str(len) {
+            const s = textDecoder.decode(buf.subarray(pos, pos + len));
+            pos += len;
+            return s;
+        }
+        function arr(len) {
+            const out = [];
+            for (let i = 0; i < len; i++) out.push(read());
+            return out;
+        }
+        function map(len) {
+            const out = {};
+            for (let i = 0; i < len; i++) {
+                const k = read();
+                out[k] = read();
+            }
+            return out;
+        }
+        function u8() { return view.getUint8(pos++); }
+        function u16() { const v = view.getUint16(pos); pos += 2; return v; }
+        function u32() { const v = view.getUint32(pos); pos += 4; return v; }
+
+        function read() {
+            const t = u8();
+            if (t < 0x80) return t;
+            if (t >= 0xe0) return t - 0x100;
+            if ((t & 0xf0) === 0x80) return map(t & 0x0f);
+            if ((t & 0xf0) === 0x90) return arr(t & 0x0f);
+            if ((t & 0xe0) === 0xa0) return str(t & 0x1f);
+            let v;
+            switch (t) {
+                case 0xc0: return null;
+                case 0xc2: return false;
+                case 0xc3: return true;
+                case 0xc4: { const n = u8(); v = buf.slice(pos, pos + n); pos += n; return v; }
+                case 0xc5: { const n = u16(); v = buf.slice(pos, pos + n); pos += n; return v; }
+                case 0xca: v = view.getFloat32(pos); pos += 4; return v;
+                case 0xcb: v = view.getFloat64(pos); pos += 8; return v;
+                case 0xcc: return u8();
+                case 0xcd: return u16();
+                case 0xce: return u32();
+                case 0xcf: v = Number(view.getBigUint64(pos)); pos += 8; return v;
+                case 0xd0: v = view.getInt8(pos); pos += 1; return v;
+                case 0xd1: v = view.getInt16(pos); pos += 2; return v;
+                case 0xd2: v = view.getInt32(pos); pos += 4; return v;
+                case 0xd3: v = Number(view.getBigInt64(pos)); pos += 8; return v;
+                case 0xd9: return str(u8());
+                case 0xda: return str(u16());
+                case 0xdb: return str(u32());
+                case 0xdc: return arr(u16());
+                case 0xdd: return arr(u32());
+                case 0xde: return map(u16());
+                case 0xdf: return map(u32());
+                default: throw new Error(`MsgPack: unsupported type 0x${t.toString(16)}`);
+            }
+        }
+
+        return read();
+    }
+
+    return { encode, decode };
+})();
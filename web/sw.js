@@ -1,10 +1,11 @@
-const CACHE_NAME = 'epaper-station-v1';
+const CACHE_NAME = 'epaper-station-v2';
 const ASSETS = [
     './',
     './index.html',
     './style.css',
     './app.js',
     './translations.js',
+    './msgpack.js',
     './manifest.json',
     './icon-192.png',
     './icon-512.png'
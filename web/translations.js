@@ -32,6 +32,11 @@ const translations = {
         tempus_hint: "Global configuration for Calendar, Trash, and Birthdays.",
         api_url_label: "API URL",
         save_url_btn: "Save URL",
+        calendar_title: "Local Calendar",
+        calendar_hint: "Trash collections and birthdays computed on the device, without Tempus. One entry per line; leave empty to use the Tempus API.",
+        ics_url_label: "Calendar Feed (ICS URL)",
+        ics_url_hint: "Events of the next two weeks, refreshed hourly. Leave empty to disable the agenda.",
+        save_calendar_btn: "Save Calendar",
         select_sensor_title: "Select a Sensor to Configure",
         global_settings_title: "Global Settings",
         sensor_interval_label: "Sensor Refresh Interval (seconds)",
@@ -49,6 +54,14 @@ const translations = {
         json_path_hint: "Use dot notation for objects and [] for arrays",
         divisor_label: "Divisor",
         decimals_label: "Decimals",
+        sensor_refresh_label: "Refresh Interval (seconds)",
+        sensor_refresh_hint: "0 uses the global interval. Stable values are polled less often.",
+        deadband_label: "Deadband",
+        deadband_mode_label: "Deadband Mode",
+        deadband_abs: "Absolute",
+        deadband_rel: "Relative (%)",
+        on_change_label: "Refresh only if the displayed value changes",
+        sparkline_label: "Show recent history as a sparkline",
         save_sensor_btn: "Save Settings",
         clear_sensor_btn: "Clear Slot",
         global_sensor_settings_title: "Global Sensor Settings",
@@ -56,6 +69,10 @@ const translations = {
         system_config_title: "System Configuration",
         ble_timeout_label: "BLE Timeout (minutes)",
         ble_timeout_hint: "Time before Bluetooth turns off automatically. Set to 0 to disable.",
+        net_tolerance_label: "Network Burst Tolerance (seconds)",
+        net_tolerance_hint: "How early or late a fetch may run to share a WiFi burst with others. WiFi is off between bursts. Set to 0 to keep WiFi always on.",
+        location_label: "Location (latitude, longitude)",
+        location_hint: "Sunrise, sunset and seasons are computed on the device from this location. Leave both at 0 to use the Tempus API instead.",
         save_sys_config_btn: "Save System Config",
         interface_settings_title: "Interface Settings",
         language_label: "Language",
@@ -110,6 +127,11 @@ const translations = {
         tempus_hint: "Configuration globale pour Calendrier, Poubelles et Anniversaires.",
         api_url_label: "URL de l'API",
         save_url_btn: "Enregistrer URL",
+        calendar_title: "Calendrier local",
+        calendar_hint: "Collectes des poubelles et anniversaires calculés sur l'appareil, sans Tempus. Une entrée par ligne ; laisser vide pour utiliser l'API Tempus.",
+        ics_url_label: "Flux de calendrier (URL ICS)",
+        ics_url_hint: "Événements des deux prochaines semaines, actualisés toutes les heures. Laisser vide pour désactiver l'agenda.",
+        save_calendar_btn: "Enregistrer Calendrier",
         select_sensor_title: "Sélectionnez un capteur à configurer",
         global_settings_title: "Paramètres Globaux",
         sensor_interval_label: "Intervalle de rafraîchissement (secondes)",
@@ -127,11 +149,23 @@ const translations = {
         json_path_hint: "Utilisez la notation par points pour les objets et [] pour les tableaux",
         divisor_label: "Diviseur",
         decimals_label: "Décimales",
+        sensor_refresh_label: "Intervalle de rafraîchissement (secondes)",
+        sensor_refresh_hint: "0 utilise l'intervalle global. Les valeurs stables sont interrogées moins souvent.",
+        deadband_label: "Zone morte",
+        deadband_mode_label: "Mode de zone morte",
+        deadband_abs: "Absolue",
+        deadband_rel: "Relative (%)",
+        on_change_label: "Rafraîchir uniquement si la valeur affichée change",
+        sparkline_label: "Afficher l'historique récent en sparkline",
         save_sensor_btn: "Enregistrer Paramètres",
         clear_sensor_btn: "Effacer Slot",
         system_config_title: "Configuration Système",
         ble_timeout_label: "Délai BLE (minutes)",
         ble_timeout_hint: "Temps avant coupure automatique du Bluetooth. Mettre 0 pour désactiver.",
+        net_tolerance_label: "Tolérance des rafales réseau (secondes)",
+        net_tolerance_hint: "Avance ou retard permis pour qu'une requête partage une rafale WiFi avec les autres. Le WiFi est coupé entre les rafales. Mettre 0 pour garder le WiFi toujours actif.",
+        location_label: "Position (latitude, longitude)",
+        location_hint: "Lever, coucher du soleil et saisons sont calculés sur l'appareil à partir de cette position. Laisser les deux à 0 pour utiliser l'API Tempus.",
         save_sys_config_btn: "Enregistrer Config Système",
         interface_settings_title: "Paramètres d'Interface",
         language_label: "Langue",